@@ -19,7 +19,7 @@ AxisControlWidget::~AxisControlWidget()
 }
 
 int AxisControlWidget::getAxisNumber() const { return currentAxisNumber_; }
-QString AxisControlWidget::getSelectedMotorName() const { return ui->motorComboBox->currentText(); }
+QString AxisControlWidget::getSelectedMotorName() const { return catalog_ ? catalog_->at(motorIndex_).name : QString(); }
 double AxisControlWidget::getInputValue() const { return ui->valueLineEdit->text().toDouble(); }
 int AxisControlWidget::getSelectedSpeed() const { return ui->speedComboBox->currentText().toInt(); }
 bool AxisControlWidget::isAbsoluteMode() const { return ui->absoluteRadioButton->isChecked(); }
@@ -30,23 +30,27 @@ void AxisControlWidget::setAxisNumber(int axisNumber)
     ui->container->setTitle(QString("Axis %1").arg(axisNumber));
 }
 
-void AxisControlWidget::populateMotorDropdown(const QMap<QString, StageMotorInfo> &motors)
+void AxisControlWidget::populateMotorDropdown(std::shared_ptr<const MotorCatalog> catalog)
 {
-    motorDefinitions_ = motors;
-    ui->motorComboBox->addItems(motors.keys());
-    if(motorDefinitions_.contains("Default")){
-        updateUiForMotor(motorDefinitions_["Default"]);
+    catalog_ = std::move(catalog);
+    for (int i = 0; i < catalog_->size(); ++i) {
+        ui->motorComboBox->addItem(catalog_->at(i).name);
     }
+    ui->motorComboBox->setCurrentIndex(MotorCatalog::kDefaultIndex);
+    updateUiForMotor(catalog_->at(MotorCatalog::kDefaultIndex));
 }
 
-void AxisControlWidget::setPosition(double physical_position)
+void AxisControlWidget::setPosition(qint64 positionNano)
 {
-    ui->currentPositionLabel->setText(QString::number(physical_position, 'f', displayPrecision_));
+    ui->currentPositionLabel->setText(MotorCatalog::formatNano(positionNano, displayPrecision_));
 }
 
 void AxisControlWidget::applyPreset(const AxisPreset &preset)
 {
-    ui->motorComboBox->setCurrentText(preset.motorName);
+    const int motorIndex = catalog_ ? catalog_->indexOf(preset.motorName) : -1;
+    if (motorIndex >= 0) {
+        ui->motorComboBox->setCurrentIndex(motorIndex);
+    }
     if(preset.isAbsolute) {
         ui->absoluteRadioButton->setChecked(true);
     } else {
@@ -54,11 +58,6 @@ void AxisControlWidget::applyPreset(const AxisPreset &preset)
     }
     ui->valueLineEdit->setText(QString::number(preset.value));
     ui->speedComboBox->setCurrentText(QString::number(preset.speed));
-
-    // Manually trigger UI update for the new motor
-    if (motorDefinitions_.contains(preset.motorName)) {
-        updateUiForMotor(motorDefinitions_[preset.motorName]);
-    }
 }
 
 void AxisControlWidget::updateUiForMotor(const StageMotorInfo &motor)
@@ -78,10 +77,9 @@ void AxisControlWidget::on_importButton_clicked() { emit importRequested(current
 
 void AxisControlWidget::on_motorComboBox_currentIndexChanged(int index)
 {
-    QString motorName = ui->motorComboBox->itemText(index);
-    if (motorDefinitions_.contains(motorName)) {
-        updateUiForMotor(motorDefinitions_[motorName]);
-        emit motorSelectionChanged(currentAxisNumber_, motorName);
-    }
+    if (!catalog_ || index < 0 || index >= catalog_->size()) return;
+    motorIndex_ = index;
+    updateUiForMotor(catalog_->at(index));
+    emit motorSelectionChanged(currentAxisNumber_, index);
 }
 
@@ -2,8 +2,8 @@
 #define AXISCONTROLWIDGET_H
 
 #include <QWidget>
-#include <QMap>
-#include "StageMotorInfo.h"
+#include <memory>
+#include "MotorCatalog.h"
 #include "PresetManager.h"
 
 namespace Ui {
@@ -21,21 +21,22 @@ public:
     // Getters
     int getAxisNumber() const;
     QString getSelectedMotorName() const;
+    int getSelectedMotorIndex() const { return motorIndex_; }
     double getInputValue() const;
     int getSelectedSpeed() const;
     bool isAbsoluteMode() const;
 
     // UI Update & Setup
     void setAxisNumber(int axisNumber);
-    void populateMotorDropdown(const QMap<QString, StageMotorInfo>& motors);
-    void setPosition(double physical_position);
+    void populateMotorDropdown(std::shared_ptr<const MotorCatalog> catalog);
+    void setPosition(qint64 positionNano);
     void applyPreset(const AxisPreset& preset);
 
 signals:
     void moveRequested(int axis, bool is_ccw);
     void originRequested(int axis);
     void removalRequested(int axis);
-    void motorSelectionChanged(int axis, const QString& motorName);
+    void motorSelectionChanged(int axis, int motorIndex);
     void importRequested(int axis);
 
 private slots:
@@ -52,8 +53,9 @@ private:
     Ui::AxisControlWidget *ui;
     int currentAxisNumber_ = 0;
     int displayPrecision_ = 4;
-    // 위젯이 모터 정보를 직접 소유하도록 변경
-    QMap<QString, StageMotorInfo> motorDefinitions_;
+    // 콤보박스 항목 순서 = 카탈로그 인덱스
+    std::shared_ptr<const MotorCatalog> catalog_;
+    int motorIndex_ = MotorCatalog::kDefaultIndex;
 };
 
 #endif // AXISCONTROLWIDGET_H
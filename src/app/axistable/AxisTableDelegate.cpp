@@ -0,0 +1,122 @@
+#include "AxisTableDelegate.h"
+#include "AxisTableModel.h"
+#include <QApplication>
+#include <QComboBox>
+#include <QDoubleValidator>
+#include <QLineEdit>
+#include <QMouseEvent>
+#include <QPainter>
+
+namespace {
+constexpr int kMargin = 2;
+
+bool isActionColumn(int column)
+{
+    return column >= AxisTableModel::CcwColumn && column <= AxisTableModel::RemoveColumn;
+}
+}
+
+AxisTableDelegate::AxisTableDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+void AxisTableDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    if (!isActionColumn(index.column())) {
+        QStyledItemDelegate::paint(painter, option, index);
+        return;
+    }
+
+    QStyle* style = option.widget ? option.widget->style() : QApplication::style();
+    QStyleOptionButton button;
+    button.state = QStyle::State_Enabled;
+    button.rect = option.rect.adjusted(kMargin, kMargin, -kMargin, -kMargin);
+    button.text = index.data().toString();
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
+}
+
+QWidget *AxisTableDelegate::createEditor(QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const auto* model = qobject_cast<const AxisTableModel*>(index.model());
+    if (!model) return QStyledItemDelegate::createEditor(parent, option, index);
+
+    // A pick ends the edit right away, like the combo boxes of AxisControlWidget
+    auto* self = const_cast<AxisTableDelegate*>(this);
+    auto commitOnPick = [self](QComboBox* combo) {
+        connect(combo, &QComboBox::activated, self, [self, combo]() {
+            emit self->commitData(combo);
+            emit self->closeEditor(combo);
+        });
+        return combo;
+    };
+
+    switch (index.column()) {
+    case AxisTableModel::MotorColumn: {
+        auto* combo = new QComboBox(parent);
+        for (int i = 0; i < model->catalog().size(); ++i) {
+            combo->addItem(model->catalog().at(i).name);
+        }
+        return commitOnPick(combo);
+    }
+    case AxisTableModel::ModeColumn: {
+        auto* combo = new QComboBox(parent);
+        combo->addItems({"Abs", "Rel"});
+        return commitOnPick(combo);
+    }
+    case AxisTableModel::SpeedColumn: {
+        auto* combo = new QComboBox(parent);
+        for (int i = 0; i <= AxisTableModel::kMaxSpeed; ++i) {
+            combo->addItem(QString::number(i));
+        }
+        return commitOnPick(combo);
+    }
+    case AxisTableModel::ValueColumn: {
+        auto* edit = new QLineEdit(parent);
+        edit->setValidator(new QDoubleValidator(edit));
+        edit->setAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        return edit;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+void AxisTableDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const
+{
+    const QVariant value = index.data(Qt::EditRole);
+    if (auto* combo = qobject_cast<QComboBox*>(editor)) {
+        // Mode is stored as "absolute", listed Abs first
+        combo->setCurrentIndex(index.column() == AxisTableModel::ModeColumn ? (value.toBool() ? 0 : 1) : value.toInt());
+    } else if (auto* edit = qobject_cast<QLineEdit*>(editor)) {
+        edit->setText(QString::number(value.toDouble()));
+        edit->selectAll();
+    }
+}
+
+void AxisTableDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const
+{
+    if (auto* combo = qobject_cast<QComboBox*>(editor)) {
+        const QVariant value = index.column() == AxisTableModel::ModeColumn ? QVariant(combo->currentIndex() == 0)
+                                                                            : QVariant(combo->currentIndex());
+        model->setData(index, value, Qt::EditRole);
+    } else if (auto* edit = qobject_cast<QLineEdit*>(editor)) {
+        model->setData(index, edit->text().toDouble(), Qt::EditRole);
+    }
+}
+
+bool AxisTableDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                                    const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease && isActionColumn(index.column())
+        && option.rect.contains(static_cast<QMouseEvent*>(event)->position().toPoint())) {
+        const int axis = index.siblingAtColumn(AxisTableModel::AxisColumn).data().toInt();
+        switch (index.column()) {
+        case AxisTableModel::CcwColumn: emit moveRequested(axis, true); break;
+        case AxisTableModel::CwColumn: emit moveRequested(axis, false); break;
+        case AxisTableModel::OriginColumn: emit originRequested(axis); break;
+        case AxisTableModel::ImportColumn: emit importRequested(axis); break;
+        case AxisTableModel::RemoveColumn: emit removalRequested(axis); break;
+        default: break;
+        }
+        return true;
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
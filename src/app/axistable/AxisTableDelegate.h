@@ -0,0 +1,34 @@
+#ifndef AXISTABLEDELEGATE_H
+#define AXISTABLEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Editors and buttons for AxisTableModel.
+//
+// Combo boxes and line edits exist only while a cell is being edited; the
+// action columns are painted as buttons and clicks on them are reported with
+// the same signals AxisControlWidget emits.
+class AxisTableDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit AxisTableDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    void setEditorData(QWidget* editor, const QModelIndex& index) const override;
+    void setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const override;
+
+signals:
+    void moveRequested(int axis, bool is_ccw);
+    void originRequested(int axis);
+    void removalRequested(int axis);
+    void importRequested(int axis);
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                     const QModelIndex& index) override;
+};
+
+#endif // AXISTABLEDELEGATE_H
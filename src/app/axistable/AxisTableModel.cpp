@@ -0,0 +1,261 @@
+#include "AxisTableModel.h"
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+AxisTableModel::AxisTableModel(std::shared_ptr<const MotorCatalog> catalog, QObject *parent)
+    : QAbstractTableModel(parent), catalog_(std::move(catalog))
+{
+    rowOfAxis_.fill(-1);
+    dirty_.fill(false);
+
+    // Publish at most once per display frame
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen ? screen->refreshRate() : 60.0;
+    publishTimer_ = new QTimer(this);
+    publishTimer_->setSingleShot(true);
+    publishTimer_->setInterval(qMax(1, int(std::lround(1000.0 / qMax(1.0, refreshRate)))));
+    connect(publishTimer_, &QTimer::timeout, this, &AxisTableModel::publishDirty);
+}
+
+int AxisTableModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows_.size();
+}
+
+int AxisTableModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant AxisTableModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows_.size()) {
+        return {};
+    }
+    const Row& row = rows_[index.row()];
+    const StageMotorInfo& motor = catalog_->at(row.motorIndex);
+
+    if (role == Qt::TextAlignmentRole) {
+        if (index.column() == PositionColumn || index.column() == ValueColumn) {
+            return QVariant(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        return QVariant(Qt::AlignCenter);
+    }
+    if (role == Qt::EditRole) {
+        switch (index.column()) {
+        case MotorColumn: return row.motorIndex;
+        case ModeColumn: return row.absolute;
+        case ValueColumn: return row.value;
+        case SpeedColumn: return row.speed;
+        default: return {};
+        }
+    }
+    if (role != Qt::DisplayRole) {
+        return {};
+    }
+
+    switch (index.column()) {
+    case AxisColumn: return row.axisNo;
+    case MotorColumn: return motor.name;
+    case PositionColumn:
+        if (!row.hasPosition) return QString("-");
+        return QString("%1 %2").arg(MotorCatalog::formatNano(row.positionNano, motor.display_precision),
+                                    motor.unit_symbol);
+    case ModeColumn: return row.absolute ? QString("Abs") : QString("Rel");
+    case ValueColumn: return QString("%1 %2").arg(row.value).arg(motor.unit_symbol);
+    case SpeedColumn: return row.speed;
+    case CcwColumn: return QString("CCW");
+    case CwColumn: return QString("CW");
+    case OriginColumn: return QString("Origin");
+    case ImportColumn: return QString("Import");
+    case RemoveColumn: return QString("Remove");
+    default: return {};
+    }
+}
+
+bool AxisTableModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= rows_.size() || role != Qt::EditRole) {
+        return false;
+    }
+    Row& row = rows_[index.row()];
+
+    switch (index.column()) {
+    case MotorColumn: {
+        const int motorIndex = value.toInt();
+        if (motorIndex < 0 || motorIndex >= catalog_->size()) return false;
+        if (motorIndex == row.motorIndex) return true;
+        row.motorIndex = motorIndex;
+        // The unit shows up in the value and position cells as well
+        emit dataChanged(index, index.siblingAtColumn(ValueColumn), {Qt::DisplayRole});
+        emit motorSelectionChanged(row.axisNo, motorIndex);
+        return true;
+    }
+    case ModeColumn:
+        row.absolute = value.toBool();
+        break;
+    case ValueColumn: {
+        bool ok = false;
+        const double number = value.toDouble(&ok);
+        if (!ok) return false;
+        row.value = number;
+        break;
+    }
+    case SpeedColumn:
+        row.speed = qBound(0, value.toInt(), kMaxSpeed);
+        break;
+    default:
+        return false;
+    }
+    emit dataChanged(index, index, {Qt::DisplayRole, Qt::EditRole});
+    return true;
+}
+
+QVariant AxisTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return {};
+    }
+    switch (section) {
+    case AxisColumn: return QString("Axis");
+    case MotorColumn: return QString("Motor");
+    case PositionColumn: return QString("Position");
+    case ModeColumn: return QString("Mode");
+    case ValueColumn: return QString("Value");
+    case SpeedColumn: return QString("Speed");
+    default: return QString();
+    }
+}
+
+Qt::ItemFlags AxisTableModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    switch (index.column()) {
+    case MotorColumn:
+    case ModeColumn:
+    case ValueColumn:
+    case SpeedColumn:
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+    default:
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    }
+}
+
+void AxisTableModel::addAxis(int axisNo)
+{
+    if (axisNo < 1 || axisNo > AxisStateSnapshot::kMaxAxes || contains(axisNo)) return;
+
+    const auto position = std::lower_bound(rows_.begin(), rows_.end(), axisNo,
+                                           [](const Row& row, int axis) { return row.axisNo < axis; });
+    const int insertAt = int(position - rows_.begin());
+    beginInsertRows(QModelIndex(), insertAt, insertAt);
+    Row row;
+    row.axisNo = axisNo;
+    rows_.insert(insertAt, row);
+    reindex(insertAt);
+    endInsertRows();
+}
+
+void AxisTableModel::removeAxis(int axisNo)
+{
+    const int row = rowOf(axisNo);
+    if (row < 0) return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    rows_.remove(row);
+    rowOfAxis_[axisNo] = -1;
+    dirty_[axisNo] = false;
+    reindex(row);
+    endRemoveRows();
+}
+
+bool AxisTableModel::contains(int axisNo) const
+{
+    return rowOf(axisNo) >= 0;
+}
+
+int AxisTableModel::rowOf(int axisNo) const
+{
+    if (axisNo < 1 || axisNo > AxisStateSnapshot::kMaxAxes) return -1;
+    return rowOfAxis_[axisNo];
+}
+
+void AxisTableModel::reindex(int fromRow)
+{
+    for (int i = fromRow; i < rows_.size(); ++i) {
+        rowOfAxis_[rows_[i].axisNo] = i;
+    }
+}
+
+AxisPreset AxisTableModel::input(int axisNo) const
+{
+    AxisPreset preset = {};
+    const int row = rowOf(axisNo);
+    if (row < 0) return preset;
+    preset.motorName = catalog_->at(rows_[row].motorIndex).name;
+    preset.isAbsolute = rows_[row].absolute;
+    preset.value = rows_[row].value;
+    preset.speed = rows_[row].speed;
+    return preset;
+}
+
+int AxisTableModel::motorIndex(int axisNo) const
+{
+    const int row = rowOf(axisNo);
+    return row < 0 ? -1 : rows_[row].motorIndex;
+}
+
+void AxisTableModel::applyPreset(int axisNo, const AxisPreset &preset)
+{
+    const int row = rowOf(axisNo);
+    if (row < 0) return;
+
+    const int motorIndex = catalog_->indexOf(preset.motorName);
+    if (motorIndex >= 0) {
+        setData(index(row, MotorColumn), motorIndex);
+    }
+    rows_[row].absolute = preset.isAbsolute;
+    rows_[row].value = preset.value;
+    rows_[row].speed = qBound(0, preset.speed, kMaxSpeed);
+    emit dataChanged(index(row, ModeColumn), index(row, SpeedColumn), {Qt::DisplayRole, Qt::EditRole});
+}
+
+void AxisTableModel::setPosition(int axisNo, qint64 positionNano)
+{
+    const int row = rowOf(axisNo);
+    if (row < 0) return;
+
+    Row& entry = rows_[row];
+    if (entry.hasPosition && entry.positionNano == positionNano) return;
+    entry.hasPosition = true;
+    entry.positionNano = positionNano;
+    dirty_[axisNo] = true;
+    anyDirty_ = true;
+    if (!publishTimer_->isActive()) {
+        publishTimer_->start();
+    }
+}
+
+void AxisTableModel::publishDirty()
+{
+    if (!anyDirty_) return;
+    anyDirty_ = false;
+
+    // One dataChanged per contiguous run of changed rows
+    int runStart = -1;
+    for (int row = 0; row <= rows_.size(); ++row) {
+        const bool isDirty = row < rows_.size() && dirty_[rows_[row].axisNo];
+        if (isDirty) {
+            dirty_[rows_[row].axisNo] = false;
+            if (runStart < 0) runStart = row;
+        } else if (runStart >= 0) {
+            emit dataChanged(index(runStart, PositionColumn), index(row - 1, PositionColumn), {Qt::DisplayRole});
+            runStart = -1;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef AXISTABLEMODEL_H
+#define AXISTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <array>
+#include <memory>
+#include "AxisSnapshot.h"
+#include "MotorCatalog.h"
+#include "PresetManager.h"
+
+class QTimer;
+
+// One row per axis: the compact alternative to a stack of AxisControlWidgets.
+//
+// setPosition() only stores the value and marks the row dirty; the dirty
+// rows are published as dataChanged() over contiguous runs of the Position
+// column once per display frame, so a burst of samples for 32 axes costs one
+// repaint of the changed cells. Motor, mode, value and speed are edited in
+// place; AxisTableDelegate creates an editor only while a cell is edited and
+// paints the action columns as buttons.
+class AxisTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column { AxisColumn, MotorColumn, PositionColumn, ModeColumn, ValueColumn, SpeedColumn,
+                  CcwColumn, CwColumn, OriginColumn, ImportColumn, RemoveColumn, ColumnCount };
+    static constexpr int kMaxSpeed = 9;
+
+    explicit AxisTableModel(std::shared_ptr<const MotorCatalog> catalog, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    const MotorCatalog& catalog() const { return *catalog_; }
+
+    // Rows stay sorted by axis number
+    void addAxis(int axisNo);
+    void removeAxis(int axisNo);
+    bool contains(int axisNo) const;
+    int axisAt(int row) const { return rows_[row].axisNo; }
+
+    // Same fields as AxisControlWidget; the preset's id is left empty
+    AxisPreset input(int axisNo) const;
+    int motorIndex(int axisNo) const;
+    void applyPreset(int axisNo, const AxisPreset& preset);
+    void setPosition(int axisNo, qint64 positionNano);
+
+signals:
+    void motorSelectionChanged(int axis, int motorIndex);
+
+private:
+    struct Row {
+        int axisNo = 0;
+        int motorIndex = MotorCatalog::kDefaultIndex;
+        bool absolute = true;
+        double value = 0.0;
+        int speed = 0;
+        bool hasPosition = false;
+        qint64 positionNano = 0;
+    };
+
+    int rowOf(int axisNo) const;
+    void reindex(int fromRow);
+    void publishDirty();
+
+    std::shared_ptr<const MotorCatalog> catalog_;
+    QVector<Row> rows_;
+    // Indexed by axis number: row (-1 = none) and pending position update
+    std::array<int, AxisStateSnapshot::kMaxAxes + 1> rowOfAxis_;
+    std::array<bool, AxisStateSnapshot::kMaxAxes + 1> dirty_;
+    bool anyDirty_ = false;
+    QTimer* publishTimer_;
+};
+
+#endif // AXISTABLEMODEL_H
@@ -0,0 +1,76 @@
+#include "LogBuffer.h"
+#include <QDir>
+#include <QFileInfo>
+#include "spdlog/spdlog.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/rotating_file_sink.h"
+
+namespace {
+
+spdlog::level::level_enum toSpdlogLevel(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return spdlog::level::debug;
+    case LogLevel::Info: return spdlog::level::info;
+    case LogLevel::Warning: return spdlog::level::warn;
+    case LogLevel::Error: return spdlog::level::err;
+    }
+    return spdlog::level::info;
+}
+
+} // namespace
+
+LogBuffer::LogBuffer(int capacity)
+    : entries_(qMax(1, capacity))
+{
+}
+
+LogBuffer::~LogBuffer()
+{
+    if (spill_) {
+        spill_->flush();
+        spdlog::drop(spill_->name());
+    }
+}
+
+void LogBuffer::append(LogEntry entry)
+{
+    if (spill_) {
+        // The message is formatted here; only the pattern and file I/O run on the spdlog worker
+        const QByteArray text = entry.text.toUtf8();
+        const spdlog::string_view_t view(text.constData(), static_cast<std::size_t>(text.size()));
+        if (entry.axisNo > 0) {
+            spill_->log(toSpdlogLevel(entry.level), "[Axis {}] {}", entry.axisNo, view);
+        } else {
+            spill_->log(toSpdlogLevel(entry.level), view);
+        }
+    }
+
+    entries_[int(nextSequence_ % quint64(entries_.size()))] = std::move(entry);
+    ++nextSequence_;
+    if (size_ < entries_.size()) {
+        ++size_;
+    }
+}
+
+bool LogBuffer::enableFileSpill(const QString &filePath, std::size_t maxBytes, std::size_t maxFiles)
+{
+    if (spill_) return true;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    try {
+        if (!spdlog::thread_pool()) {
+            spdlog::init_thread_pool(8192, 1);
+        }
+        // Overrun the oldest queued line rather than block the GUI thread when the disk stalls
+        spill_ = spdlog::create_async_nb<spdlog::sinks::rotating_file_sink_mt>(
+            "qtkohzu-log", filePath.toStdString(), maxBytes, maxFiles);
+        spill_->set_level(spdlog::level::debug);
+        spill_->flush_on(spdlog::level::warn);
+    } catch (const spdlog::spdlog_ex& e) {
+        spdlog::error("Log file spill disabled: {}", e.what());
+        spill_.reset();
+        return false;
+    }
+    return true;
+}
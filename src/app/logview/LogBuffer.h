@@ -0,0 +1,44 @@
+#ifndef LOGBUFFER_H
+#define LOGBUFFER_H
+
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "LogEntry.h"
+
+namespace spdlog { class logger; }
+
+// Fixed-capacity ring of log entries. Every entry gets a sequence number;
+// once the ring is full the oldest entry is overwritten, so memory stays
+// bounded no matter how long the application runs. Entries can also be
+// spilled to rotating files through an asynchronous spdlog logger: the line
+// is converted and formatted on the appending thread, only the pattern and
+// the file I/O run on spdlog's worker thread.
+//
+// GUI thread only.
+class LogBuffer
+{
+public:
+    explicit LogBuffer(int capacity = 10000);
+    ~LogBuffer();
+
+    void append(LogEntry entry);
+
+    // Sequence numbers of the retained entries are [firstSequence, nextSequence)
+    quint64 firstSequence() const { return nextSequence_ - quint64(size_); }
+    quint64 nextSequence() const { return nextSequence_; }
+    bool contains(quint64 sequence) const { return sequence >= firstSequence() && sequence < nextSequence_; }
+    const LogEntry& at(quint64 sequence) const { return entries_[int(sequence % quint64(entries_.size()))]; }
+    int capacity() const { return entries_.size(); }
+
+    // Rotating files of maxBytes each, keeping maxFiles old ones; false if the file cannot be opened
+    bool enableFileSpill(const QString& filePath, std::size_t maxBytes = 5 * 1024 * 1024, std::size_t maxFiles = 3);
+
+private:
+    QVector<LogEntry> entries_;
+    int size_ = 0;
+    quint64 nextSequence_ = 0;
+    std::shared_ptr<spdlog::logger> spill_;
+};
+
+#endif // LOGBUFFER_H
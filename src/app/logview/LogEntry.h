@@ -0,0 +1,23 @@
+#ifndef LOGENTRY_H
+#define LOGENTRY_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 로그 레벨 (필터 기준: 선택한 레벨 이상만 표시)
+enum class LogLevel {
+    Debug = 0,
+    Info,
+    Warning,
+    Error
+};
+
+// 로그 한 줄 (표시 문자열은 보이는 행에 대해서만 만들어짐)
+struct LogEntry {
+    qint64 timestampMs = 0;   // ms since epoch
+    int axisNo = 0;           // 0 = not tied to an axis
+    LogLevel level = LogLevel::Info;
+    QString text;
+};
+
+#endif // LOGENTRY_H
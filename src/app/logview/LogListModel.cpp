@@ -0,0 +1,137 @@
+#include "LogListModel.h"
+#include <QBrush>
+#include <QDateTime>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QTimer>
+#include <cmath>
+
+namespace {
+
+QString levelName(LogLevel level)
+{
+    switch (level) {
+    case LogLevel::Debug: return "DEBUG";
+    case LogLevel::Info: return "INFO";
+    case LogLevel::Warning: return "WARN";
+    case LogLevel::Error: return "ERROR";
+    }
+    return {};
+}
+
+} // namespace
+
+LogListModel::LogListModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent), buffer_(capacity)
+{
+    publishedUntil_ = buffer_.nextSequence();
+
+    // Publish at most once per display frame
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen ? screen->refreshRate() : 60.0;
+    publishTimer_ = new QTimer(this);
+    publishTimer_->setSingleShot(true);
+    publishTimer_->setInterval(qMax(1, int(std::lround(1000.0 / qMax(1.0, refreshRate)))));
+    connect(publishTimer_, &QTimer::timeout, this, &LogListModel::publishPending);
+
+    rebuildRows();
+}
+
+int LogListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows_.size();
+}
+
+QVariant LogListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows_.size()) {
+        return {};
+    }
+    const quint64 sequence = rows_[index.row()];
+    if (!buffer_.contains(sequence)) {
+        // Evicted since the last publish; the row goes away on the next frame
+        return {};
+    }
+
+    const LogEntry& entry = buffer_.at(sequence);
+    switch (role) {
+    case Qt::DisplayRole: {
+        QString line = QDateTime::fromMSecsSinceEpoch(entry.timestampMs).toString("hh:mm:ss.zzz");
+        line += QString(" [%1] ").arg(levelName(entry.level), -5);
+        line += entry.text;
+        return line;
+    }
+    case Qt::ForegroundRole:
+        if (entry.level == LogLevel::Error) return QBrush(Qt::red);
+        if (entry.level == LogLevel::Warning) return QBrush(QColor(0xC0, 0x80, 0x00));
+        if (entry.level == LogLevel::Debug) return QBrush(Qt::gray);
+        return {};
+    default:
+        return {};
+    }
+}
+
+void LogListModel::append(LogEntry entry)
+{
+    buffer_.append(std::move(entry));
+    if (!publishTimer_->isActive()) {
+        publishTimer_->start();
+    }
+}
+
+bool LogListModel::accepts(const LogEntry &entry) const
+{
+    return entry.level >= minLevel_ && (axisFilter_ == 0 || entry.axisNo == axisFilter_);
+}
+
+void LogListModel::publishPending()
+{
+    // Drop rows whose entries were overwritten in the ring (always at the front)
+    const quint64 first = buffer_.firstSequence();
+    int evicted = 0;
+    while (evicted < rows_.size() && rows_[evicted] < first) {
+        ++evicted;
+    }
+    if (evicted > 0) {
+        beginRemoveRows(QModelIndex(), 0, evicted - 1);
+        rows_.remove(0, evicted);
+        endRemoveRows();
+    }
+
+    // Entries that arrived and were already overwritten before this frame are skipped
+    QVector<quint64> added;
+    for (quint64 sequence = qMax(publishedUntil_, first); sequence < buffer_.nextSequence(); ++sequence) {
+        if (accepts(buffer_.at(sequence))) {
+            added.append(sequence);
+        }
+    }
+    publishedUntil_ = buffer_.nextSequence();
+
+    if (!added.isEmpty()) {
+        beginInsertRows(QModelIndex(), rows_.size(), rows_.size() + added.size() - 1);
+        rows_ += added;
+        endInsertRows();
+    }
+}
+
+void LogListModel::setFilter(LogLevel minLevel, int axisNo)
+{
+    if (minLevel == minLevel_ && axisNo == axisFilter_) return;
+    minLevel_ = minLevel;
+    axisFilter_ = axisNo;
+
+    beginResetModel();
+    rebuildRows();
+    endResetModel();
+}
+
+void LogListModel::rebuildRows()
+{
+    rows_.clear();
+    for (quint64 sequence = buffer_.firstSequence(); sequence < buffer_.nextSequence(); ++sequence) {
+        if (accepts(buffer_.at(sequence))) {
+            rows_.append(sequence);
+        }
+    }
+    publishedUntil_ = buffer_.nextSequence();
+}
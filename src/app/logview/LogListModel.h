@@ -0,0 +1,47 @@
+#ifndef LOGLISTMODEL_H
+#define LOGLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "LogBuffer.h"
+
+class QTimer;
+
+// List model over the entries of its LogBuffer that pass the level/axis filter.
+//
+// Appends only land in the buffer; the rows they add (and the rows evicted
+// from the ring) are published to the view in one batch per display frame,
+// so a burst of thousands of lines costs one layout pass. Display strings are
+// built in data(), i.e. only for rows the view actually paints.
+class LogListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogListModel(int capacity = 10000, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void append(LogEntry entry);
+    LogBuffer& buffer() { return buffer_; }
+
+    // Entries below minLevel are hidden; axisNo 0 shows every axis
+    void setFilter(LogLevel minLevel, int axisNo);
+    LogLevel minimumLevel() const { return minLevel_; }
+    int axisFilter() const { return axisFilter_; }
+
+private:
+    bool accepts(const LogEntry& entry) const;
+    void publishPending();
+    void rebuildRows();
+
+    LogBuffer buffer_;
+    QVector<quint64> rows_;          // sequence numbers of the visible entries
+    quint64 publishedUntil_ = 0;     // entries below this were already considered
+    LogLevel minLevel_ = LogLevel::Debug;
+    int axisFilter_ = 0;
+    QTimer* publishTimer_;
+};
+
+#endif // LOGLISTMODEL_H
@@ -1,11 +1,36 @@
 #include "mainwindow.h"
+#include "MotorCatalog.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
 #include <QFile>
+#include <QStandardPaths>
+
+namespace {
+
+// Relative paths land in the per-user data directory, never next to the executable
+QString dataPath(const QString& path)
+{
+    if (QDir::isAbsolutePath(path)) return path;
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).filePath(path);
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    QCoreApplication::setApplicationName("qtkohzu");
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({"log-file", "Also write the log pane to this rotating file (relative to the app data directory).", "path"});
+    parser.addOption({"metrics-file", "Write Prometheus text-format metrics to this file (relative to the app data directory).", "path"});
+    parser.addOption({"metrics-interval-ms", "How often the metrics file is rewritten.", "ms", "5000"});
+    parser.addOption({"trajectory-file", "Keep the motion history of polled axes in this ring file (relative to the app data directory).", "path"});
+    parser.addOption({"trajectory-samples", "Samples kept per axis in the trajectory ring.", "n", "65536"});
+    parser.process(a);
 
     // Apply global stylesheet
     QFile styleFile(":/styles/stylesheet.qss");
@@ -16,7 +41,26 @@ int main(int argc, char *argv[])
         qDebug() << "Could not open resource file.";
     }
 
+    // A motors.json next to the executable replaces the bundled catalog
+    const QString localCatalog = QDir(QCoreApplication::applicationDirPath()).filePath("motors.json");
+    QString catalogError;
+    auto catalog = MotorCatalog::load(QFile::exists(localCatalog) ? localCatalog : ":/catalog/motors.json", catalogError);
+    if (catalog) {
+        MotorCatalog::install(catalog);
+    } else {
+        qWarning() << "Motor catalog not loaded:" << catalogError;
+    }
+
     MainWindow w;
+    if (parser.isSet("log-file")) {
+        w.startLogFile(dataPath(parser.value("log-file")));
+    }
+    if (parser.isSet("metrics-file")) {
+        w.startMetricsExport(dataPath(parser.value("metrics-file")), parser.value("metrics-interval-ms").toInt());
+    }
+    if (parser.isSet("trajectory-file")) {
+        w.startTrajectoryRecording(dataPath(parser.value("trajectory-file")), parser.value("trajectory-samples").toInt());
+    }
     w.show();
     return a.exec();
 }
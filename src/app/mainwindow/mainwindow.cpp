@@ -1,8 +1,29 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include "PresetDialog.h"
+#include "LogListModel.h"
+#include "MetricsExporter.h"
+#include "PositionPlotWidget.h"
+#include "AxisTableModel.h"
+#include "AxisTableDelegate.h"
+#include "TrajectoryRecorder.h"
+#include "LatencyHistogram.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
+#include <QGuiApplication>
+#include <QHeaderView>
+#include <QLabel>
 #include <QMessageBox>
+#include <QPointer>
+#include <QScreen>
+#include <QScrollBar>
+#include <QThreadPool>
+#include <QTimer>
 #include <cmath>
+#include <limits>
+#include <memory>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -11,11 +32,27 @@ MainWindow::MainWindow(QWidget *parent)
     ui->setupUi(this);
     manager_ = new QtKohzuManager(this);
     presetManager_ = new PresetManager(this);
-    motorDefinitions_ = getMotorDefinitions();
+    catalog_ = MotorCatalog::shared();
+    axisMotor_.fill(-1);
+    positionPulse_.fill(0);
+    commandedPulse_.fill(0);
+    hasCommandedPulse_.fill(false);
 
-    connect(manager_, &QtKohzuManager::logMessage, this, &MainWindow::logMessage);
+    setupLogView();
+    setupMetrics();
+    setupPlot();
+    setupAxisTable();
+    setupEstimator();
+
+    connect(manager_, &QtKohzuManager::logEvent, this, &MainWindow::logEvent);
     connect(manager_, &QtKohzuManager::connectionStatusChanged, this, &MainWindow::updateConnectionStatus);
-    connect(manager_, &QtKohzuManager::positionUpdated, this, &MainWindow::updatePosition);
+    connect(manager_, &QtKohzuManager::connectionStateChanged, this, &MainWindow::updateConnectionState);
+    connect(manager_, &QtKohzuManager::positionsUpdated, this, &MainWindow::updatePositions);
+    connect(manager_, &QtKohzuManager::positionsUpdated, ui->positionPlot, &PositionPlotWidget::appendSamples);
+    connect(manager_, &QtKohzuManager::sequenceProgress, this, &MainWindow::updateSequenceProgress);
+    connect(manager_, &QtKohzuManager::sequenceFinished, this, &MainWindow::handleSequenceFinished);
+    connect(manager_, &QtKohzuManager::homingAxisFinished, this, &MainWindow::handleHomingAxisFinished);
+    connect(manager_, &QtKohzuManager::homingFinished, this, &MainWindow::handleHomingFinished);
 
     updateConnectionStatus(false);
 }
@@ -46,101 +83,340 @@ void MainWindow::updateConnectionStatus(bool connected)
         ui->connectButton->setText("Disconnect");
     } else {
         ui->connectButton->setText("Connect");
+        ui->homeAllButton->setText("Home All");
         if(manager_) manager_->clearPollAxes();
     }
 }
 
+void MainWindow::updateConnectionState(QtKohzuManager::ConnectionState state)
+{
+    switch (state) {
+    case QtKohzuManager::ConnectionState::Connecting:
+    case QtKohzuManager::ConnectionState::Reconnecting:
+        // Axis widgets stay in place so they are re-subscribed once the link is back
+        ui->hostLineEdit->setEnabled(false);
+        ui->portLineEdit->setEnabled(false);
+        ui->controlGroup->setEnabled(false);
+        ui->connectButton->setText("Disconnect");
+        ui->statusbar->showMessage(state == QtKohzuManager::ConnectionState::Connecting ? "Connecting..." : "Reconnecting...");
+        break;
+    case QtKohzuManager::ConnectionState::Connected:
+        ui->statusbar->showMessage("Connected");
+        break;
+    case QtKohzuManager::ConnectionState::Disconnected:
+        ui->statusbar->showMessage("Disconnected");
+        break;
+    }
+}
+
 void MainWindow::on_addAxisButton_clicked()
 {
     int axisToAdd = ui->addAxisSpinBox->value();
-    if (axisWidgets_.contains(axisToAdd)) {
+    if (hasAxis(axisToAdd)) {
         QMessageBox::warning(this, "Duplicate Axis", QString("Axis %1 already exists.").arg(axisToAdd));
         return;
     }
 
-    AxisControlWidget *axisWidget = new AxisControlWidget(this);
-    axisWidget->setAxisNumber(axisToAdd);
-    axisWidgets_.insert(axisToAdd, axisWidget);
-    currentPositionsPulse_.insert(axisToAdd, 0);
-    setupAxisWidget(axisWidget);
-    ui->axisLayout->addWidget(axisWidget);
+    positionPulse_[axisToAdd] = 0;
+    addAxisView(axisToAdd);
+    ui->positionPlot->addAxis(axisToAdd);
 
     // Add axis to UI polling list only
     manager_->addAxisToPoll(axisToAdd);
     manager_->setSystem(axisToAdd, 2, 8);
 }
 
+void MainWindow::on_tableViewCheckBox_toggled(bool checked)
+{
+    if (checked == tableMode_) return;
+
+    // Carry every axis over with its inputs; polling is not touched
+    QMap<int, AxisPreset> inputs;
+    for (int axis = 1; axis <= AxisStateSnapshot::kMaxAxes; ++axis) {
+        AxisPreset input;
+        if (axisInput(axis, input)) inputs.insert(axis, input);
+    }
+    for (auto it = inputs.cbegin(); it != inputs.cend(); ++it) {
+        removeAxisView(it.key());
+    }
+    tableMode_ = checked;
+    ui->axisStack->setCurrentWidget(tableMode_ ? ui->tablePage : ui->widgetPage);
+    for (auto it = inputs.cbegin(); it != inputs.cend(); ++it) {
+        addAxisView(it.key());
+        applyAxisInput(it.key(), it.value());
+        refreshPosition(it.key());
+    }
+}
+
+void MainWindow::addAxisView(int axis)
+{
+    if (tableMode_) {
+        axisTableModel_->addAxis(axis);
+        axisMotor_[axis] = axisTableModel_->motorIndex(axis);
+        return;
+    }
+
+    AxisControlWidget *axisWidget = new AxisControlWidget(this);
+    axisWidget->setAxisNumber(axis);
+    axisWidgets_.insert(axis, axisWidget);
+    setupAxisWidget(axisWidget);
+    axisMotor_[axis] = axisWidget->getSelectedMotorIndex();
+    ui->axisLayout->addWidget(axisWidget);
+}
+
+void MainWindow::removeAxisView(int axis)
+{
+    if (AxisControlWidget* widget = axisWidgets_.take(axis)) {
+        widget->deleteLater();
+    }
+    axisTableModel_->removeAxis(axis);
+    axisMotor_[axis] = -1;
+}
+
+bool MainWindow::hasAxis(int axis) const
+{
+    return axisWidgets_.contains(axis) || axisTableModel_->contains(axis);
+}
+
+bool MainWindow::axisInput(int axis, AxisPreset &input) const
+{
+    if (AxisControlWidget* widget = axisWidgets_.value(axis, nullptr)) {
+        input.motorName = widget->getSelectedMotorName();
+        input.isAbsolute = widget->isAbsoluteMode();
+        input.value = widget->getInputValue();
+        input.speed = widget->getSelectedSpeed();
+        return true;
+    }
+    if (axisTableModel_->contains(axis)) {
+        input = axisTableModel_->input(axis);
+        return true;
+    }
+    return false;
+}
+
+void MainWindow::applyAxisInput(int axis, const AxisPreset &input)
+{
+    if (AxisControlWidget* widget = axisWidgets_.value(axis, nullptr)) {
+        widget->applyPreset(input);
+    } else {
+        axisTableModel_->applyPreset(axis, input);
+    }
+}
+
+void MainWindow::on_homeAllButton_clicked()
+{
+    if (manager_->isHoming()) {
+        manager_->abortHoming();
+        return;
+    }
+
+    // Optional ordering next to the executable, e.g. {"after": {"1": [3], "2": [3]}}
+    std::map<int, std::vector<int>> after;
+    const QString planPath = QDir(QCoreApplication::applicationDirPath()).filePath("homing.json");
+    QString error;
+    if (QFile::exists(planPath) && !HomingPlanner::loadDependencies(planPath, after, error)) {
+        QMessageBox::critical(this, "Invalid Homing Plan", error);
+        return;
+    }
+
+    HomingPlan plan;
+    QStringList axes, order;
+    for (int axis = 1; axis <= AxisStateSnapshot::kMaxAxes; ++axis) {
+        AxisPreset input;
+        if (!axisInput(axis, input)) continue;
+        savePreset(axis);
+        HomingAxis entry;
+        entry.axisNo = axis;
+        entry.speed = input.speed;
+        entry.after = after[axis];
+        plan.axes.push_back(entry);
+
+        axes << QString::number(axis);
+        QStringList before;
+        for (int beforeAxis : entry.after) before << QString::number(beforeAxis);
+        if (!before.isEmpty()) order << QString("Axis %1 after %2").arg(axis).arg(before.join(", "));
+    }
+    if (plan.axes.empty()) return;
+
+    std::string planError;
+    if (!HomingPlanner::validate(plan, planError)) {
+        QMessageBox::critical(this, "Invalid Homing Plan", QString::fromStdString(planError));
+        return;
+    }
+
+    // One confirmation for the whole stack; independent axes run at the same time
+    QString question = QString("Are you sure you want to perform an origin return for Axes %1?").arg(axes.join(", "));
+    if (!order.isEmpty()) question += "\n\n" + order.join("\n");
+    QMessageBox::StandardButton reply = QMessageBox::question(this, "Confirm Origin Return", question,
+                                                              QMessageBox::Yes|QMessageBox::No);
+    if (reply == QMessageBox::Yes && manager_->startHoming(plan)) {
+        ui->homeAllButton->setText("Abort Homing");
+    }
+}
+
+void MainWindow::on_runSequenceButton_clicked()
+{
+    const QString filePath = QFileDialog::getOpenFileName(this, "Run Motion Sequence", QString(),
+                                                          "Motion sequences (*.json);;All files (*)");
+    if (filePath.isEmpty()) return;
+
+    // Everything is checked before the first command; the run itself needs no GUI involvement
+    MotionSequence sequence;
+    QString error;
+    if (!MotionSequence::load(filePath, catalog_, sequence, error)) {
+        QMessageBox::critical(this, "Invalid Sequence", error);
+        return;
+    }
+    if (manager_->runSequence(sequence)) {
+        ui->runSequenceButton->setEnabled(false);
+        ui->abortSequenceButton->setEnabled(true);
+    }
+}
+
+void MainWindow::on_abortSequenceButton_clicked()
+{
+    manager_->abortSequence();
+}
+
+void MainWindow::on_exportTrajectoryButton_clicked()
+{
+    auto recorder = manager_->trajectoryRecorder();
+    if (!recorder) {
+        QMessageBox::information(this, "Export Trajectory", "Trajectory recording is not active.");
+        return;
+    }
+    const QString filePath = QFileDialog::getSaveFileName(this, "Export Trajectory", "trajectory.csv",
+                                                          "CSV (*.csv);;Binary (*.bin)");
+    if (filePath.isEmpty()) return;
+
+    // Recording goes on while the whole retained history is streamed out
+    const TrajectoryFormat format = filePath.endsWith(".csv", Qt::CaseInsensitive) ? TrajectoryFormat::Csv
+                                                                                    : TrajectoryFormat::Binary;
+    ui->exportTrajectoryButton->setEnabled(false);
+    // The window may be closed before the export finishes: the result is
+    // delivered through the application object and dropped if it is gone
+    QPointer<MainWindow> window(this);
+    QThreadPool::globalInstance()->start([window, recorder, filePath, format]() {
+        QString error;
+        const bool ok = recorder->exportWindow(filePath, format, std::numeric_limits<qint64>::min(),
+                                               std::numeric_limits<qint64>::max(), 0, error);
+        QMetaObject::invokeMethod(qApp, [window, ok, filePath, error]() {
+            if (!window) return;
+            window->ui->exportTrajectoryButton->setEnabled(true);
+            window->appendLog(ok ? LogLevel::Info : LogLevel::Error, 0,
+                              ok ? QString("Trajectory exported to %1").arg(filePath)
+                                 : QString("Trajectory export failed: %1").arg(error));
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::updateSequenceProgress(int stepIndex, const QString &description)
+{
+    Q_UNUSED(stepIndex);
+    ui->statusbar->showMessage(QString("Sequence: %1").arg(description));
+}
+
+void MainWindow::handleSequenceFinished(bool completed, const QString &message)
+{
+    ui->runSequenceButton->setEnabled(true);
+    ui->abortSequenceButton->setEnabled(false);
+    ui->statusbar->showMessage(QString("Sequence %1: %2").arg(completed ? "finished" : "stopped", message));
+}
+
+void MainWindow::handleHomingAxisFinished(int axis, bool success, double seconds)
+{
+    ui->statusbar->showMessage(QString("Homing: Axis %1 %2 (%3 s)")
+                                   .arg(axis).arg(success ? "home" : "failed").arg(seconds, 0, 'f', 1));
+}
+
+void MainWindow::handleHomingFinished(bool completed, const QString &message)
+{
+    ui->homeAllButton->setText("Home All");
+    ui->statusbar->showMessage(QString("Homing %1: %2").arg(completed ? "finished" : "stopped", message));
+}
+
 void MainWindow::handleRemovalRequest(int axis)
 {
-    if (axisWidgets_.contains(axis)) {
+    if (hasAxis(axis)) {
         // Remove from UI polling list only
         manager_->removeAxisToPoll(axis);
 
-        AxisControlWidget *widget = axisWidgets_.take(axis);
-        currentPositionsPulse_.remove(axis);
-        widget->deleteLater();
+        removeAxisView(axis);
+        ui->positionPlot->removeAxis(axis);
+        estimator_.reset(axis);
+        hasCommandedPulse_[axis] = false;
     }
 }
 
 void MainWindow::handleMoveRequest(int axis, bool isCcw)
 {
-    AxisControlWidget* widget = axisWidgets_.value(axis, nullptr);
-    if (!widget) return;
+    AxisPreset input;
+    if (!axisInput(axis, input)) return;
     savePreset(axis);
 
-    QString motorName = widget->getSelectedMotorName();
-    const StageMotorInfo& motor = motorDefinitions_[motorName];
-    double valuePhysical = widget->getInputValue();
-    if (isCcw) { valuePhysical = -qAbs(valuePhysical); } else { valuePhysical = qAbs(valuePhysical); }
-    bool isAbsolute = widget->isAbsoluteMode();
-    int speed = widget->getSelectedSpeed();
+    const int motorIndex = axisMotor_[axis];
+    const StageMotorInfo& motor = catalog_->at(motorIndex);
+    qint64 valueNano = MotorCatalog::toNano(input.value);
+    if (isCcw) { valueNano = -qAbs(valueNano); } else { valueNano = qAbs(valueNano); }
+    bool isAbsolute = input.isAbsolute;
+    int speed = input.speed;
 
-    double targetPosPhysical = 0.0;
-    if (isAbsolute) {
-        targetPosPhysical = valuePhysical;
-    } else {
-        double currentPosPhysical = static_cast<double>(currentPositionsPulse_.value(axis, 0)) * motor.value_per_pulse;
-        targetPosPhysical = currentPosPhysical + valuePhysical;
+    // Fixed-point throughout, so the target and the pulse count agree exactly
+    qint64 targetNano = valueNano;
+    if (!isAbsolute) {
+        // A relative move queued behind others (and merged with them) starts
+        // where they end; otherwise from the freshest sample of the io thread,
+        // not the last batch the GUI has drawn
+        int basePulse = manager_->snapshot()[axis].positionPulse;
+        if (hasCommandedPulse_[axis] && manager_->pendingCommandCountForAxis(axis) > 0) {
+            basePulse = commandedPulse_[axis];
+        }
+        targetNano = catalog_->pulseToNano(motorIndex, basePulse) + valueNano;
     }
 
-    double maxRange = motor.travel_range * 2.0;
-    if (targetPosPhysical < (0.0 - 1e-9) || targetPosPhysical > (maxRange + 1e-9)) {
+    if (!catalog_->inRange(motorIndex, targetNano)) {
         QMessageBox::critical(this, "Out of Range",
                               QString("Target position %1 %2 is out of range (0 ~ %3 %2).")
-                                  .arg(targetPosPhysical, 0, 'f', motor.display_precision)
+                                  .arg(MotorCatalog::formatNano(targetNano, motor.display_precision))
                                   .arg(motor.unit_symbol)
-                                  .arg(maxRange, 0, 'f', motor.display_precision));
+                                  .arg(MotorCatalog::formatNano(catalog_->rangeNano(motorIndex), motor.display_precision)));
         return;
     }
 
-    if (motor.value_per_pulse == 0) return;
-
-    int movePulse = 0;
-    if (isAbsolute) { movePulse = std::round(targetPosPhysical / motor.value_per_pulse); } else { movePulse = std::round(valuePhysical / motor.value_per_pulse); }
-
-    manager_->move(axis, movePulse, speed, isAbsolute);
+    const int movePulse = catalog_->nanoToPulse(motorIndex, isAbsolute ? targetNano : valueNano);
+    // A rejected move never runs: nothing to animate and no new end point
+    if (!manager_->move(axis, movePulse, speed, isAbsolute)) return;
+    const int targetPulse = catalog_->nanoToPulse(motorIndex, targetNano);
+    commandedPulse_[axis] = targetPulse;
+    hasCommandedPulse_[axis] = true;
+    estimator_.commandMove(axis, true, targetPulse, speed, monotonicNs());
+    animationTimer_->start();
 }
 
 void MainWindow::handleOriginRequest(int axis)
 {
-    AxisControlWidget* widget = axisWidgets_.value(axis, nullptr);
-    if (!widget) return;
+    AxisPreset input;
+    if (!axisInput(axis, input)) return;
     savePreset(axis);
-    int speed = widget->getSelectedSpeed();
+    int speed = input.speed;
 
     QMessageBox::StandardButton reply = QMessageBox::question(this, "Confirm Origin Return",
                                                               QString("Are you sure you want to perform an origin return for Axis %1?").arg(axis),
                                                               QMessageBox::Yes|QMessageBox::No);
 
     if (reply == QMessageBox::Yes) {
-        manager_->moveOrigin(axis, speed);
+        if (!manager_->moveOrigin(axis, speed)) return;
+        // Where the origin lies is up to the controller
+        hasCommandedPulse_[axis] = false;
+        estimator_.commandMove(axis, false, 0, speed, monotonicNs());
+        animationTimer_->start();
     }
 }
 
 // ... (Other functions like setupAxisWidget, handleImportRequest, etc. are unchanged)
 void MainWindow::setupAxisWidget(AxisControlWidget* widget)
 {
-    widget->populateMotorDropdown(motorDefinitions_);
+    widget->populateMotorDropdown(catalog_);
     connect(widget, &AxisControlWidget::moveRequested, this, &MainWindow::handleMoveRequest);
     connect(widget, &AxisControlWidget::originRequested, this, &MainWindow::handleOriginRequest);
     connect(widget, &AxisControlWidget::removalRequested, this, &MainWindow::handleRemovalRequest);
@@ -152,8 +428,8 @@ void MainWindow::handleImportRequest(int axis)
 {
     PresetDialog dialog(axis, presetManager_, this);
     connect(&dialog, &PresetDialog::presetApplied, this, [this, axis](const AxisPreset& preset){
-        if (axisWidgets_.contains(axis)) {
-            axisWidgets_[axis]->applyPreset(preset);
+        if (hasAxis(axis)) {
+            applyAxisInput(axis, preset);
         }
     });
     dialog.exec();
@@ -161,38 +437,246 @@ void MainWindow::handleImportRequest(int axis)
 
 void MainWindow::savePreset(int axis)
 {
-    AxisControlWidget* widget = axisWidgets_.value(axis, nullptr);
-    if(!widget) return;
     AxisPreset preset;
+    if (!axisInput(axis, preset)) return;
     preset.id = QUuid::createUuid();
-    preset.motorName = widget->getSelectedMotorName();
-    preset.isAbsolute = widget->isAbsoluteMode();
-    preset.value = widget->getInputValue();
-    preset.speed = widget->getSelectedSpeed();
     presetManager_->addPreset(axis, preset);
 }
 
-void MainWindow::updatePosition(int axis, int positionPulse)
+void MainWindow::updatePositions(const QVector<AxisSample> &samples)
+{
+    // Gather the displayed axes, convert them in one pass, then update the labels
+    constexpr std::size_t kSlots = AxisStateSnapshot::kMaxAxes + 1;
+    std::array<int, kSlots> axes, motors, pulses;
+    std::array<qint64, kSlots> positionsNano;
+    std::size_t count = 0;
+    for (const AxisSample& sample : samples) {
+        if (sample.axisNo < 1 || sample.axisNo > AxisStateSnapshot::kMaxAxes) continue;
+        positionPulse_[sample.axisNo] = sample.positionPulse;
+        estimator_.addSample(sample.axisNo, sample.timestampNs, sample.positionPulse);
+        if (axisMotor_[sample.axisNo] < 0 || count == kSlots) continue;
+        axes[count] = sample.axisNo;
+        motors[count] = axisMotor_[sample.axisNo];
+        pulses[count] = sample.positionPulse;
+        ++count;
+    }
+    catalog_->toPhysicalNano(motors.data(), pulses.data(), positionsNano.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (AxisControlWidget* widget = axisWidgets_.value(axes[i], nullptr)) {
+            widget->setPosition(positionsNano[i]);
+        } else {
+            // Marks the cell dirty; the table repaints changed cells once per frame
+            axisTableModel_->setPosition(axes[i], positionsNano[i]);
+        }
+    }
+}
+
+void MainWindow::setupEstimator()
+{
+    // Frame-rate ticks only while some axis is moving
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen ? screen->refreshRate() : 60.0;
+    animationTimer_ = new QTimer(this);
+    animationTimer_->setInterval(qMax(1, int(std::lround(1000.0 / qMax(1.0, refreshRate)))));
+    connect(animationTimer_, &QTimer::timeout, this, &MainWindow::animatePositions);
+
+    connect(manager_, &QtKohzuManager::commandCompleted, this, [this](int axis, bool, bool) {
+        // A superseded or merged move completes while the newer one is still pending
+        if (!estimator_.isEstimating(axis) || manager_->pendingCommandCountForAxis(axis) > 0) return;
+        estimator_.finishMove(axis);
+        refreshPosition(axis);
+    });
+}
+
+void MainWindow::animatePositions()
 {
-    currentPositionsPulse_[axis] = positionPulse;
-    AxisControlWidget* widget = axisWidgets_.value(axis, nullptr);
-    if (widget) {
-        QString motorName = widget->getSelectedMotorName();
-        if (motorDefinitions_.contains(motorName)) {
-            const StageMotorInfo& motor = motorDefinitions_[motorName];
-            double positionPhysical = static_cast<double>(positionPulse) * motor.value_per_pulse;
-            widget->setPosition(positionPhysical);
+    if (!estimator_.anyEstimating()) {
+        animationTimer_->stop();
+        return;
+    }
+
+    // Same batched conversion as updatePositions, fed with the estimates
+    constexpr std::size_t kSlots = AxisStateSnapshot::kMaxAxes + 1;
+    std::array<int, kSlots> axes, motors, pulses;
+    std::array<qint64, kSlots> positionsNano;
+    std::size_t count = 0;
+    const std::int64_t now = monotonicNs();
+    for (int axis = 1; axis <= AxisStateSnapshot::kMaxAxes; ++axis) {
+        if (axisMotor_[axis] < 0 || !estimator_.isEstimating(axis)) continue;
+        axes[count] = axis;
+        motors[count] = axisMotor_[axis];
+        pulses[count] = estimator_.estimate(axis, now);
+        ++count;
+    }
+    catalog_->toPhysicalNano(motors.data(), pulses.data(), positionsNano.data(), count);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (AxisControlWidget* widget = axisWidgets_.value(axes[i], nullptr)) {
+            widget->setPosition(positionsNano[i]);
+        } else {
+            axisTableModel_->setPosition(axes[i], positionsNano[i]);
         }
     }
 }
 
-void MainWindow::handleMotorSelectionChange(int axis, const QString &motorName)
+void MainWindow::refreshPosition(int axis)
+{
+    if (axisMotor_[axis] < 0) return;
+    const qint64 positionNano = catalog_->pulseToNano(axisMotor_[axis], positionPulse_[axis]);
+    if (AxisControlWidget* widget = axisWidgets_.value(axis, nullptr)) {
+        widget->setPosition(positionNano);
+    } else {
+        axisTableModel_->setPosition(axis, positionNano);
+    }
+}
+
+void MainWindow::handleMotorSelectionChange(int axis, int motorIndex)
+{
+    axisMotor_[axis] = motorIndex;
+    refreshPosition(axis);
+    ui->positionPlot->update();
+}
+
+void MainWindow::setupMetrics()
+{
+    metricsLabel_ = new QLabel(this);
+    ui->statusbar->addPermanentWidget(metricsLabel_);
+    auto *labelTimer = new QTimer(this);
+    connect(labelTimer, &QTimer::timeout, this, &MainWindow::updateMetricsLabel);
+    labelTimer->start(1000);
+    updateMetricsLabel();
+}
+
+bool MainWindow::startTrajectoryRecording(const QString &filePath, int samplesPerAxis)
+{
+    // Motion history of every polled axis, kept on disk across runs
+    if (!manager_->startTrajectoryRecording(filePath, samplesPerAxis)) {
+        return false;
+    }
+    appendLog(LogLevel::Info, 0, QString("Recording trajectories to %1").arg(filePath));
+    return true;
+}
+
+bool MainWindow::startLogFile(const QString &filePath)
+{
+    if (!logModel_->buffer().enableFileSpill(filePath)) {
+        appendLog(LogLevel::Warning, 0, QString("Could not open log file %1").arg(filePath));
+        return false;
+    }
+    appendLog(LogLevel::Info, 0, QString("Writing the log to %1").arg(filePath));
+    return true;
+}
+
+void MainWindow::startMetricsExport(const QString &filePath, int intervalMs)
+{
+    // Prometheus text file for node_exporter's textfile collector
+    if (!metricsExporter_) {
+        metricsExporter_ = new MetricsExporter(manager_, this);
+    }
+    metricsExporter_->start(filePath, intervalMs);
+    appendLog(LogLevel::Info, 0, QString("Writing metrics to %1").arg(filePath));
+}
+
+void MainWindow::updateMetricsLabel()
+{
+    const auto metrics = manager_->metrics();
+    // Moves take seconds and system commands milliseconds: one mixed percentile would describe neither
+    const auto motion = metrics->motionStageSnapshot(LatencyStage::Total);
+    const auto system = metrics->latency(CommandKind::System, LatencyStage::Total).snapshot();
+    const auto lateness = metrics->pollLateness().snapshot();
+    const auto estimateError = estimator_.errorHistogram().snapshot();
+    auto ms = [](std::int64_t ns) { return QString::number(ns / 1e6, 'f', 1); };
+
+    metricsLabel_->setText(QString("move p50 %1 ms / p99 %2 ms | sys p50 %3 ms / p99 %4 ms | queue %5 (%6 in flight)"
+                                   " | poll late p99 %7 ms | reconnects %8 | estimate err p99 %9 pulse")
+                               .arg(ms(motion.percentile(0.5)), ms(motion.percentile(0.99)))
+                               .arg(ms(system.percentile(0.5)), ms(system.percentile(0.99)))
+                               .arg(manager_->pendingCommandCount())
+                               .arg(manager_->inFlightCommandCount())
+                               .arg(ms(lateness.percentile(0.99)))
+                               .arg(metrics->reconnects())
+                               .arg(estimateError.percentile(0.99)));
+}
+
+void MainWindow::setupPlot()
+{
+    // Lanes scale to the pulses shown; the labels use the axis' selected motor
+    ui->positionPlot->setValueFormatter([this](int axis, int pulse) {
+        const int motor = axisMotor_[axis];
+        if (motor < 0) return QString::number(pulse);
+        const StageMotorInfo& info = catalog_->at(motor);
+        return QString("%1 %2").arg(MotorCatalog::formatNano(catalog_->pulseToNano(motor, pulse), info.display_precision),
+                                    info.unit_symbol);
+    });
+    ui->axisSplitter->setStretchFactor(0, 3);
+    ui->axisSplitter->setStretchFactor(1, 2);
+}
+
+void MainWindow::setupAxisTable()
+{
+    tableMode_ = false;
+    axisTableModel_ = new AxisTableModel(catalog_, this);
+    auto *delegate = new AxisTableDelegate(this);
+    ui->axisTableView->setModel(axisTableModel_);
+    ui->axisTableView->setItemDelegate(delegate);
+    ui->axisTableView->verticalHeader()->setVisible(false);
+    ui->axisTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->axisTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->axisTableView->horizontalHeader()->setSectionResizeMode(AxisTableModel::PositionColumn, QHeaderView::Stretch);
+    ui->axisStack->setCurrentWidget(ui->widgetPage);
+
+    connect(axisTableModel_, &AxisTableModel::motorSelectionChanged, this, &MainWindow::handleMotorSelectionChange);
+    // Queued: the handlers may open dialogs or remove the row the click came from
+    connect(delegate, &AxisTableDelegate::moveRequested, this, &MainWindow::handleMoveRequest, Qt::QueuedConnection);
+    connect(delegate, &AxisTableDelegate::originRequested, this, &MainWindow::handleOriginRequest, Qt::QueuedConnection);
+    connect(delegate, &AxisTableDelegate::removalRequested, this, &MainWindow::handleRemovalRequest, Qt::QueuedConnection);
+    connect(delegate, &AxisTableDelegate::importRequested, this, &MainWindow::handleImportRequest, Qt::QueuedConnection);
+}
+
+void MainWindow::setupLogView()
+{
+    logModel_ = new LogListModel(10000, this);
+    ui->logListView->setModel(logModel_);
+
+    ui->logLevelComboBox->addItem("Debug", int(LogLevel::Debug));
+    ui->logLevelComboBox->addItem("Info", int(LogLevel::Info));
+    ui->logLevelComboBox->addItem("Warning", int(LogLevel::Warning));
+    ui->logLevelComboBox->addItem("Error", int(LogLevel::Error));
+    ui->logLevelComboBox->setCurrentIndex(1);
+
+    auto applyFilter = [this]() {
+        logModel_->setFilter(static_cast<LogLevel>(ui->logLevelComboBox->currentData().toInt()),
+                             ui->logAxisSpinBox->value());
+    };
+    connect(ui->logLevelComboBox, &QComboBox::currentIndexChanged, this, applyFilter);
+    connect(ui->logAxisSpinBox, &QSpinBox::valueChanged, this, applyFilter);
+    applyFilter();
+
+    // Follow the tail only while the user has not scrolled up
+    auto followTail = std::make_shared<bool>(true);
+    connect(logModel_, &QAbstractItemModel::rowsAboutToBeInserted, this, [this, followTail]() {
+        QScrollBar* bar = ui->logListView->verticalScrollBar();
+        *followTail = bar->value() == bar->maximum();
+    });
+    connect(logModel_, &QAbstractItemModel::rowsInserted, this, [this, followTail]() {
+        if (*followTail) ui->logListView->scrollToBottom();
+    });
+}
+
+void MainWindow::logEvent(QtKohzuManager::LogSeverity severity, int axis, const QString &message)
 {
-    updatePosition(axis, currentPositionsPulse_.value(axis, 0));
+    LogLevel level = LogLevel::Info;
+    if (severity == QtKohzuManager::LogSeverity::Warning) level = LogLevel::Warning;
+    else if (severity == QtKohzuManager::LogSeverity::Error) level = LogLevel::Error;
+    appendLog(level, axis, message);
 }
 
-void MainWindow::logMessage(const QString &message)
+void MainWindow::appendLog(LogLevel level, int axis, const QString &text)
 {
-    ui->logTextEdit->append(message);
+    LogEntry entry;
+    entry.timestampMs = QDateTime::currentMSecsSinceEpoch();
+    entry.axisNo = axis;
+    entry.level = level;
+    entry.text = text;
+    logModel_->append(std::move(entry));
 }
 
@@ -3,10 +3,20 @@
 
 #include <QMainWindow>
 #include <QMap>
+#include <array>
+#include <memory>
 #include "QtKohzuManager.h"
 #include "AxisControlWidget.h"
-#include "StageMotorInfo.h"
+#include "MotorCatalog.h"
 #include "PresetManager.h"
+#include "LogEntry.h"
+#include "MotionEstimator.h"
+
+class AxisTableModel;
+class LogListModel;
+class MetricsExporter;
+class QLabel;
+class QTimer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -20,32 +30,76 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Opt-in Prometheus text file of the connection's metrics
+    void startMetricsExport(const QString& filePath, int intervalMs);
+    // Opt-in memory-mapped trajectory ring; false if the file cannot be mapped
+    bool startTrajectoryRecording(const QString& filePath, int samplesPerAxis);
+    // Opt-in rotating file copy of the log pane; false if the file cannot be opened
+    bool startLogFile(const QString& filePath);
+
 private slots:
     void on_connectButton_clicked();
     void on_addAxisButton_clicked();
+    void on_tableViewCheckBox_toggled(bool checked);
+    void on_homeAllButton_clicked();
+    void on_runSequenceButton_clicked();
+    void on_abortSequenceButton_clicked();
+    void on_exportTrajectoryButton_clicked();
+    void updateSequenceProgress(int stepIndex, const QString& description);
+    void handleSequenceFinished(bool completed, const QString& message);
+    void handleHomingAxisFinished(int axis, bool success, double seconds);
+    void handleHomingFinished(bool completed, const QString& message);
 
-    void logMessage(const QString &message);
+    void logEvent(QtKohzuManager::LogSeverity severity, int axis, const QString &message);
     void updateConnectionStatus(bool connected);
-    void updatePosition(int axis, int position_pulse);
+    void updateConnectionState(QtKohzuManager::ConnectionState state);
+    void updatePositions(const QVector<AxisSample>& samples);
 
     void handleMoveRequest(int axis, bool is_ccw);
     void handleOriginRequest(int axis);
     void handleRemovalRequest(int axis);
-    void handleMotorSelectionChange(int axis, const QString& motorName);
+    void handleMotorSelectionChange(int axis, int motorIndex);
     void handleImportRequest(int axis);
+    void updateMetricsLabel();
+    void animatePositions();
 
 private:
     void restartMonitoring();
     void setupAxisWidget(AxisControlWidget* widget);
+    void setupAxisTable();
+    // Axes live either in AxisControlWidgets or in table rows, depending on the view mode
+    void addAxisView(int axis);
+    void removeAxisView(int axis);
+    bool hasAxis(int axis) const;
+    bool axisInput(int axis, AxisPreset& input) const;
+    void applyAxisInput(int axis, const AxisPreset& input);
+    void refreshPosition(int axis);
     void savePreset(int axis);
+    void setupLogView();
+    void setupMetrics();
+    void setupPlot();
+    void setupEstimator();
+    void appendLog(LogLevel level, int axis, const QString& text);
 
     Ui::MainWindow *ui;
     QtKohzuManager *manager_;
     PresetManager *presetManager_;
+    LogListModel *logModel_;
+    AxisTableModel *axisTableModel_;
+    bool tableMode_;
+    QLabel *metricsLabel_;
+    MetricsExporter *metricsExporter_ = nullptr;   // only with --metrics-file
+    QTimer *animationTimer_;
+    MotionEstimator estimator_;
 
     QMap<int, AxisControlWidget*> axisWidgets_;
-    QMap<QString, StageMotorInfo> motorDefinitions_;
-    QMap<int, int> currentPositionsPulse_;
+    std::shared_ptr<const MotorCatalog> catalog_;
+    // Indexed by axis number: catalog index of the selected motor (-1 = no widget) and last position
+    std::array<int, AxisStateSnapshot::kMaxAxes + 1> axisMotor_;
+    std::array<int, AxisStateSnapshot::kMaxAxes + 1> positionPulse_;
+    // End point of the last accepted move per axis, the base for relative moves queued behind it
+    std::array<int, AxisStateSnapshot::kMaxAxes + 1> commandedPulse_;
+    std::array<bool, AxisStateSnapshot::kMaxAxes + 1> hasCommandedPulse_;
 };
 #endif // MAINWINDOW_H
 
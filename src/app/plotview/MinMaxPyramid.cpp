@@ -0,0 +1,79 @@
+#include "MinMaxPyramid.h"
+#include <algorithm>
+
+MinMaxPyramid::MinMaxPyramid(int binsPerLevel)
+    : levels_(kLevels, std::vector<Bin>(static_cast<std::size_t>(std::max(binsPerLevel, 16))))
+{
+}
+
+std::int64_t MinMaxPyramid::binWidthNs(int level)
+{
+    std::int64_t width = kBaseBinNs;
+    for (int i = 0; i < level; ++i) width *= kFanOut;
+    return width;
+}
+
+void MinMaxPyramid::append(std::int64_t timestampNs, int value)
+{
+    if (timestampNs < 0) return;
+    timestampNs = std::max(timestampNs, latestNs_);
+
+    std::int64_t width = kBaseBinNs;
+    for (std::vector<Bin>& ring : levels_) {
+        const std::int64_t index = timestampNs / width;
+        Bin& bin = ring[static_cast<std::size_t>(index % static_cast<std::int64_t>(ring.size()))];
+        if (bin.index != index) {
+            bin = Bin{index, value, value, value, value};
+        } else {
+            bin.min = std::min(bin.min, value);
+            bin.max = std::max(bin.max, value);
+            bin.last = value;
+        }
+        width *= kFanOut;
+    }
+    latestNs_ = timestampNs;
+    latestValue_ = value;
+}
+
+void MinMaxPyramid::clear()
+{
+    for (std::vector<Bin>& ring : levels_) {
+        std::fill(ring.begin(), ring.end(), Bin{});
+    }
+    latestNs_ = -1;
+    latestValue_ = 0;
+}
+
+int MinMaxPyramid::levelFor(std::int64_t fromNs, std::int64_t pixelNs) const
+{
+    int level = 0;
+    while (level + 1 < kLevels && binWidthNs(level + 1) <= pixelNs) ++level;
+
+    // Fall back to coarser bins where the finer ring no longer reaches fromNs
+    while (level + 1 < kLevels && latestNs_ >= 0) {
+        const std::int64_t width = binWidthNs(level);
+        const std::int64_t oldestIndex = latestNs_ / width - static_cast<std::int64_t>(levels_[level].size()) + 1;
+        if (fromNs / width >= oldestIndex) break;
+        ++level;
+    }
+    return level;
+}
+
+bool MinMaxPyramid::valueBefore(int level, std::int64_t fromNs, int &value) const
+{
+    if (latestNs_ < 0) return false;
+
+    const std::int64_t width = binWidthNs(level);
+    const std::vector<Bin>& ring = levels_[level];
+    const std::int64_t capacity = static_cast<std::int64_t>(ring.size());
+    const std::int64_t newest = latestNs_ / width;
+    const std::int64_t start = std::min(fromNs / width - 1, newest);
+    for (std::int64_t index = start; index >= 0 && index > newest - capacity; --index) {
+        const Bin& bin = ring[static_cast<std::size_t>(index % capacity)];
+        if (bin.index == index) {
+            value = bin.last;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Multi-resolution min/max summary of one axis' position over time.
+//
+// Level 0 bins are kBaseBinNs wide and every level above is kFanOut times
+// wider. Each level is a ring of `binsPerLevel` bins keyed by their absolute
+// bin index, so an append touches one bin per level and stale bins are
+// recognised by their index instead of being cleared. A reader picks the
+// finest level whose bins are no wider than a pixel (and that still reaches
+// back to the window start), which bounds the bins visited per frame to about
+// kFanOut per pixel whatever the window length.
+//
+// The position stream only carries changes, so a bin with no samples means
+// "unchanged since the previous bin".
+//
+// GUI thread only.
+class MinMaxPyramid
+{
+public:
+    static constexpr std::int64_t kBaseBinNs = 10'000'000;   // 10 ms, the fastest poll period
+    static constexpr int kFanOut = 4;
+    static constexpr int kLevels = 9;                         // top level: 10 ms * 4^8 = 11 min bins
+
+    struct Bin {
+        std::int64_t index = -1;   // absolute bin index (startNs / width), -1 = empty
+        int min = 0;
+        int max = 0;
+        int first = 0;
+        int last = 0;
+    };
+
+    explicit MinMaxPyramid(int binsPerLevel = 2048);
+
+    // timestampNs must not go backwards (steady_clock samples of one axis)
+    void append(std::int64_t timestampNs, int value);
+    void clear();
+
+    bool isEmpty() const { return latestNs_ < 0; }
+    std::int64_t latestNs() const { return latestNs_; }
+    int latestValue() const { return latestValue_; }
+
+    static std::int64_t binWidthNs(int level);
+    // Finest level with bins no wider than pixelNs that still covers fromNs
+    int levelFor(std::int64_t fromNs, std::int64_t pixelNs) const;
+    // Last value recorded before fromNs at that level; false if none is retained
+    bool valueBefore(int level, std::int64_t fromNs, int& value) const;
+
+    // Visits the non-empty bins of a level overlapping [fromNs, toNs] in time
+    // order as visit(binStartNs, bin)
+    template <typename Visitor>
+    void forEachBin(int level, std::int64_t fromNs, std::int64_t toNs, Visitor&& visit) const
+    {
+        const std::int64_t width = binWidthNs(level);
+        const std::vector<Bin>& ring = levels_[level];
+        const std::int64_t capacity = static_cast<std::int64_t>(ring.size());
+        const std::int64_t newest = latestNs_ < 0 ? -1 : latestNs_ / width;
+        // Bin indices are never negative: a window reaching before time zero,
+        // or a ring not yet filled, must not index the ring with index % capacity < 0
+        std::int64_t begin = std::max<std::int64_t>(fromNs / width, 0);
+        const std::int64_t end = std::min(toNs / width, newest);
+        if (begin < end - capacity + 1) begin = end - capacity + 1;
+        for (std::int64_t index = begin; index <= end; ++index) {
+            const Bin& bin = ring[static_cast<std::size_t>(index % capacity)];
+            if (bin.index == index) visit(index * width, bin);
+        }
+    }
+
+private:
+    std::vector<std::vector<Bin>> levels_;
+    std::int64_t latestNs_ = -1;
+    int latestValue_ = 0;
+};
+
+#endif // MINMAXPYRAMID_H
@@ -0,0 +1,190 @@
+#include "PositionPlotWidget.h"
+#include "LatencyHistogram.h"
+#include <QGuiApplication>
+#include <QPainter>
+#include <QScreen>
+#include <QTimer>
+#include <QWheelEvent>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr qint64 kMinWindowNs = 1'000'000'000;             // 1 s
+constexpr qint64 kMaxWindowNs = 4LL * 3600 * 1'000'000'000; // 4 h
+constexpr int kLaneMargin = 4;
+
+QColor laneColor(int axisNo)
+{
+    return QColor::fromHsv((axisNo * 47) % 360, 160, 235);
+}
+
+} // namespace
+
+PositionPlotWidget::PositionPlotWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMinimumSize(200, 120);
+    formatter_ = [](int, int pulse) { return QString::number(pulse); };
+
+    // Repaint at most once per display frame
+    const QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen ? screen->refreshRate() : 60.0;
+    repaintTimer_ = new QTimer(this);
+    repaintTimer_->setSingleShot(true);
+    repaintTimer_->setInterval(qMax(1, int(std::lround(1000.0 / qMax(1.0, refreshRate)))));
+    connect(repaintTimer_, &QTimer::timeout, this, qOverload<>(&QWidget::update));
+}
+
+void PositionPlotWidget::setWindowNs(qint64 windowNs)
+{
+    windowNs_ = qBound(kMinWindowNs, windowNs, kMaxWindowNs);
+    update();
+}
+
+void PositionPlotWidget::setValueFormatter(ValueFormatter formatter)
+{
+    formatter_ = std::move(formatter);
+    update();
+}
+
+void PositionPlotWidget::addAxis(int axisNo)
+{
+    if (axes_.count(axisNo)) return;
+    axes_.emplace(axisNo, std::make_unique<MinMaxPyramid>());
+    update();
+}
+
+void PositionPlotWidget::removeAxis(int axisNo)
+{
+    if (axes_.erase(axisNo)) update();
+}
+
+void PositionPlotWidget::appendSamples(const QVector<AxisSample> &samples)
+{
+    bool changed = false;
+    for (const AxisSample& sample : samples) {
+        auto it = axes_.find(sample.axisNo);
+        if (it == axes_.end()) continue;
+        it->second->append(sample.timestampNs, sample.positionPulse);
+        changed = true;
+    }
+    if (changed) scheduleRepaint();
+}
+
+void PositionPlotWidget::scheduleRepaint()
+{
+    if (!repaintTimer_->isActive()) {
+        repaintTimer_->start();
+    }
+}
+
+void PositionPlotWidget::wheelEvent(QWheelEvent *event)
+{
+    // Wheel up zooms in
+    const double steps = event->angleDelta().y() / 120.0;
+    setWindowNs(qint64(double(windowNs_) * std::pow(1.25, -steps)));
+    event->accept();
+}
+
+void PositionPlotWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(0x23, 0x2f, 0x3c));
+    if (axes_.empty()) return;
+
+    const qint64 toNs = monotonicNs();
+    const qint64 fromNs = toNs - windowNs_;
+    const int laneCount = int(axes_.size());
+    const int laneHeight = height() / laneCount;
+
+    int laneIndex = 0;
+    for (const auto& [axisNo, pyramid] : axes_) {
+        const QRect lane(0, laneIndex * laneHeight, width(), laneHeight);
+        if (laneIndex > 0) {
+            painter.setPen(QColor(0x4a, 0x62, 0x7a));
+            painter.drawLine(lane.topLeft(), lane.topRight());
+        }
+        drawLane(painter, lane, axisNo, *pyramid, fromNs, toNs);
+        ++laneIndex;
+    }
+
+    painter.setPen(QColor(0xbd, 0xc3, 0xc7));
+    const QString span = windowNs_ >= 120'000'000'000 ? QString("%1 min").arg(windowNs_ / 60e9, 0, 'f', 1)
+                                                      : QString("%1 s").arg(windowNs_ / 1e9, 0, 'f', 1);
+    painter.drawText(rect().adjusted(0, 0, -kLaneMargin, -kLaneMargin), Qt::AlignRight | Qt::AlignBottom, span);
+}
+
+void PositionPlotWidget::drawLane(QPainter &painter, const QRect &lane, int axisNo, const MinMaxPyramid &pyramid,
+                                  qint64 fromNs, qint64 toNs)
+{
+    const int columnCount = qMax(1, lane.width());
+    const qint64 pixelNs = qMax<qint64>(1, (toNs - fromNs) / columnCount);
+    const int level = pyramid.levelFor(fromNs, pixelNs);
+
+    // Reduce the window to one min/max column per pixel
+    columns_.fill(Column{}, columnCount);
+    pyramid.forEachBin(level, fromNs, toNs, [&](qint64 binStartNs, const MinMaxPyramid::Bin& bin) {
+        const int index = int(qBound<qint64>(0, (binStartNs - fromNs) / pixelNs, columnCount - 1));
+        Column& column = columns_[index];
+        if (!column.hasData) {
+            column = Column{true, bin.first, bin.last, bin.min, bin.max};
+        } else {
+            column.last = bin.last;
+            column.min = qMin(column.min, bin.min);
+            column.max = qMax(column.max, bin.max);
+        }
+    });
+
+    int holdValue = 0;
+    const bool hasHold = pyramid.valueBefore(level, fromNs, holdValue);
+    int low = holdValue;
+    int high = holdValue;
+    bool hasData = hasHold;
+    for (const Column& column : std::as_const(columns_)) {
+        if (!column.hasData) continue;
+        low = hasData ? qMin(low, column.min) : column.min;
+        high = hasData ? qMax(high, column.max) : column.max;
+        hasData = true;
+    }
+
+    painter.setPen(QColor(0xbd, 0xc3, 0xc7));
+    const QRect text = lane.adjusted(kLaneMargin, kLaneMargin, -kLaneMargin, -kLaneMargin);
+    if (!hasData) {
+        painter.drawText(text, Qt::AlignLeft | Qt::AlignTop, QString("Axis %1  (no data)").arg(axisNo));
+        return;
+    }
+
+    const double span = high > low ? double(high) - double(low) : 1.0;
+    const double top = lane.top() + kLaneMargin;
+    const double usable = qMax(1, lane.height() - 2 * kLaneMargin);
+    auto y = [&](int value) { return top + usable * (1.0 - (double(value) - double(low)) / span); };
+
+    // Positions hold between samples, so gaps are drawn as steps
+    points_.clear();
+    int current = holdValue;
+    if (hasHold) points_.append(QPointF(lane.left(), y(holdValue)));
+    for (int i = 0; i < columnCount; ++i) {
+        const Column& column = columns_[i];
+        if (!column.hasData) continue;
+        const double x = lane.left() + i;
+        if (!points_.isEmpty()) points_.append(QPointF(x, y(current)));
+        points_.append(QPointF(x, y(column.first)));
+        points_.append(QPointF(x, y(column.min)));
+        points_.append(QPointF(x, y(column.max)));
+        points_.append(QPointF(x, y(column.last)));
+        current = column.last;
+    }
+    points_.append(QPointF(lane.right(), y(current)));
+
+    painter.setPen(QPen(laneColor(axisNo), 1.0));
+    painter.drawPolyline(points_.constData(), int(points_.size()));
+
+    painter.setPen(QColor(0xbd, 0xc3, 0xc7));
+    painter.drawText(text, Qt::AlignLeft | Qt::AlignTop,
+                     QString("Axis %1  %2").arg(axisNo).arg(formatter_(axisNo, pyramid.latestValue())));
+    painter.drawText(text, Qt::AlignRight | Qt::AlignTop, formatter_(axisNo, high));
+    painter.drawText(text.adjusted(0, 0, 0, -painter.fontMetrics().height()), Qt::AlignRight | Qt::AlignBottom,
+                     formatter_(axisNo, low));
+}
@@ -0,0 +1,68 @@
+#ifndef POSITIONPLOTWIDGET_H
+#define POSITIONPLOTWIDGET_H
+
+#include <QVector>
+#include <QWidget>
+#include <functional>
+#include <map>
+#include <memory>
+#include "AxisSample.h"
+#include "MinMaxPyramid.h"
+
+class QTimer;
+
+// Position-versus-time strip chart, one lane per axis.
+//
+// Samples from QtKohzuManager::positionsUpdated go into a MinMaxPyramid per
+// axis; a frame reduces each lane to one min/max column per pixel at the
+// pyramid level matching the window, so drawing costs O(width) per axis for
+// a 5 second or a 1 hour window alike. Repaints happen only after new data
+// and at most once per display refresh. Each lane scales to the range shown.
+class PositionPlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    // Text for a lane's range labels, e.g. the pulse converted to mm
+    using ValueFormatter = std::function<QString(int axisNo, int pulse)>;
+
+    explicit PositionPlotWidget(QWidget *parent = nullptr);
+
+    void setWindowNs(qint64 windowNs);
+    qint64 windowNs() const { return windowNs_; }
+    void setValueFormatter(ValueFormatter formatter);
+
+    void addAxis(int axisNo);
+    void removeAxis(int axisNo);
+
+    QSize sizeHint() const override { return QSize(480, 240); }
+
+public slots:
+    void appendSamples(const QVector<AxisSample>& samples);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    struct Column {
+        bool hasData = false;
+        int first = 0;
+        int last = 0;
+        int min = 0;
+        int max = 0;
+    };
+
+    void scheduleRepaint();
+    void drawLane(QPainter& painter, const QRect& lane, int axisNo, const MinMaxPyramid& pyramid,
+                  qint64 fromNs, qint64 toNs);
+
+    std::map<int, std::unique_ptr<MinMaxPyramid>> axes_;
+    qint64 windowNs_ = 60'000'000'000;
+    ValueFormatter formatter_;
+    QTimer* repaintTimer_;
+    QVector<Column> columns_;    // reused between lanes and frames
+    QVector<QPointF> points_;
+};
+
+#endif // POSITIONPLOTWIDGET_H
@@ -1,88 +1,52 @@
 #include "PresetDialog.h"
 #include "ui_PresetDialog.h"
-#include <QListWidgetItem>
-#include <QHBoxLayout>
-#include <QLabel>
-#include <QPushButton>
+#include "PresetItemDelegate.h"
+#include "PresetListModel.h"
+#include <QSortFilterProxyModel>
 
 PresetDialog::PresetDialog(int axis, PresetManager* manager, QWidget *parent) :
     QDialog(parent),
     ui(new Ui::PresetDialog),
-    axisNumber_(axis),
-    presetManager_(manager)
+    axisNumber_(axis)
 {
     ui->setupUi(this);
     setWindowTitle(QString("Axis %1 Presets").arg(axisNumber_));
-    populateList();
-}
-
-PresetDialog::~PresetDialog()
-{
-    delete ui;
-}
-
-void PresetDialog::populateList()
-{
-    ui->listWidget->clear();
-    currentPresets_ = presetManager_->loadPresets(axisNumber_);
-
-    for (int i = 0; i < currentPresets_.size(); ++i) {
-        const auto& preset = currentPresets_[i];
 
-        QWidget* widget = new QWidget;
-        QHBoxLayout* layout = new QHBoxLayout(widget);
-        layout->setContentsMargins(5, 5, 5, 5);
+    model_ = new PresetListModel(axisNumber_, manager, this);
 
-        QString labelText = QString("Motor: %1, Mode: %2, Value: %3, Speed: %4")
-                                .arg(preset.motorName)
-                                .arg(preset.isAbsolute ? "Abs" : "Rel")
-                                .arg(preset.value)
-                                .arg(preset.speed);
+    // Filtering runs over the in-memory rows; nothing is reloaded while typing
+    filterModel_ = new QSortFilterProxyModel(this);
+    filterModel_->setSourceModel(model_);
+    filterModel_->setFilterRole(PresetListModel::SearchTextRole);
+    filterModel_->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    connect(ui->filterLineEdit, &QLineEdit::textChanged, filterModel_, &QSortFilterProxyModel::setFilterFixedString);
 
-        QLabel* label = new QLabel(labelText, widget);
-        label->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    auto* delegate = new PresetItemDelegate(this);
+    connect(delegate, &PresetItemDelegate::applyRequested, this, &PresetDialog::onApplyRequested);
+    connect(delegate, &PresetItemDelegate::deleteRequested, this, &PresetDialog::onDeleteRequested);
 
-        QPushButton* applyButton = new QPushButton("Apply", widget);
-        QPushButton* deleteButton = new QPushButton("Delete", widget);
-
-        applyButton->setProperty("presetIndex", i);
-        deleteButton->setProperty("presetIndex", i);
-
-        connect(applyButton, &QPushButton::clicked, this, &PresetDialog::onApplyClicked);
-        connect(deleteButton, &QPushButton::clicked, this, &PresetDialog::onDeleteClicked);
-
-        layout->addWidget(label);
-        layout->addWidget(applyButton);
-        layout->addWidget(deleteButton);
+    ui->presetListView->setModel(filterModel_);
+    ui->presetListView->setItemDelegate(delegate);
+}
 
-        QListWidgetItem* item = new QListWidgetItem(ui->listWidget);
-        item->setSizeHint(widget->sizeHint());
-        ui->listWidget->addItem(item);
-        ui->listWidget->setItemWidget(item, widget);
-    }
+PresetDialog::~PresetDialog()
+{
+    delete ui;
 }
 
-void PresetDialog::onApplyClicked()
+void PresetDialog::onApplyRequested(const QModelIndex &proxyIndex)
 {
-    QPushButton* button = qobject_cast<QPushButton*>(sender());
-    if (button) {
-        int index = button->property("presetIndex").toInt();
-        if (index >= 0 && index < currentPresets_.size()) {
-            emit presetApplied(currentPresets_[index]);
-            accept();
-        }
+    const QModelIndex index = filterModel_->mapToSource(proxyIndex);
+    if (index.isValid()) {
+        emit presetApplied(model_->presetAt(index.row()));
+        accept();
     }
 }
 
-void PresetDialog::onDeleteClicked()
+void PresetDialog::onDeleteRequested(const QModelIndex &proxyIndex)
 {
-    QPushButton* button = qobject_cast<QPushButton*>(sender());
-    if (button) {
-        int index = button->property("presetIndex").toInt();
-        if (index >= 0 && index < currentPresets_.size()) {
-            currentPresets_.removeAt(index);
-            presetManager_->savePresets(axisNumber_, currentPresets_);
-            populateList(); // Refresh the list
-        }
+    const QModelIndex index = filterModel_->mapToSource(proxyIndex);
+    if (index.isValid()) {
+        model_->removePresetAt(index.row());
     }
 }
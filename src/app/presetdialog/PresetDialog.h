@@ -2,9 +2,11 @@
 #define PRESETDIALOG_H
 
 #include <QDialog>
-#include <QList>
 #include "PresetManager.h"
 
+class PresetListModel;
+class QSortFilterProxyModel;
+
 namespace Ui {
 class PresetDialog;
 }
@@ -21,15 +23,14 @@ signals:
     void presetApplied(const AxisPreset& preset);
 
 private slots:
-    void populateList();
-    void onApplyClicked();
-    void onDeleteClicked();
+    void onApplyRequested(const QModelIndex& proxyIndex);
+    void onDeleteRequested(const QModelIndex& proxyIndex);
 
 private:
     Ui::PresetDialog *ui;
     int axisNumber_;
-    PresetManager* presetManager_;
-    QList<AxisPreset> currentPresets_;
+    PresetListModel* model_;
+    QSortFilterProxyModel* filterModel_;
 };
 
 #endif // PRESETDIALOG_H
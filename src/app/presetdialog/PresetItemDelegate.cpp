@@ -0,0 +1,67 @@
+#include "PresetItemDelegate.h"
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+
+namespace {
+constexpr int kMargin = 5;
+constexpr int kButtonWidth = 70;
+constexpr int kRowHeight = 34;
+}
+
+PresetItemDelegate::PresetItemDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
+
+QRect PresetItemDelegate::deleteButtonRect(const QRect &rowRect) const
+{
+    return QRect(rowRect.right() - kMargin - kButtonWidth, rowRect.top() + kMargin,
+                 kButtonWidth, rowRect.height() - 2 * kMargin);
+}
+
+QRect PresetItemDelegate::applyButtonRect(const QRect &rowRect) const
+{
+    return deleteButtonRect(rowRect).translated(-(kButtonWidth + kMargin), 0);
+}
+
+void PresetItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QStyleOptionViewItem itemOption = option;
+    initStyleOption(&itemOption, index);
+    // Leave room on the right for the buttons
+    itemOption.rect.setRight(applyButtonRect(option.rect).left() - kMargin);
+    QStyle* style = option.widget ? option.widget->style() : QApplication::style();
+    style->drawControl(QStyle::CE_ItemViewItem, &itemOption, painter, option.widget);
+
+    QStyleOptionButton button;
+    button.state = QStyle::State_Enabled;
+    button.rect = applyButtonRect(option.rect);
+    button.text = "Apply";
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
+
+    button.rect = deleteButtonRect(option.rect);
+    button.text = "Delete";
+    style->drawControl(QStyle::CE_PushButton, &button, painter, option.widget);
+}
+
+QSize PresetItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setHeight(qMax(size.height(), kRowHeight));
+    return size;
+}
+
+bool PresetItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option,
+                                     const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        const QPoint pos = static_cast<QMouseEvent*>(event)->position().toPoint();
+        if (applyButtonRect(option.rect).contains(pos)) {
+            emit applyRequested(index);
+            return true;
+        }
+        if (deleteButtonRect(option.rect).contains(pos)) {
+            emit deleteRequested(index);
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
@@ -0,0 +1,31 @@
+#ifndef PRESETITEMDELEGATE_H
+#define PRESETITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+// Paints each preset row as its label plus Apply/Delete buttons, so a row
+// costs no widgets; clicks on the painted buttons are reported as signals.
+class PresetItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    explicit PresetItemDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+signals:
+    void applyRequested(const QModelIndex& index);
+    void deleteRequested(const QModelIndex& index);
+
+protected:
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem& option,
+                     const QModelIndex& index) override;
+
+private:
+    QRect applyButtonRect(const QRect& rowRect) const;
+    QRect deleteButtonRect(const QRect& rowRect) const;
+};
+
+#endif // PRESETITEMDELEGATE_H
@@ -0,0 +1,51 @@
+#include "PresetListModel.h"
+
+PresetListModel::PresetListModel(int axis, PresetManager* manager, QObject *parent)
+    : QAbstractListModel(parent),
+      axisNumber_(axis),
+      presetManager_(manager),
+      presets_(manager->loadPresets(axis))
+{
+}
+
+int PresetListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : presets_.size();
+}
+
+QVariant PresetListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= presets_.size()) {
+        return {};
+    }
+
+    const AxisPreset& preset = presets_[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return QString("Motor: %1, Mode: %2, Value: %3, Speed: %4")
+            .arg(preset.motorName)
+            .arg(preset.isAbsolute ? "Abs" : "Rel")
+            .arg(preset.value)
+            .arg(preset.speed);
+    case SearchTextRole:
+        return QString("%1 %2 %3")
+            .arg(preset.motorName)
+            .arg(preset.isAbsolute ? "Abs" : "Rel")
+            .arg(preset.value);
+    default:
+        return {};
+    }
+}
+
+bool PresetListModel::removePresetAt(int row)
+{
+    if (row < 0 || row >= presets_.size()) {
+        return false;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    presetManager_->removePreset(presets_[row].id);
+    presets_.removeAt(row);
+    endRemoveRows();
+    return true;
+}
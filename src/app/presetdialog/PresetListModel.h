@@ -0,0 +1,33 @@
+#ifndef PRESETLISTMODEL_H
+#define PRESETLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QList>
+#include "PresetManager.h"
+
+// One axis' presets, newest first, straight from the in-memory preset index
+class PresetListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        SearchTextRole = Qt::UserRole + 1   // motor, mode and value, for filter-as-you-type
+    };
+
+    PresetListModel(int axis, PresetManager* manager, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    AxisPreset presetAt(int row) const { return presets_.value(row); }
+    // Removes a single row and journals the deletion; the rest of the view is untouched
+    bool removePresetAt(int row);
+
+private:
+    int axisNumber_;
+    PresetManager* presetManager_;
+    QList<AxisPreset> presets_;
+};
+
+#endif // PRESETLISTMODEL_H
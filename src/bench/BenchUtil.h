@@ -0,0 +1,91 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+#include "QtKohzuManager.h"
+#include <QEventLoop>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+#include <algorithm>
+
+// Small helpers shared by the benchmark executables.
+
+struct LatencySummary {
+    int count = 0;
+    double p50Us = 0.0;
+    double p90Us = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    double meanUs = 0.0;
+};
+
+inline LatencySummary summarizeLatencies(QVector<qint64> samplesNs)
+{
+    LatencySummary summary;
+    summary.count = samplesNs.size();
+    if (samplesNs.isEmpty()) return summary;
+
+    std::sort(samplesNs.begin(), samplesNs.end());
+    auto percentile = [&samplesNs](double p) {
+        const int index = std::clamp(static_cast<int>(p * (samplesNs.size() - 1) + 0.5), 0, int(samplesNs.size()) - 1);
+        return samplesNs[index] / 1000.0;
+    };
+    summary.p50Us = percentile(0.50);
+    summary.p90Us = percentile(0.90);
+    summary.p99Us = percentile(0.99);
+    summary.maxUs = samplesNs.last() / 1000.0;
+
+    double total = 0.0;
+    for (qint64 sample : std::as_const(samplesNs)) total += sample;
+    summary.meanUs = total / samplesNs.size() / 1000.0;
+    return summary;
+}
+
+inline QString formatLatency(const LatencySummary& s)
+{
+    return QString("n=%1 mean=%2us p50=%3us p90=%4us p99=%5us max=%6us")
+        .arg(s.count)
+        .arg(s.meanUs, 0, 'f', 1)
+        .arg(s.p50Us, 0, 'f', 1)
+        .arg(s.p90Us, 0, 'f', 1)
+        .arg(s.p99Us, 0, 'f', 1)
+        .arg(s.maxUs, 0, 'f', 1);
+}
+
+// Parses "1,4,8" into {1, 4, 8}, skipping anything that is not a positive number.
+inline QList<int> parseIntList(const QString& text)
+{
+    QList<int> values;
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        bool ok = false;
+        int value = part.trimmed().toInt(&ok);
+        if (ok && value > 0) values.append(value);
+    }
+    return values;
+}
+
+// connectToController is asynchronous; block (with a running event loop) until it settles.
+inline bool connectAndWait(QtKohzuManager& manager, const QString& host, quint16 port, int timeoutMs = 10000)
+{
+    QEventLoop loop;
+    bool connected = false;
+    QObject::connect(&manager, &QtKohzuManager::connectionStatusChanged, &loop, [&](bool status) {
+        connected = status;
+        loop.quit();
+    });
+    QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+    manager.connectToController(host, port);
+    loop.exec();
+    return connected;
+}
+
+inline QTextStream& benchOut()
+{
+    static QTextStream out(stdout);
+    return out;
+}
+
+#endif // BENCHUTIL_H
@@ -0,0 +1,120 @@
+// Compares the pipelined command channel against the serial (window = 1)
+// behaviour. A burst of commands spread over all axes is queued at once and
+// the run ends when every response is back.
+
+#include "BenchUtil.h"
+#include "KohzuSimulator.h"
+#include "QtKohzuManager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QQueue>
+#include <QTimer>
+
+namespace {
+
+struct BenchOptions {
+    QList<int> windows;
+    int axes = 32;
+    int commands = 5000;
+    bool motion = false;
+    int timeoutMs = 120000;
+};
+
+void runWindow(const BenchOptions& options, const SimulatorConfig& simConfig, int window)
+{
+    KohzuSimulator simulator(simConfig);
+    simulator.start();
+
+    QtKohzuManager manager;
+    PipelineConfig pipeline;
+    pipeline.maxInFlight = window;
+    pipeline.maxQueued = options.commands;
+    manager.setPipelineConfig(pipeline);
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    QVector<QQueue<qint64>> issuedAt(options.axes + 1);
+    QVector<qint64> latencies;
+    latencies.reserve(options.commands);
+    int completed = 0;
+    int failed = 0;
+
+    QObject::connect(&manager, &QtKohzuManager::commandCompleted, &loop,
+                     [&](int axisNo, bool, bool success) {
+        if (!issuedAt[axisNo].isEmpty()) {
+            latencies.append(clock.nsecsElapsed() - issuedAt[axisNo].dequeue());
+        }
+        if (!success) ++failed;
+        if (++completed >= options.commands) loop.quit();
+    });
+
+    if (!connectAndWait(manager, "127.0.0.1", simulator.port())) {
+        benchOut() << "could not connect to the simulator" << Qt::endl;
+        return;
+    }
+
+    clock.start();
+    for (int i = 0; i < options.commands; ++i) {
+        const int axisNo = 1 + i % options.axes;
+        issuedAt[axisNo].enqueue(clock.nsecsElapsed());
+        if (options.motion) {
+            manager.move(axisNo, (i / options.axes) % 2 == 0 ? 10 : -10, 9, false);
+        } else {
+            manager.setSystem(axisNo, 2, 8);
+        }
+    }
+    const qint64 queuedNs = clock.nsecsElapsed();
+
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    const double seconds = clock.nsecsElapsed() / 1e9;
+    manager.disconnectFromController();
+    simulator.stop();
+
+    benchOut() << QString("window=%1 %2 completed=%3/%4 failed=%5 elapsed=%6s throughput=%7 cmd/s enqueue=%8us")
+                      .arg(window, 2)
+                      .arg(window == 1 ? "(serial)  " : "(pipelined)")
+                      .arg(completed).arg(options.commands).arg(failed)
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(completed / seconds, 0, 'f', 1)
+                      .arg(queuedNs / 1000.0, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    enqueue-to-response: " << formatLatency(summarizeLatencies(latencies)) << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-pipeline-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Serial vs pipelined command channel benchmark against the local Kohzu simulator.");
+    parser.addHelpOption();
+    parser.addOption({"windows", "Comma separated in-flight windows; 1 is the serial baseline.", "list", "1,2,4,8,16,32"});
+    parser.addOption({"axes", "Number of axes the burst is spread over.", "n", "32"});
+    parser.addOption({"commands", "Commands per run.", "n", "5000"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds.", "us", "500"});
+    parser.addOption({"motion", "Send short relative moves instead of setSystem."});
+    parser.process(app);
+
+    BenchOptions options;
+    options.windows = parseIntList(parser.value("windows"));
+    options.axes = qBound(1, parser.value("axes").toInt(), 32);
+    options.commands = qMax(1, parser.value("commands").toInt());
+    options.motion = parser.isSet("motion");
+
+    SimulatorConfig simConfig;
+    simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+    simConfig.speedScale = 100.0;
+
+    for (int window : std::as_const(options.windows)) {
+        runWindow(options, simConfig, window);
+    }
+    return 0;
+}
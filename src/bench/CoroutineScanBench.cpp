@@ -0,0 +1,192 @@
+// Straight-line coroutine scan vs ScanEngine against the local simulator.
+//
+// Both run the same raster grid one move at a time on the io thread: the
+// ScanEngine through its completion-handler state machine, the coroutine
+// version as a plain nested loop over AwaitableMotion::move. Reports points
+// per second and the spacing between consecutive arrivals.
+
+#include "AwaitableMotion.h"
+#include "BenchUtil.h"
+#include "KohzuSimulator.h"
+#include "LatencyHistogram.h"
+#include "MotorCatalog.h"
+#include "QtKohzuManager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QPointer>
+#include <QTimer>
+#include <memory>
+
+namespace {
+
+struct BenchOptions {
+    int fastPoints = 20;
+    int slowPoints = 20;
+    int stepPulses = 100;
+    int speed = 9;
+    int timeoutMs = 300000;
+};
+
+constexpr int kStartPulse = 1000;
+
+struct RunResult {
+    int arrived = 0;
+    bool completed = false;
+    QVector<qint64> gaps;
+};
+
+boost::asio::awaitable<void> coroutineScan(AwaitableMotion motion, BenchOptions options, std::shared_ptr<RunResult> run)
+{
+    RunResult& result = *run;
+    qint64 lastArrivalNs = 0;
+    for (int slow = 0; slow < options.slowPoints; ++slow) {
+        if (options.slowPoints > 1) {
+            const CommandResult reply = co_await motion.move(2, kStartPulse + slow * options.stepPulses, options.speed, true);
+            if (reply.status != 'C') co_return;
+        }
+        for (int fast = 0; fast < options.fastPoints; ++fast) {
+            const CommandResult reply = co_await motion.move(1, kStartPulse + fast * options.stepPulses, options.speed, true);
+            if (reply.status != 'C') co_return;
+            const qint64 nowNs = monotonicNs();
+            if (result.arrived > 0) result.gaps.append(nowNs - lastArrivalNs);
+            lastArrivalNs = nowNs;
+            ++result.arrived;
+        }
+    }
+    result.completed = true;
+}
+
+RunResult runEngine(QtKohzuManager& manager, const BenchOptions& options, QEventLoop& loop)
+{
+    ScanDefinition definition;
+    definition.catalog = MotorCatalog::builtIn();
+    definition.fast.axisNo = 1;
+    definition.fast.motorIndex = MotorCatalog::kDefaultIndex;
+    definition.fast.start = kStartPulse;
+    definition.fast.stop = kStartPulse + options.stepPulses * (options.fastPoints - 1);
+    definition.fast.points = options.fastPoints;
+    definition.fast.speed = options.speed;
+    if (options.slowPoints > 1) {
+        ScanAxis slow = definition.fast;
+        slow.axisNo = 2;
+        slow.stop = kStartPulse + options.stepPulses * (options.slowPoints - 1);
+        slow.points = options.slowPoints;
+        definition.slow = slow;
+    }
+    definition.pattern = ScanPattern::Raster;
+    definition.lookahead = false;
+
+    RunResult result;
+    qint64 lastArrivalNs = 0;
+    auto arrival = QObject::connect(&manager, &QtKohzuManager::scanPointArrived, &loop, [&](const ScanArrival& point) {
+        if (result.arrived > 0) result.gaps.append(point.timestampNs - lastArrivalNs);
+        lastArrivalNs = point.timestampNs;
+        ++result.arrived;
+    });
+    auto finished = QObject::connect(&manager, &QtKohzuManager::scanFinished, &loop, [&](bool ok, const QString&) {
+        result.completed = ok;
+        loop.quit();
+    });
+    manager.startScan(definition);
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    QObject::disconnect(arrival);
+    QObject::disconnect(finished);
+    return result;
+}
+
+RunResult runCoroutine(QtKohzuManager& manager, const BenchOptions& options, QEventLoop& loop)
+{
+    // Shared with the io thread, which may still be running the scan after a timeout
+    auto result = std::make_shared<RunResult>();
+    AwaitableMotion motion(manager.motionChannel());
+    QPointer<QEventLoop> waiting(&loop);
+    boost::asio::co_spawn(motion.ioContext(), coroutineScan(motion, options, result),
+        [waiting](std::exception_ptr) {
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [waiting]() {
+                if (waiting) waiting->quit();
+            }, Qt::QueuedConnection);
+        });
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return *result;
+}
+
+void runBench(const BenchOptions& options, const SimulatorConfig& simConfig, bool coroutine)
+{
+    KohzuSimulator simulator(simConfig);
+    simulator.start();
+
+    QtKohzuManager manager;
+    if (!connectAndWait(manager, "127.0.0.1", simulator.port())) {
+        benchOut() << "could not connect to the simulator" << Qt::endl;
+        return;
+    }
+
+    // Move to the start point first so every run measures only the grid itself
+    QEventLoop loop;
+    int homed = 0;
+    auto homing = QObject::connect(&manager, &QtKohzuManager::commandCompleted, &loop, [&](int, bool, bool) {
+        if (++homed == (options.slowPoints > 1 ? 2 : 1)) loop.quit();
+    });
+    manager.move(1, kStartPulse, options.speed, true);
+    if (options.slowPoints > 1) manager.move(2, kStartPulse, options.speed, true);
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    QObject::disconnect(homing);
+
+    QElapsedTimer clock;
+    clock.start();
+    const RunResult result = coroutine ? runCoroutine(manager, options, loop) : runEngine(manager, options, loop);
+    const double seconds = clock.nsecsElapsed() / 1e9;
+
+    manager.disconnectFromController();
+    simulator.stop();
+
+    const int total = options.fastPoints * options.slowPoints;
+    benchOut() << QString("%1 points=%2/%3 %4 elapsed=%5s rate=%6 points/s")
+                      .arg(coroutine ? "coroutine " : "ScanEngine")
+                      .arg(result.arrived).arg(total)
+                      .arg(result.completed ? "completed" : "stopped")
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(seconds > 0 ? result.arrived / seconds : 0.0, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    arrival spacing: " << formatLatency(summarizeLatencies(result.gaps)) << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-coro-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Coroutine scan vs ScanEngine against the local Kohzu simulator.");
+    parser.addHelpOption();
+    parser.addOption({"fast-points", "Points along the fast axis.", "n", "20"});
+    parser.addOption({"slow-points", "Points along the slow axis (1 = 1D scan).", "n", "20"});
+    parser.addOption({"step", "Step size in pulses.", "pulses", "100"});
+    parser.addOption({"speed-table", "Speed table used for every move (0-9).", "n", "9"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds.", "us", "200"});
+    parser.addOption({"speed-scale", "Simulated motion speed multiplier.", "x", "1"});
+    parser.process(app);
+
+    BenchOptions options;
+    options.fastPoints = qMax(2, parser.value("fast-points").toInt());
+    options.slowPoints = qMax(1, parser.value("slow-points").toInt());
+    options.stepPulses = qMax(1, parser.value("step").toInt());
+    options.speed = qBound(0, parser.value("speed-table").toInt(), 9);
+
+    SimulatorConfig simConfig;
+    simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+    simConfig.speedScale = qMax(0.001, parser.value("speed-scale").toDouble());
+
+    for (bool coroutine : {false, true}) {
+        runBench(options, simConfig, coroutine);
+    }
+    return 0;
+}
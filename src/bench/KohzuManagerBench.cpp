@@ -0,0 +1,161 @@
+// End-to-end benchmark for QtKohzuManager against the loopback KohzuSimulator.
+//
+// For every requested axis count it drives move / moveOrigin / setSystem until
+// the command budget is spent, keeping one command in flight per axis, and
+// reports command round-trip percentiles and the position update rate.
+
+#include "BenchUtil.h"
+#include "KohzuSimulator.h"
+#include "QtKohzuManager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace {
+
+enum class Scenario { Move, Origin, System };
+
+QString scenarioName(Scenario scenario)
+{
+    switch (scenario) {
+    case Scenario::Move: return "move";
+    case Scenario::Origin: return "moveOrigin";
+    case Scenario::System: return "setSystem";
+    }
+    return {};
+}
+
+struct BenchOptions {
+    QList<int> axisCounts;
+    int commands = 2000;
+    int speedTable = 9;
+    int travelPulse = 1000;
+    int timeoutMs = 120000;
+};
+
+void runScenario(const BenchOptions& options, const SimulatorConfig& simConfig, int axisCount, Scenario scenario)
+{
+    KohzuSimulator simulator(simConfig);
+    simulator.start();
+
+    QtKohzuManager manager;
+    QEventLoop loop;
+    QElapsedTimer clock;
+
+    QVector<qint64> issuedAt(axisCount + 1, 0);
+    QVector<int> nextTarget(axisCount + 1, 0);
+    QVector<qint64> latencies;
+    latencies.reserve(options.commands);
+    int issued = 0;
+    int completed = 0;
+    int failed = 0;
+    int positionBatches = 0;
+    int positionUpdates = 0;
+
+    auto issue = [&](int axisNo) {
+        if (issued >= options.commands) return;
+        ++issued;
+        issuedAt[axisNo] = clock.nsecsElapsed();
+        switch (scenario) {
+        case Scenario::Move:
+            nextTarget[axisNo] = nextTarget[axisNo] == 0 ? options.travelPulse : 0;
+            manager.move(axisNo, nextTarget[axisNo], options.speedTable, true);
+            break;
+        case Scenario::Origin:
+            manager.moveOrigin(axisNo, options.speedTable);
+            break;
+        case Scenario::System:
+            manager.setSystem(axisNo, 2, 8);
+            break;
+        }
+    };
+
+    QObject::connect(&manager, &QtKohzuManager::commandCompleted, &loop,
+                     [&](int axisNo, bool, bool success) {
+        latencies.append(clock.nsecsElapsed() - issuedAt[axisNo]);
+        ++completed;
+        if (!success) ++failed;
+        if (completed >= options.commands) {
+            loop.quit();
+            return;
+        }
+        issue(axisNo);
+    });
+    QObject::connect(&manager, &QtKohzuManager::positionsUpdated, &loop,
+                     [&](const QVector<AxisSample>& samples) {
+        ++positionBatches;
+        positionUpdates += samples.size();
+    });
+
+    if (!connectAndWait(manager, "127.0.0.1", simulator.port())) {
+        benchOut() << "could not connect to the simulator" << Qt::endl;
+        return;
+    }
+    for (int axisNo = 1; axisNo <= axisCount; ++axisNo) {
+        manager.addAxisToPoll(axisNo);
+    }
+
+    clock.start();
+    for (int axisNo = 1; axisNo <= axisCount; ++axisNo) {
+        issue(axisNo);
+    }
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    const double seconds = clock.nsecsElapsed() / 1e9;
+    manager.disconnectFromController();
+    simulator.stop();
+
+    benchOut() << QString("%1 axes=%2 completed=%3/%4 failed=%5 elapsed=%6s throughput=%7 cmd/s")
+                      .arg(scenarioName(scenario), -10)
+                      .arg(axisCount, 2)
+                      .arg(completed).arg(options.commands).arg(failed)
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(completed / seconds, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    round-trip: " << formatLatency(summarizeLatencies(latencies)) << Qt::endl;
+    benchOut() << QString("    positionsUpdated: %1 batches (%2/s), %3 axis samples (%4/s)")
+                      .arg(positionBatches)
+                      .arg(positionBatches / seconds, 0, 'f', 1)
+                      .arg(positionUpdates)
+                      .arg(positionUpdates / seconds, 0, 'f', 1)
+               << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-manager-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("QtKohzuManager round-trip benchmark against the local Kohzu simulator.");
+    parser.addHelpOption();
+    parser.addOption({"axes", "Comma separated axis counts to run.", "list", "1,4,8,16,32"});
+    parser.addOption({"commands", "Commands per scenario.", "n", "2000"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds.", "us", "200"});
+    parser.addOption({"speed-scale", "Simulated motion speed multiplier.", "x", "100"});
+    parser.addOption({"speed-table", "Speed table used for moves.", "n", "9"});
+    parser.process(app);
+
+    BenchOptions options;
+    options.axisCounts = parseIntList(parser.value("axes"));
+    options.commands = qMax(1, parser.value("commands").toInt());
+    options.speedTable = parser.value("speed-table").toInt();
+
+    SimulatorConfig simConfig;
+    simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+    simConfig.speedScale = parser.value("speed-scale").toDouble();
+
+    for (int axisCount : std::as_const(options.axisCounts)) {
+        simConfig.axisCount = qMax(axisCount, 32);
+        for (Scenario scenario : {Scenario::Move, Scenario::Origin, Scenario::System}) {
+            runScenario(options, simConfig, axisCount, scenario);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,260 @@
+// Several controllers at once against local simulators.
+//
+// Runs N simulated controllers with every axis polled and one move in flight
+// per (controller, axis), once through MultiControllerManager (shared io
+// thread pool) and once with one QtKohzuManager, and so one io thread, per
+// controller. Reports command round trips, throughput and the rate of the
+// merged position stream.
+
+#include "BenchUtil.h"
+#include "KohzuSimulator.h"
+#include "MultiControllerManager.h"
+#include "QtKohzuManager.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+struct BenchOptions {
+    QList<int> controllerCounts;
+    int axes = 32;
+    int commandsPerController = 2000;
+    int ioThreads = 0;
+    int speedTable = 9;
+    int travelPulse = 1000;
+    int timeoutMs = 120000;
+};
+
+// The parts of the two setups the measurement loop needs
+struct Fleet {
+    std::function<void(int controller, int axisNo, int pulse)> move;
+    int ioThreads = 0;
+};
+
+struct Counters {
+    QVector<QVector<qint64>> issuedAt;     // [controller][axis]
+    QVector<QVector<int>> nextTarget;
+    QVector<qint64> latencies;
+    int issued = 0;
+    int completed = 0;
+    int failed = 0;
+    int positionBatches = 0;
+    int positionSamples = 0;
+};
+
+void report(const char* mode, int controllers, const BenchOptions& options, const Counters& counters,
+            double seconds, int ioThreads)
+{
+    const int total = options.commandsPerController * controllers;
+    benchOut() << QString("%1 controllers=%2 axes=%3 io-threads=%4 completed=%5/%6 failed=%7 elapsed=%8s throughput=%9 cmd/s")
+                      .arg(mode, -7)
+                      .arg(controllers, 2)
+                      .arg(options.axes)
+                      .arg(ioThreads)
+                      .arg(counters.completed).arg(total).arg(counters.failed)
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(counters.completed / seconds, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    round-trip: " << formatLatency(summarizeLatencies(counters.latencies)) << Qt::endl;
+    benchOut() << QString("    positionsUpdated: %1 batches (%2/s), %3 axis samples (%4/s)")
+                      .arg(counters.positionBatches)
+                      .arg(counters.positionBatches / seconds, 0, 'f', 1)
+                      .arg(counters.positionSamples)
+                      .arg(counters.positionSamples / seconds, 0, 'f', 1)
+               << Qt::endl;
+}
+
+// Issues the first move on every axis and spins the loop until the budget is spent
+double drive(QEventLoop& loop, QElapsedTimer& clock, const Fleet& fleet, Counters& counters,
+             const BenchOptions& options, int controllers, std::function<void(int, int)>& issue)
+{
+    const int total = options.commandsPerController * controllers;
+    issue = [&, total](int controller, int axisNo) {
+        if (counters.issued >= total) return;
+        ++counters.issued;
+        int& target = counters.nextTarget[controller][axisNo];
+        target = target == 0 ? options.travelPulse : 0;
+        counters.issuedAt[controller][axisNo] = clock.nsecsElapsed();
+        fleet.move(controller, axisNo, target);
+    };
+
+    clock.start();
+    for (int controller = 0; controller < controllers; ++controller) {
+        for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+            issue(controller, axisNo);
+        }
+    }
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    return clock.nsecsElapsed() / 1e9;
+}
+
+void onCompleted(QEventLoop& loop, QElapsedTimer& clock, Counters& counters, int total,
+                 const std::function<void(int, int)>& issue, int controller, int axisNo, bool success)
+{
+    counters.latencies.append(clock.nsecsElapsed() - counters.issuedAt[controller][axisNo]);
+    ++counters.completed;
+    if (!success) ++counters.failed;
+    if (counters.completed >= total) {
+        loop.quit();
+        return;
+    }
+    issue(controller, axisNo);
+}
+
+Counters makeCounters(int controllers, const BenchOptions& options)
+{
+    Counters counters;
+    counters.issuedAt = QVector<QVector<qint64>>(controllers, QVector<qint64>(options.axes + 1, 0));
+    counters.nextTarget = QVector<QVector<int>>(controllers, QVector<int>(options.axes + 1, 0));
+    counters.latencies.reserve(options.commandsPerController * controllers);
+    return counters;
+}
+
+void runPooled(const BenchOptions& options, const std::vector<std::unique_ptr<KohzuSimulator>>& simulators)
+{
+    const int controllers = static_cast<int>(simulators.size());
+    const int total = options.commandsPerController * controllers;
+    MultiControllerManager manager(options.ioThreads);
+    for (const auto& simulator : simulators) {
+        manager.addController("127.0.0.1", simulator->port());
+    }
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    Counters counters = makeCounters(controllers, options);
+    std::function<void(int, int)> issue;
+
+    int connected = 0;
+    auto connecting = QObject::connect(&manager, &MultiControllerManager::connectionStateChanged, &loop,
+                                       [&](int, QtKohzuManager::ConnectionState state) {
+        if (state == QtKohzuManager::ConnectionState::Connected && ++connected == controllers) loop.quit();
+    });
+    manager.connectAll();
+    QTimer::singleShot(10000, &loop, &QEventLoop::quit);
+    loop.exec();
+    QObject::disconnect(connecting);
+    if (connected != controllers) {
+        benchOut() << QString("pooled: only %1 of %2 controllers connected").arg(connected).arg(controllers) << Qt::endl;
+        return;
+    }
+
+    QObject::connect(&manager, &MultiControllerManager::commandCompleted, &loop,
+                     [&](int controller, int axisNo, bool, bool success) {
+        onCompleted(loop, clock, counters, total, issue, controller, axisNo, success);
+    });
+    QObject::connect(&manager, &MultiControllerManager::positionsUpdated, &loop,
+                     [&](const QVector<ControllerAxisSample>& samples) {
+        ++counters.positionBatches;
+        counters.positionSamples += samples.size();
+    });
+    for (int controller = 0; controller < controllers; ++controller) {
+        for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+            manager.addAxisToPoll(controller, axisNo);
+        }
+    }
+
+    Fleet fleet;
+    fleet.ioThreads = manager.ioThreadCount();
+    fleet.move = [&manager, &options](int controller, int axisNo, int pulse) {
+        manager.move(controller, axisNo, pulse, options.speedTable, true);
+    };
+    const double seconds = drive(loop, clock, fleet, counters, options, controllers, issue);
+    manager.disconnectAll();
+    report("pooled", controllers, options, counters, seconds, fleet.ioThreads);
+}
+
+void runPrivate(const BenchOptions& options, const std::vector<std::unique_ptr<KohzuSimulator>>& simulators)
+{
+    const int controllers = static_cast<int>(simulators.size());
+    const int total = options.commandsPerController * controllers;
+    std::vector<std::unique_ptr<QtKohzuManager>> managers;
+    for (const auto& simulator : simulators) {
+        managers.push_back(std::make_unique<QtKohzuManager>());
+        if (!connectAndWait(*managers.back(), "127.0.0.1", simulator->port())) {
+            benchOut() << "private: could not connect to a simulator" << Qt::endl;
+            return;
+        }
+    }
+
+    QEventLoop loop;
+    QElapsedTimer clock;
+    Counters counters = makeCounters(controllers, options);
+    std::function<void(int, int)> issue;
+
+    for (int controller = 0; controller < controllers; ++controller) {
+        QtKohzuManager* manager = managers[controller].get();
+        QObject::connect(manager, &QtKohzuManager::commandCompleted, &loop,
+                         [&, controller](int axisNo, bool, bool success) {
+            onCompleted(loop, clock, counters, total, issue, controller, axisNo, success);
+        });
+        QObject::connect(manager, &QtKohzuManager::positionsUpdated, &loop, [&](const QVector<AxisSample>& samples) {
+            ++counters.positionBatches;
+            counters.positionSamples += samples.size();
+        });
+        for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+            manager->addAxisToPoll(axisNo);
+        }
+    }
+
+    Fleet fleet;
+    fleet.ioThreads = controllers;
+    fleet.move = [&managers, &options](int controller, int axisNo, int pulse) {
+        managers[controller]->move(axisNo, pulse, options.speedTable, true);
+    };
+    const double seconds = drive(loop, clock, fleet, counters, options, controllers, issue);
+    for (auto& manager : managers) {
+        manager->disconnectFromController();
+    }
+    report("private", controllers, options, counters, seconds, fleet.ioThreads);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-multi-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Several controllers on a shared io thread pool vs one io thread each.");
+    parser.addHelpOption();
+    parser.addOption({"controllers", "Comma separated controller counts to run.", "list", "1,2,4,8"});
+    parser.addOption({"axes", "Polled and driven axes per controller.", "n", "32"});
+    parser.addOption({"commands", "Moves per controller.", "n", "2000"});
+    parser.addOption({"io-threads", "Threads of the shared pool (0 = default).", "n", "0"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds.", "us", "200"});
+    parser.addOption({"speed-scale", "Simulated motion speed multiplier.", "x", "100"});
+    parser.process(app);
+
+    BenchOptions options;
+    options.controllerCounts = parseIntList(parser.value("controllers"));
+    options.axes = qBound(1, parser.value("axes").toInt(), 32);
+    options.commandsPerController = qMax(1, parser.value("commands").toInt());
+    options.ioThreads = qMax(0, parser.value("io-threads").toInt());
+
+    SimulatorConfig simConfig;
+    simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+    simConfig.speedScale = parser.value("speed-scale").toDouble();
+
+    for (int controllers : std::as_const(options.controllerCounts)) {
+        std::vector<std::unique_ptr<KohzuSimulator>> simulators;
+        for (int i = 0; i < controllers; ++i) {
+            simulators.push_back(std::make_unique<KohzuSimulator>(simConfig));
+            simulators.back()->start();
+        }
+        runPooled(options, simulators);
+        runPrivate(options, simulators);
+        for (auto& simulator : simulators) {
+            simulator->stop();
+        }
+    }
+    return 0;
+}
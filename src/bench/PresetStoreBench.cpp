@@ -0,0 +1,212 @@
+// Load and insert cost of the journaled preset store at a large preset count,
+// next to the per-axis JSON files it replaced.
+//
+// The legacy numbers reproduce the old PresetManager behaviour: every insert
+// re-reads, re-parses and rewrites the whole axis file.
+
+#include "BenchUtil.h"
+#include "PresetStore.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+namespace {
+
+AxisPreset makePreset(int index)
+{
+    AxisPreset preset;
+    preset.id = QUuid::createUuid();
+    preset.motorName = QString("Motor-%1").arg(index % 24);
+    preset.isAbsolute = index % 2 == 0;
+    preset.value = index * 0.125;
+    preset.speed = index % 10;
+    return preset;
+}
+
+QJsonObject toJson(const AxisPreset& preset)
+{
+    QJsonObject obj;
+    obj["id"] = preset.id.toString();
+    obj["motorName"] = preset.motorName;
+    obj["isAbsolute"] = preset.isAbsolute;
+    obj["value"] = preset.value;
+    obj["speed"] = preset.speed;
+    return obj;
+}
+
+QList<AxisPreset> parseLegacyFile(const QString& path)
+{
+    QList<AxisPreset> presets;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return presets;
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue& value : array) {
+        QJsonObject obj = value.toObject();
+        AxisPreset preset;
+        preset.id = QUuid(obj["id"].toString());
+        preset.motorName = obj["motorName"].toString();
+        preset.isAbsolute = obj["isAbsolute"].toBool();
+        preset.value = obj["value"].toDouble();
+        preset.speed = obj["speed"].toInt();
+        presets.append(preset);
+    }
+    return presets;
+}
+
+void writeLegacyFile(const QString& path, const QList<AxisPreset>& presets)
+{
+    QJsonArray array;
+    for (const AxisPreset& preset : presets) {
+        array.append(toJson(preset));
+    }
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(array).toJson());
+    }
+}
+
+double elapsedMs(const QElapsedTimer& timer)
+{
+    return timer.nsecsElapsed() / 1e6;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-preset-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Journaled preset store vs per-axis JSON files.");
+    parser.addHelpOption();
+    parser.addOption({"presets", "Total number of presets.", "n", "100000"});
+    parser.addOption({"axes", "Number of axes the presets are spread over.", "n", "32"});
+    parser.addOption({"legacy-inserts", "Inserts timed against the full legacy files.", "n", "50"});
+    parser.process(app);
+
+    const int total = qMax(1, parser.value("presets").toInt());
+    const int axes = qBound(1, parser.value("axes").toInt(), 32);
+    const int legacyInserts = qMax(0, parser.value("legacy-inserts").toInt());
+
+    QTemporaryDir dir;
+    if (!dir.isValid()) {
+        benchOut() << "could not create a temporary directory" << Qt::endl;
+        return 1;
+    }
+
+    QVector<AxisPreset> presets;
+    presets.reserve(total);
+    for (int i = 0; i < total; ++i) {
+        presets.append(makePreset(i));
+    }
+
+    // Journal: bulk insert, one append, then a cold load of the file
+    const QString journalPath = dir.filePath("presets.journal");
+    PresetStore store;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < total; ++i) {
+        store.put(1 + i % axes, presets[i]);
+    }
+    const double insertMs = elapsedMs(timer);
+
+    timer.restart();
+    {
+        QFile file(journalPath);
+        file.open(QIODevice::WriteOnly);
+        file.write(PresetStore::journalHeader());
+        file.write(store.takePendingRecords());
+    }
+    const double appendMs = elapsedMs(timer);
+
+    // Steady-state insert: index update plus a single-record append
+    QVector<qint64> journalInsertNs;
+    journalInsertNs.reserve(qMax(legacyInserts, 1000));
+    for (int i = 0; i < qMax(legacyInserts, 1000); ++i) {
+        const AxisPreset preset = makePreset(total + i);
+        timer.restart();
+        store.put(1 + i % axes, preset);
+        QFile file(journalPath);
+        file.open(QIODevice::WriteOnly | QIODevice::Append);
+        file.write(store.takePendingRecords());
+        file.close();
+        journalInsertNs.append(timer.nsecsElapsed());
+    }
+
+    PresetStore reloaded;
+    timer.restart();
+    reloaded.load(journalPath);
+    const double loadMs = elapsedMs(timer);
+
+    // Tombstone half the presets, then compact
+    for (int i = 0; i < total; i += 2) {
+        reloaded.remove(presets[i].id);
+    }
+    {
+        QFile file(journalPath);
+        file.open(QIODevice::WriteOnly | QIODevice::Append);
+        file.write(reloaded.takePendingRecords());
+    }
+    const qint64 journalBytesBefore = QFileInfo(journalPath).size();
+    timer.restart();
+    const QByteArray image = reloaded.compactedImage();
+    {
+        QFile file(journalPath);
+        file.open(QIODevice::WriteOnly);
+        file.write(image);
+    }
+    const double compactMs = elapsedMs(timer);
+
+    benchOut() << QString("journal: presets=%1 axes=%2 live=%3 file=%4 KiB")
+                      .arg(total).arg(axes).arg(reloaded.liveCount()).arg(journalBytesBefore / 1024)
+               << Qt::endl;
+    benchOut() << QString("    bulk insert %1 ms, append %2 ms, cold load %3 ms, compact to %4 KiB %5 ms")
+                      .arg(insertMs, 0, 'f', 1).arg(appendMs, 0, 'f', 1).arg(loadMs, 0, 'f', 1)
+                      .arg(image.size() / 1024).arg(compactMs, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    insert+append: " << formatLatency(summarizeLatencies(journalInsertNs)) << Qt::endl;
+
+    // Legacy: one JSON file per axis holding the same presets
+    QVector<QList<AxisPreset>> perAxis(axes + 1);
+    for (int i = 0; i < total; ++i) {
+        perAxis[1 + i % axes].append(presets[i]);
+    }
+    qint64 legacyBytes = 0;
+    for (int axis = 1; axis <= axes; ++axis) {
+        const QString path = dir.filePath(QString("axis_%1.json").arg(axis));
+        writeLegacyFile(path, perAxis[axis]);
+        legacyBytes += QFileInfo(path).size();
+    }
+
+    timer.restart();
+    int legacyLoaded = 0;
+    for (int axis = 1; axis <= axes; ++axis) {
+        legacyLoaded += parseLegacyFile(dir.filePath(QString("axis_%1.json").arg(axis))).size();
+    }
+    const double legacyLoadMs = elapsedMs(timer);
+
+    QVector<qint64> legacyInsertNs;
+    legacyInsertNs.reserve(legacyInserts);
+    for (int i = 0; i < legacyInserts; ++i) {
+        const int axis = 1 + i % axes;
+        const QString path = dir.filePath(QString("axis_%1.json").arg(axis));
+        timer.restart();
+        QList<AxisPreset> list = parseLegacyFile(path);
+        list.prepend(makePreset(total + i));
+        writeLegacyFile(path, list);
+        legacyInsertNs.append(timer.nsecsElapsed());
+    }
+
+    benchOut() << QString("legacy json: presets=%1 files=%2 KiB").arg(legacyLoaded).arg(legacyBytes / 1024) << Qt::endl;
+    benchOut() << QString("    cold load %1 ms").arg(legacyLoadMs, 0, 'f', 1) << Qt::endl;
+    benchOut() << "    read-modify-write insert: " << formatLatency(summarizeLatencies(legacyInsertNs)) << Qt::endl;
+    return 0;
+}
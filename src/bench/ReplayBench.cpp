@@ -0,0 +1,186 @@
+// Replays recorded controller traffic into QtKohzuManager.
+//
+// Without --capture, first records a capture against the local simulator
+// (polled axes plus a stream of moves, through QtKohzuManager's recording
+// relay). The capture is then played back through a loopback socket at each
+// requested speed, so the TcpClient -> ProtocolHandler -> KohzuController ->
+// QtKohzuManager path handles exactly the recorded bytes. Reports frame and
+// byte rates and how many position samples reached the GUI side.
+
+#include "BenchUtil.h"
+#include "CaptureReplayer.h"
+#include "KohzuSimulator.h"
+#include "QtKohzuManager.h"
+#include "WireCapture.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace {
+
+struct BenchOptions {
+    QString capturePath;
+    int axes = 8;
+    int moves = 400;
+    int speedTable = 9;
+    int travelPulse = 2000;
+    QList<double> speeds;
+};
+
+bool record(const BenchOptions& options, const SimulatorConfig& simConfig)
+{
+    KohzuSimulator simulator(simConfig);
+    simulator.start();
+
+    QtKohzuManager manager;
+    if (!manager.setCaptureFile(options.capturePath)) {
+        benchOut() << "cannot create " << options.capturePath << Qt::endl;
+        return false;
+    }
+    if (!connectAndWait(manager, "127.0.0.1", simulator.port())) {
+        benchOut() << "record: could not connect to the simulator" << Qt::endl;
+        return false;
+    }
+    for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+        manager.addAxisToPoll(axisNo);
+    }
+
+    // One move in flight per axis, alternating between 0 and travelPulse
+    QEventLoop loop;
+    QVector<int> target(options.axes + 1, 0);
+    int issued = 0;
+    int completed = 0;
+    auto issue = [&](int axisNo) {
+        if (issued >= options.moves) return;
+        ++issued;
+        target[axisNo] = target[axisNo] == 0 ? options.travelPulse : 0;
+        manager.move(axisNo, target[axisNo], options.speedTable, true);
+    };
+    QObject::connect(&manager, &QtKohzuManager::commandCompleted, &loop, [&](int axisNo, bool, bool) {
+        if (++completed >= options.moves) {
+            loop.quit();
+            return;
+        }
+        issue(axisNo);
+    });
+    for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+        issue(axisNo);
+    }
+    QTimer::singleShot(120000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    manager.disconnectFromController();
+    manager.setCaptureFile(QString());
+    simulator.stop();
+    benchOut() << QString("recorded %1 moves on %2 axes to %3").arg(completed).arg(options.axes).arg(options.capturePath)
+               << Qt::endl;
+    return true;
+}
+
+void replay(const BenchOptions& options, const std::vector<CaptureFrame>& frames, double speed)
+{
+    CaptureReplayer replayer(frames, speed);
+    std::string error;
+    if (!replayer.start(error)) {
+        benchOut() << QString::fromStdString(error) << Qt::endl;
+        return;
+    }
+
+    QtKohzuManager manager;
+    // Nothing in a replay answers the manager's own queries
+    manager.setLinkLossTimeouts(1000000);
+    int batches = 0;
+    int samples = 0;
+    qint64 lastSampleNs = 0;
+    QElapsedTimer clock;
+    clock.start();
+    QObject::connect(&manager, &QtKohzuManager::positionsUpdated, &manager, [&](const QVector<AxisSample>& batch) {
+        ++batches;
+        samples += batch.size();
+        lastSampleNs = clock.nsecsElapsed();
+    });
+    if (!connectAndWait(manager, "127.0.0.1", replayer.port())) {
+        benchOut() << "replay: could not connect to the replayer" << Qt::endl;
+        return;
+    }
+    for (int axisNo = 1; axisNo <= options.axes; ++axisNo) {
+        manager.addAxisToPoll(axisNo);
+    }
+
+    // Wait for the last frame, then for the position stream to go quiet
+    QEventLoop loop;
+    QTimer poll;
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (replayer.stats().finished && clock.nsecsElapsed() - lastSampleNs > 200000000) loop.quit();
+    });
+    poll.start(10);
+    QTimer::singleShot(600000, &loop, &QEventLoop::quit);
+    loop.exec();
+    manager.disconnectFromController();
+
+    const ReplayStats stats = replayer.stats();
+    const double seconds = std::max(stats.elapsedNs / 1e9, 1e-9);
+    benchOut() << QString("speed=%1 frames=%2 bytes=%3 elapsed=%4s rate=%5 frames/s %6 MB/s")
+                      .arg(speed > 0.0 ? QString("%1x").arg(speed) : QString("max"), -5)
+                      .arg(stats.framesSent).arg(stats.bytesSent)
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(stats.framesSent / seconds, 0, 'f', 0)
+                      .arg(stats.bytesSent / seconds / 1e6, 0, 'f', 2)
+               << Qt::endl;
+    benchOut() << QString("    positionsUpdated: %1 batches, %2 axis samples").arg(batches).arg(samples) << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-replay-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays recorded controller traffic through QtKohzuManager.");
+    parser.addHelpOption();
+    parser.addOption({"capture", "Capture file to replay; recorded from the simulator if not given.", "path"});
+    parser.addOption({"axes", "Axes polled while recording and replaying.", "n", "8"});
+    parser.addOption({"moves", "Moves driven while recording.", "n", "400"});
+    parser.addOption({"speeds", "Comma separated replay speeds (0 = as fast as possible).", "list", "1,10,0"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds while recording.", "us", "200"});
+    parser.addOption({"speed-scale", "Simulated motion speed multiplier while recording.", "x", "20"});
+    parser.process(app);
+
+    BenchOptions options;
+    options.axes = qBound(1, parser.value("axes").toInt(), 32);
+    options.moves = qMax(1, parser.value("moves").toInt());
+    for (const QString& part : parser.value("speeds").split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const double speed = part.trimmed().toDouble(&ok);
+        if (ok && speed >= 0.0) options.speeds.append(speed);
+    }
+
+    if (parser.isSet("capture")) {
+        options.capturePath = parser.value("capture");
+    } else {
+        options.capturePath = QDir::temp().filePath("kohzu-replay-bench.kzcap");
+        SimulatorConfig simConfig;
+        simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+        simConfig.speedScale = parser.value("speed-scale").toDouble();
+        if (!record(options, simConfig)) return 1;
+    }
+
+    std::vector<CaptureFrame> frames;
+    std::string error;
+    if (!loadCapture(options.capturePath.toStdString(), frames, error)) {
+        benchOut() << QString::fromStdString(error) << Qt::endl;
+        return 1;
+    }
+    benchOut() << QString("capture: %1 frames").arg(frames.size()) << Qt::endl;
+
+    for (double speed : std::as_const(options.speeds)) {
+        replay(options, frames, speed);
+    }
+    return 0;
+}
@@ -0,0 +1,150 @@
+// Step-scan throughput against the local simulator.
+//
+// Runs the same grid with raster and snake ordering, with and without
+// look-ahead queueing of the next move, and reports points per second and
+// the spacing between consecutive "arrived" events.
+
+#include "BenchUtil.h"
+#include "KohzuSimulator.h"
+#include "QtKohzuManager.h"
+#include "MotorCatalog.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+
+namespace {
+
+struct BenchOptions {
+    int fastPoints = 20;
+    int slowPoints = 20;
+    double stepPulses = 100.0;
+    int speed = 9;
+    int dwellMs = 0;
+    int timeoutMs = 300000;
+};
+
+void runScan(const BenchOptions& options, const SimulatorConfig& simConfig, ScanPattern pattern, bool lookahead)
+{
+    KohzuSimulator simulator(simConfig);
+    simulator.start();
+
+    QtKohzuManager manager;
+    if (!connectAndWait(manager, "127.0.0.1", simulator.port())) {
+        benchOut() << "could not connect to the simulator" << Qt::endl;
+        return;
+    }
+
+    // "Default" motor: 1 unit per pulse, so positions are plain pulse counts
+    ScanDefinition definition;
+    definition.catalog = MotorCatalog::builtIn();
+    definition.fast.axisNo = 1;
+    definition.fast.motorIndex = MotorCatalog::kDefaultIndex;
+    definition.fast.start = 1000.0;
+    definition.fast.stop = 1000.0 + options.stepPulses * (options.fastPoints - 1);
+    definition.fast.points = options.fastPoints;
+    definition.fast.speed = options.speed;
+    if (options.slowPoints > 1) {
+        ScanAxis slow = definition.fast;
+        slow.axisNo = 2;
+        slow.stop = 1000.0 + options.stepPulses * (options.slowPoints - 1);
+        slow.points = options.slowPoints;
+        definition.slow = slow;
+    }
+    definition.pattern = pattern;
+    definition.dwell = std::chrono::milliseconds(options.dwellMs);
+    definition.lookahead = lookahead;
+
+    // Move to the start point first so every run measures only the grid itself
+    QEventLoop loop;
+    int homed = 0;
+    auto homing = QObject::connect(&manager, &QtKohzuManager::commandCompleted, &loop, [&](int, bool, bool) {
+        if (++homed == (definition.slow ? 2 : 1)) loop.quit();
+    });
+    manager.move(1, int(definition.fast.start), options.speed, true);
+    if (definition.slow) manager.move(2, int(definition.slow->start), options.speed, true);
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    QObject::disconnect(homing);
+
+    QVector<qint64> gaps;
+    gaps.reserve(ScanEngine::pointCount(definition));
+    qint64 lastArrivalNs = 0;
+    qint64 firstArrivalNs = 0;
+    int arrived = 0;
+    bool completed = false;
+    QString message;
+
+    QObject::connect(&manager, &QtKohzuManager::scanPointArrived, &loop, [&](const ScanArrival& arrival) {
+        if (arrived == 0) firstArrivalNs = arrival.timestampNs;
+        else gaps.append(arrival.timestampNs - lastArrivalNs);
+        lastArrivalNs = arrival.timestampNs;
+        ++arrived;
+    });
+    QObject::connect(&manager, &QtKohzuManager::scanFinished, &loop, [&](bool ok, const QString& text) {
+        completed = ok;
+        message = text;
+        loop.quit();
+    });
+
+    QElapsedTimer clock;
+    clock.start();
+    manager.startScan(definition);
+    QTimer::singleShot(options.timeoutMs, &loop, &QEventLoop::quit);
+    loop.exec();
+    const double seconds = clock.nsecsElapsed() / 1e9;
+
+    manager.disconnectFromController();
+    simulator.stop();
+
+    const double spanSeconds = (lastArrivalNs - firstArrivalNs) / 1e9;
+    benchOut() << QString("%1 %2 points=%3/%4 %5 elapsed=%6s rate=%7 points/s")
+                      .arg(pattern == ScanPattern::Snake ? "snake " : "raster")
+                      .arg(lookahead ? "lookahead" : "serial   ")
+                      .arg(arrived).arg(ScanEngine::pointCount(definition))
+                      .arg(completed ? "completed" : message)
+                      .arg(seconds, 0, 'f', 3)
+                      .arg(spanSeconds > 0 ? (arrived - 1) / spanSeconds : 0.0, 0, 'f', 1)
+               << Qt::endl;
+    benchOut() << "    arrival spacing: " << formatLatency(summarizeLatencies(gaps)) << Qt::endl;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("kohzu-scan-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Step-scan points/second against the local Kohzu simulator.");
+    parser.addHelpOption();
+    parser.addOption({"fast-points", "Points along the fast axis.", "n", "20"});
+    parser.addOption({"slow-points", "Points along the slow axis (1 = 1D scan).", "n", "20"});
+    parser.addOption({"step", "Step size in pulses.", "pulses", "100"});
+    parser.addOption({"speed-table", "Speed table used for every move (0-9).", "n", "9"});
+    parser.addOption({"dwell-ms", "Dwell after each arrival.", "ms", "0"});
+    parser.addOption({"latency-us", "Simulated response latency in microseconds.", "us", "200"});
+    parser.addOption({"speed-scale", "Simulated motion speed multiplier.", "x", "1"});
+    parser.process(app);
+
+    BenchOptions options;
+    options.fastPoints = qMax(2, parser.value("fast-points").toInt());
+    options.slowPoints = qMax(1, parser.value("slow-points").toInt());
+    options.stepPulses = qMax(1.0, parser.value("step").toDouble());
+    options.speed = qBound(0, parser.value("speed-table").toInt(), 9);
+    options.dwellMs = qMax(0, parser.value("dwell-ms").toInt());
+
+    SimulatorConfig simConfig;
+    simConfig.responseLatency = std::chrono::microseconds(parser.value("latency-us").toInt());
+    simConfig.speedScale = qMax(0.001, parser.value("speed-scale").toDouble());
+
+    for (ScanPattern pattern : {ScanPattern::Raster, ScanPattern::Snake}) {
+        for (bool lookahead : {false, true}) {
+            runScan(options, simConfig, pattern, lookahead);
+        }
+    }
+    return 0;
+}
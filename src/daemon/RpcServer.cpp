@@ -0,0 +1,386 @@
+#include "RpcServer.h"
+#include "TrajectoryRecorder.h"
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMetaEnum>
+#include <QPointer>
+#include <QThreadPool>
+#include <climits>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace {
+
+constexpr int kParseError = -32700;
+constexpr int kInvalidRequest = -32600;
+constexpr int kMethodNotFound = -32601;
+constexpr int kInvalidParams = -32602;
+constexpr int kCommandFailed = -32000;    // the controller answered with an error status
+constexpr int kNotAccepted = -32001;      // not connected, or the command queue is full
+constexpr int kConnectionLost = -32002;   // the link dropped before the controller answered
+
+constexpr qint64 kMaxLineBytes = 64 * 1024;
+
+bool readInt(const QJsonObject& params, const char* key, int min, int max, int& out)
+{
+    const QJsonValue value = params.value(QLatin1String(key));
+    if (!value.isDouble()) return false;
+    const double number = value.toDouble();
+    if (number != std::floor(number) || number < min || number > max) return false;
+    out = static_cast<int>(number);
+    return true;
+}
+
+bool readAxes(const QJsonObject& params, QVector<int>& axes)
+{
+    const QJsonValue value = params.value(QLatin1String("axes"));
+    if (!value.isArray()) return false;
+    for (const QJsonValue& item : value.toArray()) {
+        const int axisNo = item.toInt(0);
+        if (axisNo < 1 || axisNo > AxisStateSnapshot::kMaxAxes) return false;
+        axes.append(axisNo);
+    }
+    return true;
+}
+
+QString stateName(QtKohzuManager::ConnectionState state)
+{
+    return QString::fromLatin1(QMetaEnum::fromType<QtKohzuManager::ConnectionState>().valueToKey(int(state)));
+}
+
+} // namespace
+
+RpcServer::RpcServer(QtKohzuManager *manager, QObject *parent)
+    : QObject(parent),
+    manager_(manager),
+    server_(new QLocalServer(this))
+{
+    connect(server_, &QLocalServer::newConnection, this, &RpcServer::onNewConnection);
+    connect(manager_, &QtKohzuManager::commandResult, this, &RpcServer::onCommandResult);
+    connect(manager_, &QtKohzuManager::positionsUpdated, this, &RpcServer::onPositionsUpdated);
+    connect(manager_, &QtKohzuManager::connectionStateChanged, this, &RpcServer::onConnectionStateChanged);
+}
+
+bool RpcServer::listen(const QString &name, QString &error)
+{
+    QLocalServer::removeServer(name);
+    server_->setSocketOptions(QLocalServer::UserAccessOption);
+    if (!server_->listen(name)) {
+        error = server_->errorString();
+        return false;
+    }
+    return true;
+}
+
+void RpcServer::onNewConnection()
+{
+    while (QLocalSocket* socket = server_->nextPendingConnection()) {
+        clients_.insert(socket, Client());
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() { dropClient(socket); });
+    }
+}
+
+void RpcServer::onReadyRead(QLocalSocket *socket)
+{
+    while (socket->canReadLine()) {
+        const QByteArray line = socket->readLine().trimmed();
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            sendError(socket, QJsonValue::Null, kParseError, parseError.errorString());
+        } else if (!doc.isObject()) {
+            sendError(socket, QJsonValue::Null, kInvalidRequest, "request must be a JSON object");
+        } else {
+            handleRequest(socket, doc.object());
+        }
+    }
+
+    if (socket->bytesAvailable() > kMaxLineBytes) {
+        sendError(socket, QJsonValue::Null, kInvalidRequest, "request line too long");
+        socket->disconnectFromServer();
+    }
+}
+
+void RpcServer::dropClient(QLocalSocket *socket)
+{
+    if (!clients_.contains(socket)) return;
+
+    const QSet<int> axes = clients_.value(socket).axes;
+    unsubscribe(socket, QVector<int>(axes.begin(), axes.end()));
+    clients_.remove(socket);
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        it = it->socket == socket ? pending_.erase(it) : std::next(it);
+    }
+    socket->deleteLater();
+}
+
+void RpcServer::handleRequest(QLocalSocket *socket, const QJsonObject &request)
+{
+    // A request without "id" is a notification and gets no reply
+    const QJsonValue id = request.value("id");
+    const QString method = request.value("method").toString();
+    const QJsonObject params = request.value("params").toObject();
+
+    if (method == "move") {
+        int axisNo = 0, pulse = 0, speed = 9;
+        if (!readInt(params, "axis", 1, AxisStateSnapshot::kMaxAxes, axisNo)
+            || !readInt(params, "pulse", INT_MIN, INT_MAX, pulse)
+            || (params.contains("speed") && !readInt(params, "speed", 0, 9, speed))) {
+            sendError(socket, id, kInvalidParams, "move needs axis (1-32), pulse and an optional speed (0-9)");
+            return;
+        }
+        const bool isAbsolute = params.value("absolute").toBool(true);
+        submit(socket, id, axisNo, isAbsolute ? CommandKind::MoveAbsolute : CommandKind::MoveRelative, pulse, speed, 0, 0);
+    } else if (method == "origin") {
+        int axisNo = 0, speed = 9;
+        if (!readInt(params, "axis", 1, AxisStateSnapshot::kMaxAxes, axisNo)
+            || (params.contains("speed") && !readInt(params, "speed", 0, 9, speed))) {
+            sendError(socket, id, kInvalidParams, "origin needs axis (1-32) and an optional speed (0-9)");
+            return;
+        }
+        submit(socket, id, axisNo, CommandKind::Origin, 0, speed, 0, 0);
+    } else if (method == "setSystem") {
+        int axisNo = 0, systemNo = 0, value = 0;
+        if (!readInt(params, "axis", 1, AxisStateSnapshot::kMaxAxes, axisNo)
+            || !readInt(params, "no", 0, INT_MAX, systemNo)
+            || !readInt(params, "value", INT_MIN, INT_MAX, value)) {
+            sendError(socket, id, kInvalidParams, "setSystem needs axis (1-32), no and value");
+            return;
+        }
+        submit(socket, id, axisNo, CommandKind::System, 0, 0, systemNo, value);
+    } else if (method == "subscribe") {
+        QVector<int> axes;
+        if (!readAxes(params, axes)) {
+            sendError(socket, id, kInvalidParams, "subscribe needs an \"axes\" list (1-32)");
+            return;
+        }
+        sendResult(socket, id, subscribe(socket, axes));
+    } else if (method == "unsubscribe") {
+        QVector<int> axes;
+        if (!params.contains("axes")) {
+            const QSet<int> all = clients_.value(socket).axes;
+            axes = QVector<int>(all.begin(), all.end());
+        } else if (!readAxes(params, axes)) {
+            sendError(socket, id, kInvalidParams, "unsubscribe takes an optional \"axes\" list (1-32)");
+            return;
+        }
+        unsubscribe(socket, axes);
+        sendResult(socket, id, true);
+    } else if (method == "positions") {
+        QVector<int> axes;
+        if (!readAxes(params, axes)) {
+            sendError(socket, id, kInvalidParams, "positions needs an \"axes\" list (1-32)");
+            return;
+        }
+        sendResult(socket, id, positionsOf(axes));
+    } else if (method == "status") {
+        sendResult(socket, id, QJsonObject{
+            {"state", stateName(manager_->connectionState())},
+            {"pending", manager_->pendingCommandCount()},
+            {"clients", int(clients_.size())}
+        });
+    } else if (method == "connect") {
+        int port = 0;
+        const QString host = params.value("host").toString();
+        if (host.isEmpty() || !readInt(params, "port", 1, 65535, port)) {
+            sendError(socket, id, kInvalidParams, "connect needs host and port");
+            return;
+        }
+        // The outcome arrives as a "state" notification
+        manager_->connectToController(host, quint16(port));
+        sendResult(socket, id, QJsonObject{{"state", stateName(manager_->connectionState())}});
+    } else if (method == "disconnect") {
+        manager_->disconnectFromController();
+        // Disconnecting clears the poll list; keep existing subscriptions alive for the next connect
+        for (auto it = pollRefs_.cbegin(); it != pollRefs_.cend(); ++it) {
+            manager_->addAxisToPoll(it.key());
+        }
+        sendResult(socket, id, true);
+    } else if (method == "exportTrajectory") {
+        QVector<int> axes;
+        const QString path = params.value("path").toString();
+        const QString format = params.value("format").toString("csv");
+        if (path.isEmpty() || (format != "csv" && format != "binary")
+            || (params.contains("axes") && !readAxes(params, axes))) {
+            sendError(socket, id, kInvalidParams,
+                      "exportTrajectory needs path and takes format (csv|binary), fromMs, toMs (Unix ms) and axes");
+            return;
+        }
+        exportTrajectory(socket, id, path, format == "csv" ? TrajectoryFormat::Csv : TrajectoryFormat::Binary,
+                         params.value("fromMs"), params.value("toMs"), axes);
+    } else if (method.isEmpty()) {
+        sendError(socket, id, kInvalidRequest, "missing method");
+    } else {
+        sendError(socket, id, kMethodNotFound, QString("unknown method \"%1\"").arg(method));
+    }
+}
+
+void RpcServer::exportTrajectory(QLocalSocket *socket, const QJsonValue &id, const QString &path, TrajectoryFormat format,
+                                 const QJsonValue &fromMs, const QJsonValue &toMs, const QVector<int> &axes)
+{
+    auto recorder = manager_->trajectoryRecorder();
+    if (!recorder) {
+        sendError(socket, id, kNotAccepted, "trajectory recording is not active");
+        return;
+    }
+    const qint64 fromNs = fromMs.isDouble() ? qint64(fromMs.toDouble() * 1e6) : std::numeric_limits<qint64>::min();
+    const qint64 toNs = toMs.isDouble() ? qint64(toMs.toDouble() * 1e6) : std::numeric_limits<qint64>::max();
+    quint64 axisMask = 0;
+    for (int axisNo : axes) axisMask |= quint64(1) << axisNo;
+
+    // Streams on a worker thread; recording and every other request go on meanwhile
+    QPointer<QLocalSocket> client(socket);
+    QThreadPool::globalInstance()->start([this, client, id, recorder, path, format, fromNs, toNs, axisMask]() {
+        QString error;
+        const bool ok = recorder->exportWindow(path, format, fromNs, toNs, axisMask, error);
+        QMetaObject::invokeMethod(this, [this, client, id, path, ok, error]() {
+            if (!client) return;
+            if (ok) {
+                sendResult(client, id, QJsonObject{{"path", path}});
+            } else {
+                sendError(client, id, kCommandFailed, error);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void RpcServer::submit(QLocalSocket *socket, const QJsonValue &id, int axisNo, CommandKind kind,
+                       int pulse, int speed, int systemNo, int value)
+{
+    const quint64 tag = id.isUndefined() ? 0 : nextTag_++;
+    if (!manager_->submitTagged(tag, axisNo, kind, pulse, speed, systemNo, value)) {
+        const bool connected = manager_->connectionState() == QtKohzuManager::ConnectionState::Connected;
+        sendError(socket, id, kNotAccepted, connected ? "command queue is full" : "not connected");
+        return;
+    }
+    if (tag != 0) {
+        pending_.insert(tag, PendingCommand{socket, id});
+    }
+}
+
+void RpcServer::onCommandResult(quint64 tag, int axisNo, bool success, const QString &response)
+{
+    const auto it = pending_.find(tag);
+    if (it == pending_.end()) return;   // client gone, or already failed on link loss
+    const PendingCommand command = it.value();
+    pending_.erase(it);
+
+    if (success) {
+        sendResult(command.socket, command.id, QJsonObject{{"axis", axisNo}, {"response", response}});
+    } else {
+        sendError(command.socket, command.id, kCommandFailed,
+                  response.isEmpty() ? QString("axis %1: no response").arg(axisNo) : response);
+    }
+}
+
+QJsonValue RpcServer::subscribe(QLocalSocket *socket, const QVector<int> &axes)
+{
+    Client& client = clients_[socket];
+    for (int axisNo : axes) {
+        if (client.axes.contains(axisNo)) continue;
+        client.axes.insert(axisNo);
+        if (++pollRefs_[axisNo] == 1) {
+            manager_->addAxisToPoll(axisNo);
+        }
+    }
+    // Current values as the baseline the following deltas apply to
+    return QJsonObject{{"positions", positionsOf(axes)}};
+}
+
+void RpcServer::unsubscribe(QLocalSocket *socket, const QVector<int> &axes)
+{
+    Client& client = clients_[socket];
+    for (int axisNo : axes) {
+        if (!client.axes.remove(axisNo)) continue;
+        if (--pollRefs_[axisNo] == 0) {
+            pollRefs_.remove(axisNo);
+            manager_->removeAxisToPoll(axisNo);
+        }
+    }
+}
+
+QJsonArray RpcServer::positionsOf(const QVector<int> &axes) const
+{
+    const AxisStateSnapshot snapshot = manager_->snapshot();
+    QJsonArray positions;
+    for (int axisNo : axes) {
+        const AxisSnapshotEntry& entry = snapshot[axisNo];
+        if (entry.timestampNs == 0) continue;   // never sampled
+        positions.append(QJsonArray{axisNo, entry.positionPulse, qint64(entry.timestampNs / 1000)});
+    }
+    return positions;
+}
+
+void RpcServer::onPositionsUpdated(const QVector<AxisSample> &samples)
+{
+    for (auto it = clients_.cbegin(); it != clients_.cend(); ++it) {
+        if (it->axes.isEmpty()) continue;
+
+        QJsonArray changed;
+        for (const AxisSample& sample : samples) {
+            if (it->axes.contains(sample.axisNo)) {
+                changed.append(QJsonArray{sample.axisNo, sample.positionPulse, qint64(sample.timestampNs / 1000)});
+            }
+        }
+        if (!changed.isEmpty()) {
+            send(it.key(), QJsonObject{{"jsonrpc", "2.0"}, {"method", "positions"}, {"params", changed}});
+        }
+    }
+}
+
+void RpcServer::onConnectionStateChanged(QtKohzuManager::ConnectionState state)
+{
+    if (state == QtKohzuManager::ConnectionState::Disconnected
+        || state == QtKohzuManager::ConnectionState::Reconnecting) {
+        failPending(state == QtKohzuManager::ConnectionState::Disconnected ? "disconnected" : "connection lost");
+    }
+
+    const QJsonObject notification{
+        {"jsonrpc", "2.0"},
+        {"method", "state"},
+        {"params", QJsonObject{{"state", stateName(state)}}}
+    };
+    for (auto it = clients_.cbegin(); it != clients_.cend(); ++it) {
+        send(it.key(), notification);
+    }
+}
+
+void RpcServer::failPending(const QString &reason)
+{
+    // Results of the old connection that still trickle in no longer find their tag
+    const QHash<quint64, PendingCommand> pending = std::exchange(pending_, {});
+    for (const PendingCommand& command : pending) {
+        sendError(command.socket, command.id, kConnectionLost, reason);
+    }
+}
+
+void RpcServer::sendResult(QLocalSocket *socket, const QJsonValue &id, const QJsonValue &result)
+{
+    if (id.isUndefined()) return;
+    send(socket, QJsonObject{{"jsonrpc", "2.0"}, {"id", id}, {"result", result}});
+}
+
+void RpcServer::sendError(QLocalSocket *socket, const QJsonValue &id, int code, const QString &message)
+{
+    if (id.isUndefined()) return;
+    send(socket, QJsonObject{
+        {"jsonrpc", "2.0"},
+        {"id", id},
+        {"error", QJsonObject{{"code", code}, {"message", message}}}
+    });
+}
+
+void RpcServer::send(QLocalSocket *socket, const QJsonObject &message)
+{
+    QByteArray line = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    socket->write(line);
+    // Push the reply out now instead of on the next event loop pass
+    socket->flush();
+}
@@ -0,0 +1,84 @@
+#ifndef RPCSERVER_H
+#define RPCSERVER_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QMap>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+#include "QtKohzuManager.h"
+#include "TrajectoryRecorder.h"
+
+class QLocalServer;
+class QLocalSocket;
+
+// JSON-RPC 2.0 over a local socket, one compact JSON object per line.
+//
+// Requests:
+//   move       {"axis":1,"pulse":1000,"speed":9,"absolute":true}
+//   origin     {"axis":1,"speed":9}
+//   setSystem  {"axis":1,"no":2,"value":8}
+//   subscribe  {"axes":[1,2]}     result carries the current positions
+//   unsubscribe{"axes":[1,2]}     no params = every axis of this client
+//   positions  {"axes":[1,2]}     one-shot read of the snapshot
+//   status, connect {"host":"...","port":12321}, disconnect
+//   exportTrajectory {"path":"...","format":"csv","fromMs":...,"toMs":...,"axes":[1]}
+//
+// move/origin/setSystem are answered when the controller replies, with the
+// raw response as result. Subscribers get "positions" notifications with
+// only the axes that changed, as [axis, pulse, timestampUs] triples, and
+// every client gets "state" notifications on connection changes.
+class RpcServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RpcServer(QtKohzuManager* manager, QObject* parent = nullptr);
+
+    // Replaces a stale socket left behind by a previous instance
+    bool listen(const QString& name, QString& error);
+
+private slots:
+    void onNewConnection();
+    void onCommandResult(quint64 tag, int axisNo, bool success, const QString& response);
+    void onPositionsUpdated(const QVector<AxisSample>& samples);
+    void onConnectionStateChanged(QtKohzuManager::ConnectionState state);
+
+private:
+    struct Client {
+        QSet<int> axes;   // subscribed axes
+    };
+
+    struct PendingCommand {
+        QLocalSocket* socket = nullptr;
+        QJsonValue id;
+    };
+
+    void onReadyRead(QLocalSocket* socket);
+    void dropClient(QLocalSocket* socket);
+    void handleRequest(QLocalSocket* socket, const QJsonObject& request);
+    void submit(QLocalSocket* socket, const QJsonValue& id, int axisNo, CommandKind kind,
+                int pulse, int speed, int systemNo, int value);
+    QJsonValue subscribe(QLocalSocket* socket, const QVector<int>& axes);
+    void unsubscribe(QLocalSocket* socket, const QVector<int>& axes);
+    void exportTrajectory(QLocalSocket* socket, const QJsonValue& id, const QString& path, TrajectoryFormat format,
+                          const QJsonValue& fromMs, const QJsonValue& toMs, const QVector<int>& axes);
+    QJsonArray positionsOf(const QVector<int>& axes) const;
+    void failPending(const QString& reason);
+
+    void sendResult(QLocalSocket* socket, const QJsonValue& id, const QJsonValue& result);
+    void sendError(QLocalSocket* socket, const QJsonValue& id, int code, const QString& message);
+    void send(QLocalSocket* socket, const QJsonObject& message);
+
+    QtKohzuManager* manager_;
+    QLocalServer* server_;
+    QHash<QLocalSocket*, Client> clients_;
+    QHash<quint64, PendingCommand> pending_;   // tag -> request waiting for the controller
+    quint64 nextTag_ = 1;
+    QMap<int, int> pollRefs_;                  // axis -> subscribed clients
+};
+
+#endif // RPCSERVER_H
@@ -0,0 +1,67 @@
+// Headless controller daemon: runs QtKohzuManager without any widgets and
+// exposes it to automation over a local JSON-RPC socket (see RpcServer.h).
+
+#include "MetricsExporter.h"
+#include "QtKohzuManager.h"
+#include "RpcServer.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("qtkohzu-daemon");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Kohzu controller daemon with a local JSON-RPC control socket.");
+    parser.addHelpOption();
+    parser.addOption({"socket", "Local socket (pipe) name to listen on.", "name", "qtkohzu"});
+    parser.addOption({"host", "Controller address to connect to at startup.", "host"});
+    parser.addOption({"port", "Controller port.", "port", "12321"});
+    parser.addOption({"coalescing-ms", "Minimum interval between position notifications.", "ms", "20"});
+    parser.addOption({"metrics-file", "Write Prometheus text-format metrics to this file.", "path"});
+    parser.addOption({"metrics-interval-ms", "How often the metrics file is rewritten.", "ms", "5000"});
+    parser.addOption({"capture-file", "Record all controller traffic to this capture file.", "path"});
+    parser.addOption({"trajectory-file", "Keep the motion history of polled axes in this ring file.", "path"});
+    parser.addOption({"trajectory-samples", "Samples kept per axis in the trajectory ring.", "n", "65536"});
+    parser.addOption({"quiet", "Do not print controller log messages."});
+    parser.process(app);
+
+    QTextStream err(stderr);
+    QtKohzuManager manager;
+    manager.setPositionCoalescingInterval(parser.value("coalescing-ms").toInt());
+    if (!parser.isSet("quiet")) {
+        QObject::connect(&manager, &QtKohzuManager::logMessage, &app, [&err](const QString& message) {
+            err << message << Qt::endl;
+        });
+    }
+
+    if (parser.isSet("capture-file") && !manager.setCaptureFile(parser.value("capture-file"))) {
+        return 1;
+    }
+
+    if (parser.isSet("trajectory-file")
+        && !manager.startTrajectoryRecording(parser.value("trajectory-file"), parser.value("trajectory-samples").toInt())) {
+        return 1;
+    }
+
+    MetricsExporter exporter(&manager);
+    if (parser.isSet("metrics-file")) {
+        exporter.start(parser.value("metrics-file"), parser.value("metrics-interval-ms").toInt());
+    }
+
+    RpcServer server(&manager);
+    QString error;
+    if (!server.listen(parser.value("socket"), error)) {
+        err << "Cannot listen on " << parser.value("socket") << ": " << error << Qt::endl;
+        return 1;
+    }
+    err << "Listening on " << parser.value("socket") << Qt::endl;
+
+    if (parser.isSet("host")) {
+        manager.connectToController(parser.value("host"), quint16(parser.value("port").toUInt()));
+    }
+    return app.exec();
+}
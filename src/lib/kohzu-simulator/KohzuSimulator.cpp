@@ -0,0 +1,312 @@
+#include "KohzuSimulator.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <sstream>
+
+namespace {
+// Error numbers returned in "E" responses. Values follow the controller manual.
+constexpr int kErrorUnknownCommand = 1;
+constexpr int kErrorInvalidAxis = 2;
+constexpr int kErrorInvalidParameter = 3;
+constexpr int kErrorAxisBusy = 104;
+
+std::vector<std::string> split(const std::string& text, char delimiter)
+{
+    std::vector<std::string> tokens;
+    std::stringstream stream(text);
+    std::string token;
+    while (std::getline(stream, token, delimiter)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool toInt(const std::string& text, int& out)
+{
+    try {
+        size_t used = 0;
+        out = std::stoi(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+} // namespace
+
+// One accepted client connection. Reads CRLF-terminated commands and writes
+// responses strictly in the order they are handed to send().
+class KohzuSimulator::Session : public std::enable_shared_from_this<Session>
+{
+public:
+    Session(KohzuSimulator& owner, boost::asio::ip::tcp::socket socket)
+        : owner_(owner), socket_(std::move(socket)) {}
+
+    void start() { doRead(); }
+
+    void send(std::string response)
+    {
+        const bool idle = writeQueue_.empty();
+        writeQueue_.push_back(std::move(response));
+        if (idle) {
+            doWrite();
+        }
+    }
+
+private:
+    void doRead()
+    {
+        auto self = shared_from_this();
+        boost::asio::async_read_until(socket_, readBuffer_, '\n',
+            [this, self](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    return;
+                }
+                std::istream stream(&readBuffer_);
+                std::string line;
+                std::getline(stream, line);
+                owner_.handleLine(self, line);
+                doRead();
+            });
+    }
+
+    void doWrite()
+    {
+        auto self = shared_from_this();
+        boost::asio::async_write(socket_, boost::asio::buffer(writeQueue_.front()),
+            [this, self](const boost::system::error_code& ec, std::size_t) {
+                if (ec) {
+                    writeQueue_.clear();
+                    return;
+                }
+                writeQueue_.pop_front();
+                if (!writeQueue_.empty()) {
+                    doWrite();
+                }
+            });
+    }
+
+    KohzuSimulator& owner_;
+    boost::asio::ip::tcp::socket socket_;
+    boost::asio::streambuf readBuffer_;
+    std::deque<std::string> writeQueue_;
+};
+
+KohzuSimulator::KohzuSimulator(SimulatorConfig config)
+    : config_(std::move(config)), acceptor_(ioContext_), axes_(std::max(config_.axisCount, 1) + 1)
+{
+}
+
+KohzuSimulator::~KohzuSimulator()
+{
+    stop();
+}
+
+void KohzuSimulator::start()
+{
+    if (ioThread_) return;
+
+    using boost::asio::ip::tcp;
+    tcp::endpoint endpoint(boost::asio::ip::make_address(config_.bindAddress), config_.port);
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+    port_ = acceptor_.local_endpoint().port();
+
+    doAccept();
+    // A previous stop() leaves the context stopped
+    ioContext_.restart();
+    ioThread_ = std::make_unique<std::thread>([this]() {
+        try {
+            ioContext_.run();
+        } catch (const std::exception& e) {
+            spdlog::error("simulator io_context exception: {}", e.what());
+        }
+    });
+    spdlog::info("Kohzu simulator listening on {}:{}", config_.bindAddress, port_);
+}
+
+void KohzuSimulator::stop()
+{
+    if (!ioThread_) return;
+
+    ioContext_.stop();
+    if (ioThread_->joinable()) {
+        ioThread_->join();
+    }
+    ioThread_.reset();
+
+    // No io thread any more, so the acceptor can be closed here; its aborted
+    // accept runs (and returns) after the next start()
+    boost::system::error_code ec;
+    acceptor_.close(ec);
+}
+
+SimulatorStats KohzuSimulator::stats() const
+{
+    SimulatorStats stats;
+    stats.commandsReceived = commandsReceived_.load(std::memory_order_relaxed);
+    stats.responsesSent = responsesSent_.load(std::memory_order_relaxed);
+    stats.errorsSent = errorsSent_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+int KohzuSimulator::position(int axisNo) const
+{
+    std::lock_guard<std::mutex> lock(axesMutex_);
+    if (axisNo < 1 || axisNo >= static_cast<int>(axes_.size())) return 0;
+    return positionAt(axes_[axisNo], Clock::now());
+}
+
+void KohzuSimulator::doAccept()
+{
+    acceptor_.async_accept([this](const boost::system::error_code& ec, boost::asio::ip::tcp::socket socket) {
+        if (ec) {
+            return;
+        }
+        boost::system::error_code optionError;
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), optionError);
+        std::make_shared<Session>(*this, std::move(socket))->start();
+        doAccept();
+    });
+}
+
+int KohzuSimulator::positionAt(const Axis& axis, Clock::time_point now) const
+{
+    if (!isMoving(axis, now) || axis.endTime <= axis.startTime) {
+        return axis.targetPulse;
+    }
+    const double fraction = std::chrono::duration<double>(now - axis.startTime).count()
+                            / std::chrono::duration<double>(axis.endTime - axis.startTime).count();
+    return axis.startPulse + static_cast<int>(std::lround((axis.targetPulse - axis.startPulse) * fraction));
+}
+
+KohzuSimulator::Clock::duration KohzuSimulator::travelTime(int fromPulse, int toPulse, int speedTable) const
+{
+    const int table = std::clamp(speedTable, 0, static_cast<int>(config_.speedTablePps.size()) - 1);
+    const double pps = config_.speedTablePps[table] * std::max(config_.speedScale, 1e-6);
+    const double seconds = std::abs(static_cast<double>(toPulse) - fromPulse) / pps;
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+void KohzuSimulator::handleLine(const std::shared_ptr<Session>& session, const std::string& rawLine)
+{
+    commandsReceived_.fetch_add(1, std::memory_order_relaxed);
+
+    std::string line = rawLine;
+    line.erase(std::remove_if(line.begin(), line.end(), [](char c) {
+        return c == '\x02' || c == '\r' || c == '\n';
+    }), line.end());
+
+    const auto now = Clock::now();
+    const std::string command = line.substr(0, 3);
+    const std::vector<std::string> args = split(line.size() > 3 ? line.substr(3) : std::string(), '/');
+
+    auto error = [&](int errorNo, const std::string& tag) {
+        errorsSent_.fetch_add(1, std::memory_order_relaxed);
+        respond(session, "E\t" + tag + "\t" + std::to_string(errorNo) + "\r\n", now);
+    };
+
+    int axisNo = 0;
+    if (args.empty() || !toInt(args[0], axisNo)) {
+        error(kErrorUnknownCommand, command);
+        return;
+    }
+    const std::string tag = command + std::to_string(axisNo);
+    if (axisNo < 1 || axisNo >= static_cast<int>(axes_.size())) {
+        error(kErrorInvalidAxis, tag);
+        return;
+    }
+
+    std::vector<int> params;
+    for (size_t i = 1; i < args.size(); ++i) {
+        int value = 0;
+        if (!toInt(args[i], value)) {
+            error(kErrorInvalidParameter, tag);
+            return;
+        }
+        params.push_back(value);
+    }
+
+    std::unique_lock<std::mutex> lock(axesMutex_);
+    Axis& axis = axes_[axisNo];
+
+    if (command == "RDP") {
+        const int pos = positionAt(axis, now);
+        lock.unlock();
+        respond(session, "C\t" + tag + "\t" + std::to_string(pos) + "\r\n", now);
+    } else if (command == "STR") {
+        const bool moving = isMoving(axis, now);
+        lock.unlock();
+        // driving, EMG, ORG, CW limit, CCW limit, soft limit, correction
+        respond(session, "C\t" + tag + "\t" + (moving ? "1" : "0") + "\t0\t0\t0\t0\t0\t0\r\n", now);
+    } else if (command == "APS" || command == "RPS" || command == "ORG") {
+        const bool isOrigin = command == "ORG";
+        const size_t required = isOrigin ? 1 : 2;
+        if (params.size() < required) {
+            lock.unlock();
+            error(kErrorInvalidParameter, tag);
+            return;
+        }
+        if (isMoving(axis, now)) {
+            lock.unlock();
+            error(kErrorAxisBusy, tag);
+            return;
+        }
+        const int speedTable = params[0];
+        int target = 0;
+        if (command == "APS") {
+            target = params[1];
+        } else if (command == "RPS") {
+            target = axis.targetPulse + params[1];
+        }
+        const int responseType = params.size() > required ? params[required] : 0;
+
+        axis.startPulse = axis.targetPulse;
+        axis.targetPulse = target;
+        axis.startTime = now;
+        axis.endTime = now + travelTime(axis.startPulse, target, speedTable);
+        const auto completeAt = responseType == 0 ? axis.endTime : now;
+        lock.unlock();
+        respond(session, "C\t" + tag + "\r\n", completeAt);
+    } else if (command == "WSY") {
+        if (params.size() < 2) {
+            lock.unlock();
+            error(kErrorInvalidParameter, tag);
+            return;
+        }
+        axis.system[params[0]] = params[1];
+        lock.unlock();
+        respond(session, "C\t" + tag + "\r\n", now);
+    } else if (command == "RSY") {
+        if (params.empty()) {
+            lock.unlock();
+            error(kErrorInvalidParameter, tag);
+            return;
+        }
+        const int value = axis.system.count(params[0]) ? axis.system[params[0]] : 0;
+        lock.unlock();
+        respond(session, "C\t" + tag + "\t" + std::to_string(params[0]) + "\t" + std::to_string(value) + "\r\n", now);
+    } else {
+        lock.unlock();
+        error(kErrorUnknownCommand, tag);
+    }
+}
+
+void KohzuSimulator::respond(const std::shared_ptr<Session>& session, std::string response, Clock::time_point at)
+{
+    responsesSent_.fetch_add(1, std::memory_order_relaxed);
+    const auto due = at + config_.responseLatency;
+    if (due <= Clock::now()) {
+        session->send(std::move(response));
+        return;
+    }
+    auto timer = std::make_shared<boost::asio::steady_timer>(ioContext_, due);
+    timer->async_wait([session, timer, response = std::move(response)](const boost::system::error_code& ec) mutable {
+        if (!ec) {
+            session->send(std::move(response));
+        }
+    });
+}
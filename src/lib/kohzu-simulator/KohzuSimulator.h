@@ -0,0 +1,92 @@
+#ifndef KOHZUSIMULATOR_H
+#define KOHZUSIMULATOR_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/asio.hpp>
+
+// Loopback stand-in for a Kohzu ARIES/LYNX controller.
+//
+// Speaks the same STX ... CRLF text protocol the kohzu-controller library uses
+// (APS/RPS/ORG/RDP/STR/WSY/RSY) so QtKohzuManager can be driven without real
+// hardware. Every axis moves at the pulse rate of its selected speed table, and
+// every response can be delayed by a fixed latency to mimic the network.
+struct SimulatorConfig {
+    std::string bindAddress = "127.0.0.1";
+    unsigned short port = 0;                          // 0 = pick a free port
+    int axisCount = 32;
+    std::chrono::microseconds responseLatency{0};     // added to every response
+    // Pulses per second for speed table 0..9
+    std::array<int, 10> speedTablePps = {100, 500, 1000, 2000, 5000,
+                                         10000, 20000, 50000, 100000, 200000};
+    double speedScale = 1.0;                          // >1 runs motions faster than real time
+};
+
+struct SimulatorStats {
+    std::uint64_t commandsReceived = 0;
+    std::uint64_t responsesSent = 0;
+    std::uint64_t errorsSent = 0;
+};
+
+class KohzuSimulator
+{
+public:
+    explicit KohzuSimulator(SimulatorConfig config = {});
+    ~KohzuSimulator();
+
+    KohzuSimulator(const KohzuSimulator&) = delete;
+    KohzuSimulator& operator=(const KohzuSimulator&) = delete;
+
+    void start();
+    void stop();
+
+    unsigned short port() const { return port_; }
+    const SimulatorConfig& config() const { return config_; }
+    SimulatorStats stats() const;
+
+    // Current simulated position, safe to call from any thread.
+    int position(int axisNo) const;
+
+private:
+    class Session;
+    using Clock = std::chrono::steady_clock;
+
+    struct Axis {
+        int startPulse = 0;
+        int targetPulse = 0;
+        Clock::time_point startTime{};
+        Clock::time_point endTime{};
+        std::map<int, int> system;     // WSY/RSY storage, keyed by system number
+    };
+
+    void doAccept();
+    void handleLine(const std::shared_ptr<Session>& session, const std::string& line);
+    void respond(const std::shared_ptr<Session>& session, std::string response, Clock::time_point at);
+
+    int positionAt(const Axis& axis, Clock::time_point now) const;
+    bool isMoving(const Axis& axis, Clock::time_point now) const { return now < axis.endTime; }
+    Clock::duration travelTime(int fromPulse, int toPulse, int speedTable) const;
+
+    SimulatorConfig config_;
+    boost::asio::io_context ioContext_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::unique_ptr<std::thread> ioThread_;
+    unsigned short port_ = 0;
+
+    mutable std::mutex axesMutex_;
+    std::vector<Axis> axes_;
+
+    std::atomic<std::uint64_t> commandsReceived_{0};
+    std::atomic<std::uint64_t> responsesSent_{0};
+    std::atomic<std::uint64_t> errorsSent_{0};
+};
+
+#endif // KOHZUSIMULATOR_H
@@ -0,0 +1,115 @@
+#include "AwaitableMotion.h"
+#include "MonitoringScheduler.h"
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+
+namespace {
+
+// Same as the moving-axis monitoring period, so a wait never polls faster than the data changes
+constexpr std::chrono::milliseconds kPollInterval{10};
+
+// The coroutine's completion handler, owned by the pipeline until the reply:
+// the only allocation a command makes besides the resume
+template <typename Handler>
+class PendingCommand : public CommandPipeline::Completion
+{
+public:
+    PendingCommand(Handler handler, std::shared_ptr<MonitoringScheduler> scheduler, int axisNo, bool isMotion)
+        : handler_(std::move(handler)), scheduler_(std::move(scheduler)), axisNo_(axisNo), isMotion_(isMotion)
+    {
+    }
+
+    void complete(const CommandResult& result) override
+    {
+        if (isMotion_ && result.sentNs != 0 && scheduler_) {
+            scheduler_->notifyCommandFinished(axisNo_);
+        }
+        // Resuming through the executor keeps the next step out of the pipeline's own bookkeeping
+        auto executor = boost::asio::get_associated_executor(handler_);
+        boost::asio::post(executor, [handler = std::move(handler_), result]() mutable { std::move(handler)(result); });
+    }
+
+private:
+    Handler handler_;
+    std::shared_ptr<MonitoringScheduler> scheduler_;
+    int axisNo_;
+    bool isMotion_;
+};
+
+} // namespace
+
+AwaitableMotion::AwaitableMotion(MotionChannel channel)
+    : channel_(std::move(channel))
+{
+}
+
+boost::asio::awaitable<CommandResult> AwaitableMotion::move(int axisNo, int pulse, int speed, bool isAbsolute)
+{
+    return submit(axisNo, isAbsolute ? CommandKind::MoveAbsolute : CommandKind::MoveRelative, pulse, speed, 0, 0);
+}
+
+boost::asio::awaitable<CommandResult> AwaitableMotion::moveOrigin(int axisNo, int speed)
+{
+    return submit(axisNo, CommandKind::Origin, 0, speed, 0, 0);
+}
+
+boost::asio::awaitable<CommandResult> AwaitableMotion::setSystem(int axisNo, int systemNo, int value)
+{
+    return submit(axisNo, CommandKind::System, 0, 0, systemNo, value);
+}
+
+boost::asio::awaitable<CommandResult> AwaitableMotion::submit(int axisNo, CommandKind kind, int pulse, int speed,
+                                                              int systemNo, int value)
+{
+    auto pipeline = channel_.pipeline;
+    auto scheduler = channel_.scheduler;
+    const bool isMotion = kind != CommandKind::System;
+
+    co_return co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), void(CommandResult)>(
+        [pipeline, scheduler, axisNo, kind, pulse, speed, systemNo, value, isMotion](auto handler) {
+            using Handler = std::decay_t<decltype(handler)>;
+            auto command = std::make_unique<PendingCommand<Handler>>(std::move(handler), scheduler, axisNo, isMotion);
+            if (!pipeline) {
+                CommandResult refused;
+                refused.fullResponse = "not connected";
+                command->complete(refused);
+                return;
+            }
+            // A refused command is completed by the pipeline with the reason
+            pipeline->submit(axisNo, kind, pulse, speed, systemNo, value, std::move(command));
+        },
+        boost::asio::use_awaitable);
+}
+
+boost::asio::awaitable<bool> AwaitableMotion::waitIdle(int axisNo, std::chrono::milliseconds timeout)
+{
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        const bool pending = channel_.pipeline && channel_.pipeline->pendingCountForAxis(axisNo) > 0;
+        const bool moving = channel_.snapshot && channel_.snapshot->read()[axisNo].status == AxisMotionStatus::Moving;
+        if (!pending && !moving) co_return true;
+        if (std::chrono::steady_clock::now() >= deadline) co_return false;
+        timer.expires_after(kPollInterval);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+}
+
+boost::asio::awaitable<bool> AwaitableMotion::waitAtPosition(int axisNo, int pulse, int tolerance,
+                                                             std::chrono::milliseconds timeout)
+{
+    boost::asio::steady_timer timer(co_await boost::asio::this_coro::executor);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (;;) {
+        if (channel_.snapshot) {
+            const AxisSnapshotEntry entry = channel_.snapshot->read()[axisNo];
+            if (entry.timestampNs != 0 && std::llabs(static_cast<long long>(entry.positionPulse) - pulse) <= tolerance) {
+                co_return true;
+            }
+        }
+        if (std::chrono::steady_clock::now() >= deadline) co_return false;
+        timer.expires_after(kPollInterval);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef AWAITABLEMOTION_H
+#define AWAITABLEMOTION_H
+
+#include "CommandPipeline.h"
+#include "MotionChannel.h"
+#include <boost/asio.hpp>
+#include <chrono>
+
+// Awaitable controller commands for procedures written as C++20 coroutines.
+//
+// Every function must be awaited from a coroutine running on the channel's
+// io_context, e.g.
+//
+//   boost::asio::awaitable<void> stack(AwaitableMotion motion)
+//   {
+//       co_await motion.moveOrigin(3, 9);
+//       co_await motion.move(1, 5000, 9, true);
+//       co_await motion.waitAtPosition(1, 5000, 2, std::chrono::seconds(5));
+//   }
+//   boost::asio::co_spawn(motion.ioContext(), stack(motion), boost::asio::detached);
+//
+// Commands go through the same CommandPipeline (QueuePolicy::Keep) and
+// monitoring hooks as ScanEngine and SequenceRunner, so a multi-step
+// procedure is straight-line code that stays on the io thread between steps
+// instead of a chain of callbacks or a slot state machine. A command that
+// is refused (queue full, not connected) completes with status 'E'.
+class AwaitableMotion
+{
+public:
+    explicit AwaitableMotion(MotionChannel channel);
+
+    boost::asio::io_context& ioContext() const { return *channel_.ioContext; }
+
+    // Resume with the controller's reply; for moves that is when the motion has finished
+    boost::asio::awaitable<CommandResult> move(int axisNo, int pulse, int speed, bool isAbsolute);
+    boost::asio::awaitable<CommandResult> moveOrigin(int axisNo, int speed);
+    boost::asio::awaitable<CommandResult> setSystem(int axisNo, int systemNo, int value);
+
+    // Poll the snapshot; false on timeout. "Idle" means nothing this connection
+    // sent is moving the axis: no command for it is queued or in flight and the
+    // scheduler does not report it Moving. An axis that was never commanded or
+    // polled (status Unknown) is therefore idle at once.
+    boost::asio::awaitable<bool> waitIdle(int axisNo, std::chrono::milliseconds timeout);
+    boost::asio::awaitable<bool> waitAtPosition(int axisNo, int pulse, int tolerance, std::chrono::milliseconds timeout);
+
+private:
+    boost::asio::awaitable<CommandResult> submit(int axisNo, CommandKind kind, int pulse, int speed,
+                                                 int systemNo, int value);
+
+    MotionChannel channel_;
+};
+
+#endif // AWAITABLEMOTION_H
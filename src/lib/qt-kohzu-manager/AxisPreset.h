@@ -0,0 +1,18 @@
+#ifndef AXISPRESET_H
+#define AXISPRESET_H
+
+#include <QString>
+#include <QUuid>
+
+// 단일 프리셋 데이터를 담는 구조체
+struct AxisPreset {
+    QUuid id;
+    QString motorName;
+    bool isAbsolute;
+    double value;
+    int speed;
+
+    bool operator==(const AxisPreset& other) const { return id == other.id; }
+};
+
+#endif // AXISPRESET_H
@@ -0,0 +1,17 @@
+#ifndef AXISSAMPLE_H
+#define AXISSAMPLE_H
+
+#include <QMetaType>
+#include <QVector>
+#include <cstdint>
+
+// 한 축의 위치 샘플 (변경된 축만 positionsUpdated로 전달됨)
+struct AxisSample {
+    int axisNo = 0;
+    int positionPulse = 0;
+    std::int64_t timestampNs = 0;   // steady_clock 기준 샘플 시각
+};
+
+Q_DECLARE_METATYPE(AxisSample)
+
+#endif // AXISSAMPLE_H
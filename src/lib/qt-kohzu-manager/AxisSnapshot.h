@@ -0,0 +1,110 @@
+#ifndef AXISSNAPSHOT_H
+#define AXISSNAPSHOT_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// 축 동작 상태 (MonitoringScheduler 기준)
+enum class AxisMotionStatus : std::int32_t {
+    Unknown = 0,
+    Idle,
+    Moving,
+    Settling
+};
+
+struct AxisSnapshotEntry {
+    int positionPulse = 0;
+    AxisMotionStatus status = AxisMotionStatus::Unknown;
+    std::int64_t timestampNs = 0;   // steady_clock time of the last position sample
+};
+
+// A consistent cut of every axis, taken at one point in time.
+struct AxisStateSnapshot {
+    static constexpr int kMaxAxes = 32;
+
+    std::uint64_t sequence = 0;
+    std::array<AxisSnapshotEntry, kMaxAxes + 1> axes{};   // indexed by axis number, [0] unused
+
+    const AxisSnapshotEntry& operator[](int axisNo) const
+    {
+        return axes[(axisNo >= 1 && axisNo <= kMaxAxes) ? axisNo : 0];
+    }
+};
+
+// Seqlock-protected table of per-axis state.
+//
+// There is exactly one writer, the io thread (PositionPublisher and
+// MonitoringScheduler both run there), which never waits for readers. Readers
+// on any thread copy the whole table and retry only if a write overlapped the
+// copy. Each axis occupies its own cache line so the writer touching one axis
+// does not bounce the lines of the others.
+class AxisSnapshotBuffer
+{
+public:
+    static constexpr int kMaxAxes = AxisStateSnapshot::kMaxAxes;
+
+    // Writer side, io thread only. Group several writes between begin/end so
+    // readers see them together.
+    void beginWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void endWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void writePosition(int axisNo, int positionPulse, std::int64_t timestampNs)
+    {
+        if (!isValid(axisNo)) return;
+        slots_[axisNo].position.store(positionPulse, std::memory_order_relaxed);
+        slots_[axisNo].timestampNs.store(timestampNs, std::memory_order_relaxed);
+    }
+
+    void writeStatus(int axisNo, AxisMotionStatus status)
+    {
+        if (!isValid(axisNo)) return;
+        slots_[axisNo].status.store(static_cast<std::int32_t>(status), std::memory_order_relaxed);
+    }
+
+    // Reader side, any thread.
+    AxisStateSnapshot read() const
+    {
+        AxisStateSnapshot snapshot;
+        for (;;) {
+            const std::uint64_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) continue;   // writer is mid-update
+
+            for (int axisNo = 1; axisNo <= kMaxAxes; ++axisNo) {
+                const Slot& slot = slots_[axisNo];
+                AxisSnapshotEntry& entry = snapshot.axes[axisNo];
+                entry.positionPulse = slot.position.load(std::memory_order_relaxed);
+                entry.status = static_cast<AxisMotionStatus>(slot.status.load(std::memory_order_relaxed));
+                entry.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                snapshot.sequence = before / 2;
+                return snapshot;
+            }
+        }
+    }
+
+private:
+    static bool isValid(int axisNo) { return axisNo >= 1 && axisNo <= kMaxAxes; }
+
+    struct alignas(64) Slot {
+        std::atomic<std::int32_t> position{0};
+        std::atomic<std::int32_t> status{0};
+        std::atomic<std::int64_t> timestampNs{0};
+    };
+
+    alignas(64) std::atomic<std::uint64_t> sequence_{0};
+    std::array<Slot, kMaxAxes + 1> slots_{};
+};
+
+#endif // AXISSNAPSHOT_H
@@ -0,0 +1,145 @@
+#include "CaptureProxy.h"
+#include "WireCapture.h"
+#include "spdlog/spdlog.h"
+#include <array>
+
+using boost::asio::ip::tcp;
+
+// One relayed connection: host <-> proxy <-> controller. Each direction reads
+// a chunk, records it and writes it on before reading again, so a slow side
+// simply back-pressures the other.
+class CaptureProxy::Link : public std::enable_shared_from_this<Link>
+{
+public:
+    Link(tcp::socket host, std::shared_ptr<CaptureWriter> writer)
+        : host_(std::move(host)), controller_(host_.get_executor()), resolver_(host_.get_executor()),
+          writer_(std::move(writer)) {}
+
+    void start(const std::string& upstreamHost, const std::string& upstreamPort)
+    {
+        auto self = shared_from_this();
+        resolver_.async_resolve(upstreamHost, upstreamPort,
+            [self](const boost::system::error_code& ec, tcp::resolver::results_type endpoints) {
+                if (ec) {
+                    spdlog::warn("capture proxy: cannot resolve controller: {}", ec.message());
+                    self->close();
+                    return;
+                }
+                boost::asio::async_connect(self->controller_, endpoints,
+                    [self](const boost::system::error_code& ec, const tcp::endpoint&) {
+                        if (ec) {
+                            spdlog::warn("capture proxy: cannot reach controller: {}", ec.message());
+                            self->close();
+                            return;
+                        }
+                        boost::system::error_code optionError;
+                        self->controller_.set_option(tcp::no_delay(true), optionError);
+                        self->pump(self->host_, self->controller_, self->toController_, CaptureFrame::HostToController);
+                        self->pump(self->controller_, self->host_, self->toHost_, CaptureFrame::ControllerToHost);
+                    });
+            });
+    }
+
+private:
+    using Buffer = std::array<char, 16 * 1024>;
+    static_assert(sizeof(Buffer) <= CaptureFrame::kMaxBytes, "a captured read must load back");
+
+    void pump(tcp::socket& from, tcp::socket& to, Buffer& buffer, CaptureFrame::Direction direction)
+    {
+        auto self = shared_from_this();
+        from.async_read_some(boost::asio::buffer(buffer),
+            [self, &from, &to, &buffer, direction](const boost::system::error_code& ec, std::size_t length) {
+                if (ec) {
+                    self->close();
+                    return;
+                }
+                self->writer_->write(direction, buffer.data(), length);
+                boost::asio::async_write(to, boost::asio::buffer(buffer.data(), length),
+                    [self, &from, &to, &buffer, direction](const boost::system::error_code& ec, std::size_t) {
+                        if (ec) {
+                            self->close();
+                            return;
+                        }
+                        self->pump(from, to, buffer, direction);
+                    });
+            });
+    }
+
+    void close()
+    {
+        boost::system::error_code ignored;
+        resolver_.cancel();
+        host_.close(ignored);
+        controller_.close(ignored);
+    }
+
+    tcp::socket host_;
+    tcp::socket controller_;
+    tcp::resolver resolver_;
+    std::shared_ptr<CaptureWriter> writer_;
+    Buffer toController_;
+    Buffer toHost_;
+};
+
+CaptureProxy::CaptureProxy(std::string upstreamHost, std::string upstreamPort, std::shared_ptr<CaptureWriter> writer)
+    : acceptor_(ioContext_), upstreamHost_(std::move(upstreamHost)), upstreamPort_(std::move(upstreamPort)),
+      writer_(std::move(writer))
+{
+}
+
+CaptureProxy::~CaptureProxy()
+{
+    stop();
+}
+
+bool CaptureProxy::start(std::string& error)
+{
+    if (thread_) return true;
+
+    try {
+        const tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), 0);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+        port_ = acceptor_.local_endpoint().port();
+    } catch (const std::exception& e) {
+        error = std::string("capture proxy: ") + e.what();
+        return false;
+    }
+
+    doAccept();
+    thread_ = std::make_unique<std::thread>([this]() {
+        try {
+            ioContext_.run();
+        } catch (const std::exception& e) {
+            spdlog::error("capture proxy io_context exception: {}", e.what());
+        }
+    });
+    return true;
+}
+
+void CaptureProxy::stop()
+{
+    if (!thread_) return;
+
+    // Links hold themselves alive through their pending operations; stopping
+    // the context and destroying it with this object releases them.
+    ioContext_.stop();
+    if (thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+}
+
+void CaptureProxy::doAccept()
+{
+    acceptor_.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (ec) {
+            return;
+        }
+        boost::system::error_code optionError;
+        socket.set_option(tcp::no_delay(true), optionError);
+        std::make_shared<Link>(std::move(socket), writer_)->start(upstreamHost_, upstreamPort_);
+        doAccept();
+    });
+}
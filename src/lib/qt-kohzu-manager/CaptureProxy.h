@@ -0,0 +1,46 @@
+#ifndef CAPTUREPROXY_H
+#define CAPTUREPROXY_H
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+
+class CaptureWriter;
+
+// Loopback TCP relay that records controller traffic.
+//
+// Listens on 127.0.0.1 (free port) and forwards every accepted connection to
+// the real controller, writing each read in either direction to a
+// CaptureWriter. TcpClient comes from the kohzu-controller library, so
+// QtKohzuManager records by pointing it at this relay instead of the
+// controller. The relay runs on its own thread so it keeps serving while a
+// blocking TcpClient::connect waits for it.
+class CaptureProxy
+{
+public:
+    CaptureProxy(std::string upstreamHost, std::string upstreamPort, std::shared_ptr<CaptureWriter> writer);
+    ~CaptureProxy();
+
+    CaptureProxy(const CaptureProxy&) = delete;
+    CaptureProxy& operator=(const CaptureProxy&) = delete;
+
+    bool start(std::string& error);
+    void stop();
+    unsigned short port() const { return port_; }
+
+private:
+    class Link;
+
+    void doAccept();
+
+    boost::asio::io_context ioContext_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::unique_ptr<std::thread> thread_;
+    std::string upstreamHost_;
+    std::string upstreamPort_;
+    std::shared_ptr<CaptureWriter> writer_;
+    unsigned short port_ = 0;
+};
+
+#endif // CAPTUREPROXY_H
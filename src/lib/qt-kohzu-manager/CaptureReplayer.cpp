@@ -0,0 +1,145 @@
+#include "CaptureReplayer.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+
+using boost::asio::ip::tcp;
+
+CaptureReplayer::CaptureReplayer(std::vector<CaptureFrame> frames, double speed)
+    : speed_(speed), acceptor_(ioContext_), client_(ioContext_), timer_(ioContext_)
+{
+    originNs_ = frames.empty() ? 0 : frames.front().offsetNs;
+    // Only the controller's side is played back
+    frames.erase(std::remove_if(frames.begin(), frames.end(), [](const CaptureFrame& frame) {
+        return frame.direction != CaptureFrame::ControllerToHost;
+    }), frames.end());
+    frames_ = std::move(frames);
+}
+
+CaptureReplayer::~CaptureReplayer()
+{
+    stop();
+}
+
+bool CaptureReplayer::start(std::string& error)
+{
+    if (thread_) return true;
+
+    try {
+        const tcp::endpoint endpoint(boost::asio::ip::make_address("127.0.0.1"), 0);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+        port_ = acceptor_.local_endpoint().port();
+    } catch (const std::exception& e) {
+        error = std::string("capture replayer: ") + e.what();
+        return false;
+    }
+
+    doAccept();
+    thread_ = std::make_unique<std::thread>([this]() {
+        try {
+            ioContext_.run();
+        } catch (const std::exception& e) {
+            spdlog::error("capture replayer io_context exception: {}", e.what());
+        }
+    });
+    return true;
+}
+
+void CaptureReplayer::stop()
+{
+    if (!thread_) return;
+
+    ioContext_.stop();
+    if (thread_->joinable()) {
+        thread_->join();
+    }
+    thread_.reset();
+}
+
+ReplayStats CaptureReplayer::stats() const
+{
+    ReplayStats stats;
+    stats.framesSent = framesSent_.load(std::memory_order_relaxed);
+    stats.bytesSent = bytesSent_.load(std::memory_order_relaxed);
+    stats.bytesReceived = bytesReceived_.load(std::memory_order_relaxed);
+    stats.elapsedNs = elapsedNs_.load(std::memory_order_relaxed);
+    stats.finished = finished_.load(std::memory_order_acquire);
+    return stats;
+}
+
+void CaptureReplayer::doAccept()
+{
+    acceptor_.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (ec) {
+            return;
+        }
+        // Replaces whoever connected before; their pending handlers see a new generation
+        const std::uint64_t generation = ++generation_;
+        boost::system::error_code ignored;
+        timer_.cancel();
+        client_.close(ignored);
+        socket.set_option(tcp::no_delay(true), ignored);
+        client_ = std::move(socket);
+
+        next_ = 0;
+        framesSent_.store(0, std::memory_order_relaxed);
+        bytesSent_.store(0, std::memory_order_relaxed);
+        bytesReceived_.store(0, std::memory_order_relaxed);
+        elapsedNs_.store(0, std::memory_order_relaxed);
+        finished_.store(false, std::memory_order_release);
+        startTime_ = Clock::now();
+        readAndDrop(generation);
+        sendNext(generation);
+        doAccept();
+    });
+}
+
+void CaptureReplayer::readAndDrop(std::uint64_t generation)
+{
+    client_.async_read_some(boost::asio::buffer(readBuffer_),
+                            [this, generation](const boost::system::error_code& ec, std::size_t length) {
+        if (ec || generation != generation_) {
+            return;
+        }
+        bytesReceived_.fetch_add(length, std::memory_order_relaxed);
+        readAndDrop(generation);
+    });
+}
+
+void CaptureReplayer::sendNext(std::uint64_t generation)
+{
+    if (next_ >= frames_.size()) {
+        elapsedNs_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime_).count(),
+                         std::memory_order_relaxed);
+        finished_.store(true, std::memory_order_release);
+        return;
+    }
+
+    const CaptureFrame& frame = frames_[next_];
+    if (speed_ > 0.0) {
+        const auto due = startTime_ + std::chrono::nanoseconds(static_cast<std::int64_t>((frame.offsetNs - originNs_) / speed_));
+        if (due > Clock::now()) {
+            timer_.expires_at(due);
+            timer_.async_wait([this, generation](const boost::system::error_code& ec) {
+                if (!ec && generation == generation_) sendNext(generation);
+            });
+            return;
+        }
+    }
+
+    boost::asio::async_write(client_, boost::asio::buffer(frame.bytes),
+                             [this, generation](const boost::system::error_code& ec, std::size_t length) {
+        if (generation != generation_) {
+            return;
+        }
+        if (ec) {
+            spdlog::warn("capture replayer: client went away after {} frames: {}", next_, ec.message());
+            return;
+        }
+        framesSent_.fetch_add(1, std::memory_order_relaxed);
+        bytesSent_.fetch_add(length, std::memory_order_relaxed);
+        ++next_;
+        sendNext(generation);
+    });
+}
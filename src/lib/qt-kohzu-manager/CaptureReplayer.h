@@ -0,0 +1,80 @@
+#ifndef CAPTUREREPLAYER_H
+#define CAPTUREREPLAYER_H
+
+#include "WireCapture.h"
+#include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 재생 결과
+struct ReplayStats {
+    std::uint64_t framesSent = 0;
+    std::uint64_t bytesSent = 0;
+    std::uint64_t bytesReceived = 0;   // 재생 중 클라이언트가 보낸 명령 (버려짐)
+    std::int64_t elapsedNs = 0;        // 첫 연결부터 마지막 프레임 전송까지
+    bool finished = false;
+};
+
+// Plays the controller side of a capture back over loopback TCP.
+//
+// A connecting client receives every controller-to-host frame of the capture
+// in order, at the recorded offsets divided by `speed` (0 = as fast as the
+// socket takes them). Whatever the client sends is read and dropped, so the
+// frames reach TcpClient, ProtocolHandler and KohzuController exactly as
+// recorded and the replay is the same on every run. The most recent
+// connection wins: a new one closes the previous client and the replay starts
+// over from the first frame, so a reachability probe ahead of the real
+// connection does not consume the capture.
+class CaptureReplayer
+{
+public:
+    CaptureReplayer(std::vector<CaptureFrame> frames, double speed);
+    ~CaptureReplayer();
+
+    CaptureReplayer(const CaptureReplayer&) = delete;
+    CaptureReplayer& operator=(const CaptureReplayer&) = delete;
+
+    bool start(std::string& error);
+    void stop();
+    unsigned short port() const { return port_; }
+
+    ReplayStats stats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void doAccept();
+    void readAndDrop(std::uint64_t generation);
+    void sendNext(std::uint64_t generation);
+
+    std::vector<CaptureFrame> frames_;
+    double speed_;
+
+    boost::asio::io_context ioContext_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::ip::tcp::socket client_;
+    boost::asio::steady_timer timer_;
+    std::unique_ptr<std::thread> thread_;
+    unsigned short port_ = 0;
+
+    // io thread only
+    std::uint64_t generation_ = 0;   // bumped per accepted client; stale handlers compare against it
+    std::size_t next_ = 0;
+    Clock::time_point startTime_{};
+    std::int64_t originNs_ = 0;
+    std::array<char, 16 * 1024> readBuffer_;
+
+    std::atomic<std::uint64_t> framesSent_{0};
+    std::atomic<std::uint64_t> bytesSent_{0};
+    std::atomic<std::uint64_t> bytesReceived_{0};
+    std::atomic<std::int64_t> elapsedNs_{0};
+    std::atomic<bool> finished_{false};
+};
+
+#endif // CAPTUREREPLAYER_H
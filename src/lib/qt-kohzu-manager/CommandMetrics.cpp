@@ -0,0 +1,68 @@
+#include "CommandMetrics.h"
+
+void CommandMetrics::recordCommand(CommandKind kind, int axisNo, bool success, bool timedOut, std::int64_t enqueuedNs,
+                                   std::int64_t sentNs, std::int64_t receivedNs, std::int64_t deliveredNs)
+{
+    const int k = static_cast<int>(kind);
+    if (timedOut) {
+        // No reply to time; only the count says something
+        timedOut_[k].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (sentNs == 0) {
+        // Cancelled or refused before it was sent
+        failed_[k].fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    (success ? succeeded_[k] : failed_[k]).fetch_add(1, std::memory_order_relaxed);
+
+    auto& stages = latency_[k];
+    stages[static_cast<int>(LatencyStage::Queue)].record(sentNs - enqueuedNs);
+    if (receivedNs != 0) {
+        stages[static_cast<int>(LatencyStage::RoundTrip)].record(receivedNs - sentNs);
+        stages[static_cast<int>(LatencyStage::Delivery)].record(deliveredNs - receivedNs);
+    }
+    stages[static_cast<int>(LatencyStage::Total)].record(deliveredNs - enqueuedNs);
+    if (axisNo >= 1 && axisNo <= kMaxAxes) {
+        axisLatency_[axisNo - 1].record(deliveredNs - enqueuedNs);
+    }
+}
+
+void CommandMetrics::recordPollTick(int deferredAxes)
+{
+    pollTicks_.fetch_add(1, std::memory_order_relaxed);
+    if (deferredAxes > 0) {
+        pollDeferred_.fetch_add(static_cast<std::uint64_t>(deferredAxes), std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::Snapshot CommandMetrics::motionStageSnapshot(LatencyStage stage) const
+{
+    LatencyHistogram::Snapshot merged;
+    for (CommandKind kind : {CommandKind::MoveAbsolute, CommandKind::MoveRelative, CommandKind::Origin}) {
+        merged.merge(latency(kind, stage).snapshot());
+    }
+    return merged;
+}
+
+const char* CommandMetrics::kindName(CommandKind kind)
+{
+    switch (kind) {
+    case CommandKind::MoveAbsolute: return "move_absolute";
+    case CommandKind::MoveRelative: return "move_relative";
+    case CommandKind::Origin: return "origin";
+    case CommandKind::System: return "system";
+    }
+    return "unknown";
+}
+
+const char* CommandMetrics::stageName(LatencyStage stage)
+{
+    switch (stage) {
+    case LatencyStage::Queue: return "queue";
+    case LatencyStage::RoundTrip: return "round_trip";
+    case LatencyStage::Delivery: return "delivery";
+    case LatencyStage::Total: return "total";
+    }
+    return "unknown";
+}
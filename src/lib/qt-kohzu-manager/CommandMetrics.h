@@ -0,0 +1,86 @@
+#ifndef COMMANDMETRICS_H
+#define COMMANDMETRICS_H
+
+#include "CommandPipeline.h"
+#include "LatencyHistogram.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// 명령 지연 구간 (모두 steady_clock 기준)
+enum class LatencyStage {
+    Queue,       // submit → 파이프라인이 컨트롤러로 전송
+    RoundTrip,   // 전송 → 컨트롤러 응답 수신 (io 스레드)
+    Delivery,    // 응답 수신 → GUI 스레드 처리
+    Total        // submit → GUI 스레드 처리
+};
+
+// Latency histograms and counters of one controller connection.
+//
+// Outlives individual sessions so numbers accumulate across reconnects.
+// Writers are the io thread (poll ticks) and the GUI thread (completed
+// commands); every update is a relaxed atomic, and readers such as the status
+// bar or the Prometheus exporter work on snapshots.
+class CommandMetrics
+{
+public:
+    static constexpr int kKindCount = 4;
+    static constexpr int kStageCount = 4;
+    static constexpr int kMaxAxes = 32;
+
+    // Timestamps are monotonicNs(); sentNs is 0 for commands cancelled before they were sent
+    void recordCommand(CommandKind kind, int axisNo, bool success, bool timedOut, std::int64_t enqueuedNs,
+                       std::int64_t sentNs, std::int64_t receivedNs, std::int64_t deliveredNs);
+    void recordRejected() { rejected_.fetch_add(1, std::memory_order_relaxed); }
+    // Queued moves folded into another one (merged) or replaced by a newer target (superseded)
+    void recordMerged() { merged_.fetch_add(1, std::memory_order_relaxed); }
+    void recordSuperseded() { superseded_.fetch_add(1, std::memory_order_relaxed); }
+    // How late a polled axis was sampled relative to its period
+    void recordPollLateness(std::int64_t latenessNs) { pollLateness_.record(latenessNs); }
+    void recordPollTick(int deferredAxes);
+    void recordLinkLoss() { linkLosses_.fetch_add(1, std::memory_order_relaxed); }
+    void recordReconnect() { reconnects_.fetch_add(1, std::memory_order_relaxed); }
+
+    const LatencyHistogram& latency(CommandKind kind, LatencyStage stage) const
+    {
+        return latency_[static_cast<int>(kind)][static_cast<int>(stage)];
+    }
+    // Submit-to-delivery latency of one axis (1-32)
+    const LatencyHistogram& axisLatency(int axisNo) const { return axisLatency_[axisNo - 1]; }
+    const LatencyHistogram& pollLateness() const { return pollLateness_; }
+    // One stage over the motion kinds (moves and origin); System commands
+    // answer in milliseconds and are read through latency() on their own
+    LatencyHistogram::Snapshot motionStageSnapshot(LatencyStage stage) const;
+
+    std::uint64_t succeeded(CommandKind kind) const { return succeeded_[static_cast<int>(kind)].load(std::memory_order_relaxed); }
+    std::uint64_t failed(CommandKind kind) const { return failed_[static_cast<int>(kind)].load(std::memory_order_relaxed); }
+    std::uint64_t timedOut(CommandKind kind) const { return timedOut_[static_cast<int>(kind)].load(std::memory_order_relaxed); }
+    std::uint64_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+    std::uint64_t merged() const { return merged_.load(std::memory_order_relaxed); }
+    std::uint64_t superseded() const { return superseded_.load(std::memory_order_relaxed); }
+    std::uint64_t pollTicks() const { return pollTicks_.load(std::memory_order_relaxed); }
+    std::uint64_t pollDeferred() const { return pollDeferred_.load(std::memory_order_relaxed); }
+    std::uint64_t linkLosses() const { return linkLosses_.load(std::memory_order_relaxed); }
+    std::uint64_t reconnects() const { return reconnects_.load(std::memory_order_relaxed); }
+
+    static const char* kindName(CommandKind kind);
+    static const char* stageName(LatencyStage stage);
+
+private:
+    std::array<std::array<LatencyHistogram, kStageCount>, kKindCount> latency_;
+    std::array<LatencyHistogram, kMaxAxes> axisLatency_;
+    LatencyHistogram pollLateness_;
+
+    std::array<std::atomic<std::uint64_t>, kKindCount> succeeded_{};
+    std::array<std::atomic<std::uint64_t>, kKindCount> failed_{};
+    std::array<std::atomic<std::uint64_t>, kKindCount> timedOut_{};
+    std::atomic<std::uint64_t> rejected_{0};
+    std::atomic<std::uint64_t> merged_{0};
+    std::atomic<std::uint64_t> superseded_{0};
+    std::atomic<std::uint64_t> pollTicks_{0};
+    std::atomic<std::uint64_t> pollDeferred_{0};   // due axes pushed to a later tick by the query budget
+    std::atomic<std::uint64_t> linkLosses_{0};
+    std::atomic<std::uint64_t> reconnects_{0};
+};
+
+#endif // COMMANDMETRICS_H
@@ -0,0 +1,362 @@
+#include "CommandPipeline.h"
+#include "CommandMetrics.h"
+#include "LatencyHistogram.h"
+#include "controller/KohzuController.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+CommandPipeline::CommandPipeline(boost::asio::io_context& ioContext, std::shared_ptr<KohzuController> controller,
+                                 PipelineConfig config, std::shared_ptr<CommandMetrics> metrics)
+    : ioContext_(ioContext), controller_(std::move(controller)), metrics_(std::move(metrics)),
+      maxQueued_(std::max(config.maxQueued, 1)), maxQueuedPerAxis_(std::max(config.maxQueuedPerAxis, 1)), config_(config)
+{
+    config_.maxInFlight = std::max(config.maxInFlight, 1);
+}
+
+bool CommandPipeline::submit(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value, Callback callback,
+                             QueuePolicy policy, const void* owner)
+{
+    Request request;
+    request.axisNo = axisNo;
+    request.kind = kind;
+    request.pulse = pulse;
+    request.speed = speed;
+    request.systemNo = systemNo;
+    request.value = value;
+    request.policy = policy;
+    request.owner = owner;
+    request.callback = std::move(callback);
+    return submitRequest(request);
+}
+
+bool CommandPipeline::submit(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value,
+                             std::unique_ptr<Completion> completion, const void* owner)
+{
+    Request request;
+    request.axisNo = axisNo;
+    request.kind = kind;
+    request.pulse = pulse;
+    request.speed = speed;
+    request.systemNo = systemNo;
+    request.value = value;
+    request.owner = owner;
+    request.completion = std::move(completion);
+    if (submitRequest(request)) {
+        return true;
+    }
+    CommandResult refused;
+    refused.fullResponse = isClosed() ? "not accepted: disconnected" : "not accepted: command queue is full";
+    request.completion->complete(refused);
+    return false;
+}
+
+bool CommandPipeline::submitRequest(Request& request)
+{
+    if (closed_.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    const int axisNo = request.axisNo;
+    const bool tracked = axisNo >= 1 && axisNo <= kMaxAxes;
+    if (tracked) {
+        const int axisPending = axisPending_[axisNo].fetch_add(1, std::memory_order_relaxed);
+        if (request.policy == QueuePolicy::Coalesce && axisPending >= maxQueuedPerAxis_.load(std::memory_order_relaxed)) {
+            axisPending_[axisNo].fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // Back-pressure: reserve a slot before handing the request to the io thread
+    int pending = pending_.load(std::memory_order_relaxed);
+    do {
+        if (pending >= maxQueued_.load(std::memory_order_relaxed)) {
+            if (tracked) axisPending_[axisNo].fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!pending_.compare_exchange_weak(pending, pending + 1, std::memory_order_relaxed));
+
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, request = std::move(request)]() mutable {
+        request.id = self->nextId_++;
+        self->enqueue(std::move(request));
+    });
+    return true;
+}
+
+int CommandPipeline::pendingCountForAxis(int axisNo) const
+{
+    if (axisNo < 1 || axisNo > kMaxAxes) return 0;
+    return axisPending_[axisNo].load(std::memory_order_relaxed);
+}
+
+void CommandPipeline::release(int axisNo, int count)
+{
+    pending_.fetch_sub(count, std::memory_order_relaxed);
+    if (axisNo >= 1 && axisNo <= kMaxAxes) {
+        axisPending_[axisNo].fetch_sub(count, std::memory_order_relaxed);
+    }
+}
+
+void CommandPipeline::enqueue(Request request)
+{
+    if (closed_.load(std::memory_order_acquire)) {
+        // Submitted just before close(); cancelAll() has already run
+        release(request.axisNo, 1);
+        CommandResult result;
+        result.fullResponse = "cancelled";
+        take(request)(result);
+        return;
+    }
+    if (request.policy == QueuePolicy::Coalesce
+        && (request.kind == CommandKind::MoveAbsolute || request.kind == CommandKind::MoveRelative)) {
+        // Only the newest queued motion command of the axis may absorb the new one,
+        // so the axis still ends up where the commands in submit order would take it
+        auto queued = std::find_if(queue_.rbegin(), queue_.rend(), [&request](const Request& other) {
+            return other.axisNo == request.axisNo && other.kind != CommandKind::System;
+        });
+        if (queued != queue_.rend() && coalesce(*queued, request)) {
+            return;
+        }
+    }
+    queue_.push_back(std::move(request));
+    pump();
+}
+
+bool CommandPipeline::coalesce(Request& queued, Request& request)
+{
+    if (queued.policy != QueuePolicy::Coalesce || queued.kind == CommandKind::Origin) {
+        return false;
+    }
+
+    if (request.kind == CommandKind::MoveAbsolute) {
+        // The new target makes the queued move pointless; it takes over its place in the queue
+        Callback superseded = std::move(queued.callback);
+        const int axisNo = queued.axisNo;
+        queued = std::move(request);
+        release(axisNo, 1);
+        if (metrics_) metrics_->recordSuperseded();
+
+        CommandResult result;
+        result.fullResponse = "superseded";
+        result.superseded = true;
+        if (superseded) superseded(result);
+        return true;
+    }
+
+    // Relative after relative adds up; relative after absolute shifts the target
+    const long long merged = static_cast<long long>(queued.pulse) + request.pulse;
+    if (queued.speed != request.speed || merged < INT_MIN || merged > INT_MAX) {
+        return false;
+    }
+    queued.pulse = static_cast<int>(merged);
+    queued.callback = [first = std::move(queued.callback), second = std::move(request.callback)](const CommandResult& result) {
+        if (first) {
+            CommandResult mergedResult = result;
+            mergedResult.merged = true;
+            first(mergedResult);
+        }
+        if (second) second(result);
+    };
+    release(request.axisNo, 1);
+    if (metrics_) metrics_->recordMerged();
+    return true;
+}
+
+void CommandPipeline::setConfig(const PipelineConfig& config)
+{
+    maxQueued_.store(std::max(config.maxQueued, 1), std::memory_order_relaxed);
+    maxQueuedPerAxis_.store(std::max(config.maxQueuedPerAxis, 1), std::memory_order_relaxed);
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, config]() {
+        self->config_ = config;
+        self->config_.maxInFlight = std::max(config.maxInFlight, 1);
+        self->pump();
+    });
+}
+
+void CommandPipeline::cancelAll()
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self]() {
+        // Sent commands keep their send time so callers can tell them from never-sent ones
+        std::vector<std::pair<Done, std::int64_t>> callbacks;
+        for (auto& [key, inFlight] : self->inFlightByKey_) {
+            // A timed-out command only held its key; its caller was answered already
+            if (inFlight.timedOut) continue;
+            inFlight.timer->cancel();
+            callbacks.emplace_back(take(inFlight.request), inFlight.sentNs);
+            self->release(key.first, 1);
+        }
+        for (Request& request : self->queue_) {
+            callbacks.emplace_back(take(request), 0);
+            self->release(request.axisNo, 1);
+        }
+        self->inFlightByKey_.clear();
+        self->queue_.clear();
+        self->inFlight_.store(0, std::memory_order_relaxed);
+
+        CommandResult result;
+        result.fullResponse = "cancelled";
+        for (auto& [done, sentNs] : callbacks) {
+            result.sentNs = sentNs;
+            done(result);
+        }
+    });
+}
+
+void CommandPipeline::close()
+{
+    closed_.store(true, std::memory_order_release);
+    cancelAll();
+}
+
+void CommandPipeline::cancelQueuedForAxis(int axisNo, const void* owner)
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, axisNo, owner]() {
+        std::vector<Done> callbacks;
+        for (auto it = self->queue_.begin(); it != self->queue_.end();) {
+            if (it->axisNo == axisNo && (!owner || it->owner == owner)) {
+                callbacks.push_back(take(*it));
+                it = self->queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        self->release(axisNo, static_cast<int>(callbacks.size()));
+
+        CommandResult result;
+        result.fullResponse = "cancelled";
+        for (Done& done : callbacks) {
+            done(result);
+        }
+    });
+}
+
+void CommandPipeline::pump()
+{
+    for (auto it = queue_.begin(); it != queue_.end();) {
+        if (static_cast<int>(inFlightByKey_.size()) >= config_.maxInFlight) {
+            break;
+        }
+        // Keep per-key ordering: a later command for a busy key waits its turn
+        if (inFlightByKey_.count(keyFor(*it))) {
+            ++it;
+            continue;
+        }
+        Request request = std::move(*it);
+        it = queue_.erase(it);
+        dispatch(std::move(request));
+    }
+}
+
+void CommandPipeline::dispatch(Request request)
+{
+    const Key key = keyFor(request);
+    const std::uint64_t id = request.id;
+    const bool isMotion = request.kind != CommandKind::System;
+
+    auto timer = std::make_shared<boost::asio::steady_timer>(ioContext_);
+    timer->expires_after(isMotion ? config_.motionTimeout : config_.commandTimeout);
+    std::weak_ptr<CommandPipeline> weakSelf = shared_from_this();
+    timer->async_wait([weakSelf, key, id](const boost::system::error_code& ec) {
+        if (ec) return;
+        if (auto self = weakSelf.lock()) {
+            CommandResult result;
+            result.fullResponse = "timeout";
+            result.timedOut = true;
+            result.receivedNs = monotonicNs();
+            self->finish(key, id, result);
+        }
+    });
+
+    const int axisNo = request.axisNo;
+    const CommandKind kind = request.kind;
+    const int pulse = request.pulse;
+    const int speed = request.speed;
+    const int systemNo = request.systemNo;
+    const int value = request.value;
+
+    inFlightByKey_[key] = InFlight{std::move(request), timer, monotonicNs()};
+    inFlight_.store(static_cast<int>(inFlightByKey_.size()), std::memory_order_relaxed);
+    if (dispatchHook_) {
+        dispatchHook_(axisNo, kind);
+    }
+
+    // Responses are matched back by key and request id; a late reply to a
+    // request that already timed out only frees its key in finish().
+    auto callback = [&ioContext = ioContext_, weakSelf, key, id](const ProtocolResponse& resp) {
+        CommandResult result;
+        result.status = resp.status;
+        result.fullResponse = resp.fullResponse;
+        result.receivedNs = monotonicNs();
+        boost::asio::post(ioContext, [weakSelf, key, id, result]() {
+            if (auto self = weakSelf.lock()) {
+                self->finish(key, id, result);
+            }
+        });
+    };
+
+    try {
+        switch (kind) {
+        case CommandKind::MoveAbsolute:
+            controller_->moveAbsolute(axisNo, pulse, speed, 0, callback);
+            break;
+        case CommandKind::MoveRelative:
+            controller_->moveRelative(axisNo, pulse, speed, 0, callback);
+            break;
+        case CommandKind::Origin:
+            controller_->moveOrigin(axisNo, speed, 0, callback);
+            break;
+        case CommandKind::System:
+            controller_->setSystem(axisNo, systemNo, value, callback);
+            break;
+        }
+    } catch (const std::exception& e) {
+        spdlog::error("Failed to send command for axis {}: {}", axisNo, e.what());
+        CommandResult result;
+        result.fullResponse = e.what();
+        // Deferred: we are still inside pump()'s walk over the queue
+        boost::asio::post(ioContext_, [weakSelf, key, id, result]() {
+            if (auto self = weakSelf.lock()) {
+                self->finish(key, id, result);
+            }
+        });
+    }
+}
+
+void CommandPipeline::finish(const Key& key, std::uint64_t id, CommandResult result)
+{
+    auto it = inFlightByKey_.find(key);
+    if (it == inFlightByKey_.end() || it->second.request.id != id) {
+        return;
+    }
+    InFlight& inFlight = it->second;
+    if (inFlight.timedOut) {
+        // The late reply of a timed-out command: the controller is done with it,
+        // so the next command of the key may go out now
+        inFlightByKey_.erase(it);
+        inFlight_.store(static_cast<int>(inFlightByKey_.size()), std::memory_order_relaxed);
+        pump();
+        return;
+    }
+
+    inFlight.timer->cancel();
+    Done done = take(inFlight.request);
+    result.sentNs = inFlight.sentNs;
+    release(key.first, 1);
+    if (result.timedOut) {
+        // The controller may still be executing it. Its key stays blocked until
+        // the reply arrives or the link is reset (cancelAll), so that reply can
+        // never be matched to the next command of the axis.
+        inFlight.timedOut = true;
+    } else {
+        inFlightByKey_.erase(it);
+        inFlight_.store(static_cast<int>(inFlightByKey_.size()), std::memory_order_relaxed);
+    }
+
+    done(result);
+    pump();
+}
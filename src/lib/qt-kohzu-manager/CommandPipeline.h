@@ -0,0 +1,191 @@
+#ifndef COMMANDPIPELINE_H
+#define COMMANDPIPELINE_H
+
+#include <boost/asio.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+class CommandMetrics;
+class KohzuController;
+
+// 파이프라인 설정
+struct PipelineConfig {
+    int maxInFlight = 8;                                // 동시에 응답을 기다리는 명령 수 (1 = 기존 직렬 동작)
+    int maxQueued = 256;                                // 대기열 한도, 초과 시 submit 거부
+    int maxQueuedPerAxis = 4;                           // Coalesce 명령: 축별 대기+전송 중 한도
+    std::chrono::milliseconds commandTimeout{2000};     // setSystem 등 즉시 응답 명령
+    std::chrono::milliseconds motionTimeout{120000};    // 이동 완료까지 응답이 오지 않는 명령
+};
+
+enum class CommandKind { MoveAbsolute, MoveRelative, Origin, System };
+
+// 대기 중인 명령 병합 정책
+enum class QueuePolicy {
+    Keep,       // 제출된 그대로 모두 실행 (시퀀스, 스캔)
+    Coalesce    // 사용자/자동화 입력: 아직 전송되지 않은 같은 축 이동과 병합·대체
+};
+
+struct CommandResult {
+    char status = 'E';
+    std::string fullResponse;
+    bool timedOut = false;
+    bool superseded = false;       // replaced by a newer move before it was sent
+    bool merged = false;           // folded into a later queued move; that move's result is reported once, to its caller
+    std::int64_t sentNs = 0;       // steady_clock time the command went to the controller (0 = never sent)
+    std::int64_t receivedNs = 0;   // steady_clock time the reply (or timeout) arrived on the io thread
+};
+
+// Keeps several controller commands outstanding at once instead of one
+// request/response round trip at a time.
+//
+// Commands are keyed by (axis, motion|system). Only one command per key is in
+// flight so a response can always be matched to its callback by axis and
+// command; other keys proceed in parallel up to maxInFlight. Each in-flight
+// command has its own timeout, and submit() refuses work once maxQueued
+// commands are waiting. A command that timed out is reported to its caller
+// but keeps its key until its late reply arrives or cancelAll() resets the
+// link, since the controller may still be executing it. All bookkeeping
+// happens on the io thread.
+//
+// Moves submitted with QueuePolicy::Coalesce are folded into a queued,
+// not yet sent Coalesce move of the same axis: relative moves at the same
+// speed add up into one command, and an absolute move replaces whatever
+// was queued (its callback reports "superseded"); a relative move after a
+// queued absolute one shifts its target. The callback of the newest merged
+// move gets the result of the command that ran; the earlier ones get a copy
+// flagged `merged`, so per-command bookkeeping happens once. Such moves are
+// also refused once their axis has maxQueuedPerAxis commands outstanding, so
+// clicks and automation input cannot build up a backlog.
+//
+// Monitoring reads (RDP/STR) do not pass through this window: they come from
+// KohzuController's own monitor loop, bounded per tick by
+// MonitoringConfig::maxQueriesPerTick. That relies on the protocol layer
+// accepting several outstanding requests on one connection, so up to
+// maxInFlight + maxQueriesPerTick requests can be unanswered at once. Every
+// reply echoes its command and axis ("C\tAPS1..."), which is what
+// ProtocolHandler matches on, and no poll shares a key with a pipelined
+// command. CommandPipelineTest::monitoringReadsShareTheLink checks this
+// against the simulator.
+//
+// Once its connection is retired the pipeline is closed: everything pending
+// fails with "cancelled" and later submits are refused.
+class CommandPipeline : public std::enable_shared_from_this<CommandPipeline>
+{
+public:
+    using Callback = std::function<void(const CommandResult&)>;
+    // A completion owned by the pipeline and called exactly once. Callers that
+    // allocate per command anyway (coroutine handlers) keep their handler in a
+    // subclass, so the command costs that one allocation and no std::function.
+    class Completion {
+    public:
+        virtual ~Completion() = default;
+        virtual void complete(const CommandResult& result) = 0;
+    };
+    // Called on the io thread whenever a command goes to the controller
+    using DispatchHook = std::function<void(int axisNo, CommandKind kind)>;
+    static constexpr int kMaxAxes = 32;
+    static constexpr int kSpeedTables = 10;   // speed table numbers 0 .. kSpeedTables - 1
+
+    CommandPipeline(boost::asio::io_context& ioContext, std::shared_ptr<KohzuController> controller,
+                    PipelineConfig config = {}, std::shared_ptr<CommandMetrics> metrics = nullptr);
+
+    // Thread-safe. Returns false (and never calls the callback) when the queue is full.
+    // owner only tags the command for cancelQueuedForAxis.
+    bool submit(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value, Callback callback,
+                QueuePolicy policy = QueuePolicy::Keep, const void* owner = nullptr);
+    // QueuePolicy::Keep. A refused command is completed at once, on the calling
+    // thread, with status 'E' and the reason.
+    bool submit(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value,
+                std::unique_ptr<Completion> completion, const void* owner = nullptr);
+    // Set before the first submit
+    void setDispatchHook(DispatchHook hook) { dispatchHook_ = std::move(hook); }
+
+    void setConfig(const PipelineConfig& config);
+    // Fails every queued and in-flight command with "cancelled", e.g. when the link is dropped
+    void cancelAll();
+    // cancelAll() for good: every later submit is refused. Thread-safe.
+    void close();
+    bool isClosed() const { return closed_.load(std::memory_order_acquire); }
+    // Fails the queued (not yet sent) commands of one axis with "cancelled";
+    // with an owner, only the ones submitted with it
+    void cancelQueuedForAxis(int axisNo, const void* owner = nullptr);
+    int pendingCount() const { return pending_.load(std::memory_order_relaxed); }
+    int inFlightCount() const { return inFlight_.load(std::memory_order_relaxed); }
+    // Queued + in flight for one axis (1-32)
+    int pendingCountForAxis(int axisNo) const;
+
+private:
+    using Key = std::pair<int, bool>;   // (axisNo, isMotion)
+
+    struct Request {
+        std::uint64_t id = 0;
+        int axisNo = 0;
+        CommandKind kind = CommandKind::System;
+        int pulse = 0;
+        int speed = 0;
+        int systemNo = 0;
+        int value = 0;
+        QueuePolicy policy = QueuePolicy::Keep;
+        const void* owner = nullptr;
+        Callback callback;
+        std::unique_ptr<Completion> completion;   // instead of callback
+    };
+
+    // Whichever of a request's two completion forms is set, moved out of it
+    struct Done {
+        Callback callback;
+        std::unique_ptr<Completion> completion;
+
+        void operator()(const CommandResult& result)
+        {
+            if (completion) completion->complete(result);
+            else if (callback) callback(result);
+        }
+    };
+    static Done take(Request& request) { return {std::move(request.callback), std::move(request.completion)}; }
+
+    struct InFlight {
+        Request request;
+        std::shared_ptr<boost::asio::steady_timer> timer;
+        std::int64_t sentNs = 0;
+        bool timedOut = false;   // caller answered; only waiting for the late reply
+    };
+
+    static Key keyFor(const Request& request) { return {request.axisNo, request.kind != CommandKind::System}; }
+
+    bool submitRequest(Request& request);
+    void enqueue(Request request);
+    bool coalesce(Request& queued, Request& request);
+    void release(int axisNo, int count);
+    void pump();
+    void dispatch(Request request);
+    void finish(const Key& key, std::uint64_t id, CommandResult result);
+
+    boost::asio::io_context& ioContext_;
+    std::shared_ptr<KohzuController> controller_;
+    std::shared_ptr<CommandMetrics> metrics_;   // optional: merged and superseded moves
+    DispatchHook dispatchHook_;
+
+    std::atomic<int> pending_{0};      // queued + in flight, readable from any thread
+    std::atomic<int> inFlight_{0};
+    std::atomic<bool> closed_{false};
+    std::atomic<int> maxQueued_;
+    std::atomic<int> maxQueuedPerAxis_;
+    std::array<std::atomic<int>, kMaxAxes + 1> axisPending_{};   // indexed by axis number
+
+    // io thread only
+    PipelineConfig config_;
+    std::uint64_t nextId_ = 1;
+    std::deque<Request> queue_;
+    std::map<Key, InFlight> inFlightByKey_;
+};
+
+#endif // COMMANDPIPELINE_H
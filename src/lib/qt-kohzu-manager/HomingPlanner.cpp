@@ -0,0 +1,288 @@
+#include "HomingPlanner.h"
+#include "AxisSnapshot.h"
+#include "CommandPipeline.h"
+#include "LatencyHistogram.h"
+#include "MonitoringScheduler.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <cstdio>
+#include <set>
+
+namespace {
+
+// Retry interval when the pipeline is full of commands that are not ours
+constexpr std::chrono::milliseconds kQueueRetry{10};
+
+std::string seconds(std::int64_t ns)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.1f s", double(ns) / 1e9);
+    return text;
+}
+
+} // namespace
+
+HomingPlanner::HomingPlanner(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+                             std::shared_ptr<MonitoringScheduler> scheduler)
+    : ioContext_(ioContext), pipeline_(std::move(pipeline)), scheduler_(std::move(scheduler)), timer_(ioContext)
+{
+}
+
+bool HomingPlanner::validate(const HomingPlan& plan, std::string& error)
+{
+    if (plan.axes.empty()) {
+        error = "no axes to home";
+        return false;
+    }
+    std::map<int, const HomingAxis*> byAxis;
+    for (const HomingAxis& axis : plan.axes) {
+        if (axis.axisNo < 1 || axis.axisNo > AxisStateSnapshot::kMaxAxes) {
+            error = "invalid axis number " + std::to_string(axis.axisNo);
+            return false;
+        }
+        if (axis.speed < 0 || axis.speed >= CommandPipeline::kSpeedTables) {
+            error = "axis " + std::to_string(axis.axisNo) + ": speed must be 0-"
+                    + std::to_string(CommandPipeline::kSpeedTables - 1);
+            return false;
+        }
+        if (!byAxis.emplace(axis.axisNo, &axis).second) {
+            error = "axis " + std::to_string(axis.axisNo) + " is listed twice";
+            return false;
+        }
+    }
+    for (const HomingAxis& axis : plan.axes) {
+        for (int before : axis.after) {
+            if (!byAxis.count(before)) {
+                error = "axis " + std::to_string(axis.axisNo) + " waits for axis " + std::to_string(before)
+                        + ", which is not being homed";
+                return false;
+            }
+        }
+    }
+
+    // Kahn's algorithm: whatever cannot be ordered sits on a cycle
+    std::map<int, int> waitingOn;
+    std::map<int, std::vector<int>> dependents;
+    for (const HomingAxis& axis : plan.axes) {
+        const std::set<int> distinct(axis.after.begin(), axis.after.end());
+        waitingOn[axis.axisNo] = int(distinct.size());
+        for (int before : distinct) dependents[before].push_back(axis.axisNo);
+    }
+    std::vector<int> ready;
+    for (const auto& [axisNo, count] : waitingOn) {
+        if (count == 0) ready.push_back(axisNo);
+    }
+    std::size_t ordered = 0;
+    while (!ready.empty()) {
+        const int axisNo = ready.back();
+        ready.pop_back();
+        ++ordered;
+        for (int next : dependents[axisNo]) {
+            if (--waitingOn[next] == 0) ready.push_back(next);
+        }
+    }
+    if (ordered != plan.axes.size()) {
+        std::string cycle;
+        for (const auto& [axisNo, count] : waitingOn) {
+            if (count > 0) cycle += (cycle.empty() ? "" : ", ") + std::to_string(axisNo);
+        }
+        error = "dependency cycle among axes " + cycle;
+        return false;
+    }
+    return true;
+}
+
+bool HomingPlanner::parseDependencies(const QByteArray& json, std::map<int, std::vector<int>>& after, QString& error)
+{
+    after.clear();
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        error = QString("offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+        return false;
+    }
+    const QJsonObject dependencies = doc.object()["after"].toObject();
+    for (auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+        bool ok = false;
+        const int axisNo = it.key().toInt(&ok);
+        if (!ok || axisNo < 1 || axisNo > AxisStateSnapshot::kMaxAxes) {
+            error = QString("after: invalid axis number \"%1\"").arg(it.key());
+            return false;
+        }
+        if (!it.value().isArray()) {
+            error = QString("after.%1: expected a list of axes").arg(it.key());
+            return false;
+        }
+        std::vector<int>& before = after[axisNo];
+        for (const QJsonValue& item : it.value().toArray()) {
+            const int beforeNo = item.toInt(0);
+            if (beforeNo < 1 || beforeNo > AxisStateSnapshot::kMaxAxes) {
+                error = QString("after.%1: invalid axis number").arg(it.key());
+                return false;
+            }
+            before.push_back(beforeNo);
+        }
+    }
+    return true;
+}
+
+bool HomingPlanner::loadDependencies(const QString& filePath, std::map<int, std::vector<int>>& after, QString& error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+    return parseDependencies(file.readAll(), after, error);
+}
+
+void HomingPlanner::start(HomingPlan plan, AxisSink onAxisFinished, FinishedSink onFinished)
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, plan = std::move(plan), onAxisFinished = std::move(onAxisFinished),
+                                   onFinished = std::move(onFinished)]() mutable {
+        if (self->running_) {
+            self->finish(false, "superseded by a new homing run");
+        }
+
+        std::map<int, int> indexOf;
+        self->nodes_.assign(plan.axes.size(), Node());
+        for (std::size_t i = 0; i < plan.axes.size(); ++i) {
+            self->nodes_[i].axis = plan.axes[i];
+            indexOf[plan.axes[i].axisNo] = int(i);
+        }
+        for (std::size_t i = 0; i < plan.axes.size(); ++i) {
+            const std::set<int> distinct(plan.axes[i].after.begin(), plan.axes[i].after.end());
+            for (int before : distinct) {
+                self->nodes_[indexOf[before]].dependents.push_back(int(i));
+                ++self->nodes_[i].waitingOn;
+            }
+        }
+
+        self->onAxisFinished_ = std::move(onAxisFinished);
+        self->onFinished_ = std::move(onFinished);
+        self->outstanding_ = 0;
+        self->remaining_ = int(self->nodes_.size());
+        self->startNs_ = monotonicNs();
+        self->serialNs_ = 0;
+        ++self->generation_;
+        self->running_ = true;
+        self->launchReady();
+    });
+}
+
+void HomingPlanner::abort()
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self]() {
+        if (self->running_) {
+            self->finish(false, "aborted");
+        }
+    });
+}
+
+void HomingPlanner::launchReady()
+{
+    for (std::size_t i = 0; i < nodes_.size() && running_; ++i) {
+        Node& node = nodes_[i];
+        if (node.submitted || node.waitingOn > 0) continue;
+
+        const int index = int(i);
+        const int axisNo = node.axis.axisNo;
+        const std::uint64_t generation = generation_;
+        std::weak_ptr<HomingPlanner> weakSelf = shared_from_this();
+        auto scheduler = scheduler_;
+
+        // Keep: an origin return must never be folded into another move
+        const bool accepted = pipeline_->submit(axisNo, CommandKind::Origin, 0, node.axis.speed, 0, 0,
+            [weakSelf, scheduler, axisNo, index, generation](const CommandResult& result) {
+                if (result.sentNs != 0) {
+                    scheduler->notifyCommandFinished(axisNo);
+                }
+                if (auto self = weakSelf.lock()) {
+                    self->onAxisDone(generation, index, result.status, result.fullResponse,
+                                     result.sentNs, result.receivedNs);
+                }
+            }, QueuePolicy::Keep, this);
+        if (!accepted) {
+            // Resumed by our next completion, or by a timer if none is outstanding
+            if (outstanding_ == 0) {
+                timer_.expires_after(kQueueRetry);
+                timer_.async_wait([weakSelf, generation](const boost::system::error_code& ec) {
+                    auto self = weakSelf.lock();
+                    if (!ec && self && self->running_ && self->generation_ == generation) {
+                        self->launchReady();
+                    }
+                });
+            }
+            return;
+        }
+        node.submitted = true;
+        ++outstanding_;
+    }
+}
+
+void HomingPlanner::onAxisDone(std::uint64_t generation, int index, char status, const std::string& response,
+                               std::int64_t sentNs, std::int64_t receivedNs)
+{
+    if (generation != generation_) {
+        return;
+    }
+    --outstanding_;
+    if (!running_) {
+        return;
+    }
+
+    Node& node = nodes_[index];
+    node.done = true;
+    HomingAxisResult result;
+    result.axisNo = node.axis.axisNo;
+    result.success = status == 'C';
+    result.startedNs = sentNs;
+    result.finishedNs = receivedNs;
+    if (onAxisFinished_) onAxisFinished_(result);
+
+    if (!result.success) {
+        finish(false, "axis " + std::to_string(result.axisNo) + " origin return failed: " + response);
+        return;
+    }
+    if (sentNs != 0) serialNs_ += receivedNs - sentNs;
+    for (int next : node.dependents) {
+        --nodes_[next].waitingOn;
+    }
+    if (--remaining_ == 0) {
+        finish(true, std::to_string(nodes_.size()) + " axes home in " + seconds(monotonicNs() - startNs_)
+                     + " (one at a time: " + seconds(serialNs_) + ")");
+        return;
+    }
+    launchReady();
+}
+
+void HomingPlanner::finish(bool completed, const std::string& message)
+{
+    running_ = false;
+    timer_.cancel();
+    if (!completed) {
+        // Origin returns already sent run to completion; our queued ones are
+        // dropped, commands others queued for these axes stay
+        for (const Node& node : nodes_) {
+            if (node.submitted && !node.done) {
+                pipeline_->cancelQueuedForAxis(node.axis.axisNo, this);
+            }
+        }
+    }
+    ++generation_;
+    outstanding_ = 0;
+    const std::int64_t elapsedNs = monotonicNs() - startNs_;
+    nodes_.clear();
+
+    FinishedSink onFinished = std::move(onFinished_);
+    onAxisFinished_ = nullptr;
+    onFinished_ = nullptr;
+    if (onFinished) {
+        onFinished(completed, message, elapsedNs);
+    }
+}
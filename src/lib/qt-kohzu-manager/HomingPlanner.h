@@ -0,0 +1,107 @@
+#ifndef HOMINGPLANNER_H
+#define HOMINGPLANNER_H
+
+#include <QByteArray>
+#include <QString>
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CommandPipeline;
+class MonitoringScheduler;
+
+// 원점 복귀 대상 축
+struct HomingAxis {
+    int axisNo = 1;
+    int speed = 9;              // 속도 테이블 번호 (0 ~ CommandPipeline::kSpeedTables - 1)
+    std::vector<int> after;     // 이 축들의 원점 복귀가 끝난 뒤에 시작 (예: Z 먼저, 그다음 X/Y)
+};
+
+// 원점 복귀 계획: 의존성이 없는 축은 동시에 시작
+struct HomingPlan {
+    std::vector<HomingAxis> axes;
+};
+
+// 축 하나의 원점 복귀 결과
+struct HomingAxisResult {
+    int axisNo = 0;
+    bool success = false;
+    std::int64_t startedNs = 0;     // steady_clock 기준 전송 시각 (0 = 전송되지 않음)
+    std::int64_t finishedNs = 0;    // 완료 응답 시각
+};
+
+// Runs a multi-axis origin return on the io thread.
+//
+// The plan is a dependency graph: every axis whose prerequisites have
+// finished is sent its origin command at once, and each completion, seen
+// on the io thread through the same pipeline callback that moves the axis
+// back to settling polling, releases the axes waiting on it. Total time is
+// therefore the longest chain of the graph rather than the sum of all axes.
+//
+// An axis counts as home on the controller's ORG reply rather than on a
+// monitoring sample: the controller answers a motion command only once the
+// motion has ended (hence PipelineConfig::motionTimeout), and the status in
+// the snapshot is the scheduler's mode, itself switched by that same reply.
+// Waiting for the next settling poll would add up to a polling period per
+// axis on the critical path and tell nothing new.
+// A failed axis stops the run; origin returns already under way finish on
+// their own, the planner's queued ones are dropped and other commands queued
+// for the same axes are left alone.
+class HomingPlanner : public std::enable_shared_from_this<HomingPlanner>
+{
+public:
+    using AxisSink = std::function<void(const HomingAxisResult& result)>;
+    using FinishedSink = std::function<void(bool completed, const std::string& message, std::int64_t elapsedNs)>;
+
+    HomingPlanner(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+                  std::shared_ptr<MonitoringScheduler> scheduler);
+
+    // Checks axis numbers, speeds, duplicates, dependencies on axes outside
+    // the plan and cycles; on failure returns false with a reason.
+    static bool validate(const HomingPlan& plan, std::string& error);
+
+    // Reads the dependency part of a plan: {"after": {"1": [3], "2": [3]}}
+    // means axes 1 and 2 start once axis 3 is home.
+    static bool parseDependencies(const QByteArray& json, std::map<int, std::vector<int>>& after, QString& error);
+    static bool loadDependencies(const QString& filePath, std::map<int, std::vector<int>>& after, QString& error);
+
+    // Thread-safe. A homing run already in progress is aborted first.
+    void start(HomingPlan plan, AxisSink onAxisFinished, FinishedSink onFinished);
+    void abort();
+
+private:
+    struct Node {
+        HomingAxis axis;
+        int waitingOn = 0;              // prerequisites not yet home
+        std::vector<int> dependents;    // indices into nodes_
+        bool submitted = false;
+        bool done = false;
+    };
+
+    void launchReady();
+    void onAxisDone(std::uint64_t generation, int index, char status, const std::string& response,
+                    std::int64_t sentNs, std::int64_t receivedNs);
+    void finish(bool completed, const std::string& message);
+
+    boost::asio::io_context& ioContext_;
+    std::shared_ptr<CommandPipeline> pipeline_;
+    std::shared_ptr<MonitoringScheduler> scheduler_;
+    boost::asio::steady_timer timer_;
+
+    // io thread only
+    std::vector<Node> nodes_;
+    int outstanding_ = 0;
+    int remaining_ = 0;
+    std::int64_t startNs_ = 0;
+    std::int64_t serialNs_ = 0;     // sum of the per-axis times, for the report
+    std::uint64_t generation_ = 0;
+    bool running_ = false;
+    AxisSink onAxisFinished_;
+    FinishedSink onFinished_;
+};
+
+#endif // HOMINGPLANNER_H
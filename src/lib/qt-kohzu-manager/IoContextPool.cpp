@@ -0,0 +1,100 @@
+#include "IoContextPool.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+
+IoContextPool::IoContextPool(int threadCount)
+{
+    const int count = std::max(1, threadCount);
+    workers_.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : workers_) {
+        worker->thread = std::thread([this, worker = worker.get()]() {
+            boost::asio::io_context& context = worker->context;
+            boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard(context.get_executor());
+            for (;;) {
+                try {
+                    context.run();
+                    return;
+                } catch (const std::exception& e) {
+                    // Other connections share this thread; keep it alive and let
+                    // every connection pinned here treat it as a dropped link
+                    spdlog::error("io_context pool exception: {}", e.what());
+                    notifyFailure(*worker, e.what());
+                }
+            }
+        });
+    }
+}
+
+IoContextPool::~IoContextPool()
+{
+    stop();
+}
+
+int IoContextPool::defaultThreadCount()
+{
+    const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(hardware / 2, 1, 4);
+}
+
+boost::asio::io_context &IoContextPool::acquire(const void *owner, FailureHandler onFailure)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto least = std::min_element(workers_.begin(), workers_.end(), [](const auto& a, const auto& b) {
+        return a->users.size() < b->users.size();
+    });
+    (*least)->users.emplace_back(owner, std::move(onFailure));
+    return (*least)->context;
+}
+
+void IoContextPool::release(boost::asio::io_context &context, const void *owner)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& worker : workers_) {
+        if (&worker->context != &context) continue;
+        auto& users = worker->users;
+        users.erase(std::remove_if(users.begin(), users.end(), [owner](const auto& user) {
+            return user.first == owner;
+        }), users.end());
+        return;
+    }
+}
+
+void IoContextPool::notifyFailure(Worker &worker, const std::string &what)
+{
+    std::vector<FailureHandler> handlers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& user : worker.users) {
+            if (user.second) handlers.push_back(user.second);
+        }
+    }
+    for (const auto& handler : handlers) {
+        handler(what);
+    }
+}
+
+void IoContextPool::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    for (auto& worker : workers_) {
+        worker->context.stop();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool IoContextPool::isRunning() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
@@ -0,0 +1,74 @@
+#ifndef IOCONTEXTPOOL_H
+#define IOCONTEXTPOOL_H
+
+#include <boost/asio.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A small, fixed set of io threads shared by many controller connections.
+//
+// Each thread runs its own io_context and every connection is pinned to one
+// of them for its whole life, so the handlers of one connection never run
+// concurrently and stay in order, exactly as with a private io thread, while
+// N controllers need only threadCount() threads. Connections go to the
+// context with the fewest users.
+//
+// A handler that throws cannot be traced back to its connection, so every
+// user of that thread is told through its failure handler and the thread
+// keeps running.
+class IoContextPool
+{
+public:
+    // Called on the pool thread that caught the exception
+    using FailureHandler = std::function<void(const std::string& what)>;
+
+    explicit IoContextPool(int threadCount = defaultThreadCount());
+    ~IoContextPool();
+
+    IoContextPool(const IoContextPool&) = delete;
+    IoContextPool& operator=(const IoContextPool&) = delete;
+
+    static int defaultThreadCount();
+
+    // owner identifies the user again in release()
+    boost::asio::io_context& acquire(const void* owner, FailureHandler onFailure);
+    void release(boost::asio::io_context& context, const void* owner);
+
+    // Posts to a context of this pool unless stop() has begun; returns false
+    // without taking the handler in that case so the caller can run it itself.
+    template <typename Handler>
+    bool post(boost::asio::io_context& context, Handler&& handler)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return false;
+        boost::asio::post(context, std::forward<Handler>(handler));
+        return true;
+    }
+
+    // Stops every context and joins the threads; handlers still queued are
+    // dropped. Call it from the thread that owns the connections, so none of
+    // them can post in the middle of the shutdown.
+    void stop();
+    bool isRunning() const;
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+
+private:
+    struct Worker {
+        boost::asio::io_context context;
+        std::thread thread;
+        std::vector<std::pair<const void*, FailureHandler>> users;
+    };
+
+    void notifyFailure(Worker& worker, const std::string& what);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    mutable std::mutex mutex_;
+    bool running_ = true;
+};
+
+#endif // IOCONTEXTPOOL_H
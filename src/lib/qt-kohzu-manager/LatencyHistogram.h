@@ -0,0 +1,131 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// steady_clock time in nanoseconds, the time base of every metric and sample timestamp
+inline std::int64_t monotonicNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Lock-free log-linear latency histogram in the style of HdrHistogram.
+//
+// Values are nanoseconds. Every power of two is split into 16 linear
+// sub-buckets, so a value is reported to within about 6% from 1 ns up to
+// ~70 minutes. record() is a handful of relaxed atomic operations and may run
+// on any thread; readers take a snapshot.
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxBit = 41;
+    static constexpr int kBucketCount = (kMaxBit - kSubBucketBits + 1) * kSubBuckets + kSubBuckets;
+
+    struct Snapshot {
+        std::array<std::uint64_t, kBucketCount> counts{};
+        std::uint64_t count = 0;
+        std::int64_t sumNs = 0;
+        std::int64_t maxNs = 0;
+
+        // Upper bound of the bucket holding the p-th value (0..1), capped at the maximum
+        std::int64_t percentile(double p) const
+        {
+            if (count == 0) return 0;
+            const std::uint64_t rank = p <= 0.0 ? 1 : static_cast<std::uint64_t>(p * count + 0.999999);
+            std::uint64_t seen = 0;
+            for (int i = 0; i < kBucketCount; ++i) {
+                seen += counts[i];
+                if (seen >= rank) {
+                    const std::int64_t upper = bucketUpperBound(i);
+                    return upper < maxNs ? upper : maxNs;
+                }
+            }
+            return maxNs;
+        }
+
+        // Values recorded in buckets that lie entirely at or below the bound
+        std::uint64_t countAtOrBelow(std::int64_t boundNs) const
+        {
+            std::uint64_t total = 0;
+            for (int i = 0; i < kBucketCount && bucketUpperBound(i) <= boundNs; ++i) {
+                total += counts[i];
+            }
+            return total;
+        }
+
+        void merge(const Snapshot& other)
+        {
+            for (int i = 0; i < kBucketCount; ++i) counts[i] += other.counts[i];
+            count += other.count;
+            sumNs += other.sumNs;
+            if (other.maxNs > maxNs) maxNs = other.maxNs;
+        }
+    };
+
+    void record(std::int64_t valueNs)
+    {
+        if (valueNs < 0) valueNs = 0;
+        counts_[bucketIndex(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sumNs_.fetch_add(valueNs, std::memory_order_relaxed);
+        std::int64_t max = maxNs_.load(std::memory_order_relaxed);
+        while (valueNs > max && !maxNs_.compare_exchange_weak(max, valueNs, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Not an atomic cut across buckets; good enough for monitoring
+    Snapshot snapshot() const
+    {
+        Snapshot snapshot;
+        for (int i = 0; i < kBucketCount; ++i) {
+            snapshot.counts[i] = counts_[i].load(std::memory_order_relaxed);
+        }
+        snapshot.count = count_.load(std::memory_order_relaxed);
+        snapshot.sumNs = sumNs_.load(std::memory_order_relaxed);
+        snapshot.maxNs = maxNs_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    static int bucketIndex(std::int64_t valueNs)
+    {
+        constexpr std::uint64_t kLargest = (std::uint64_t(1) << (kMaxBit + 1)) - 1;
+        std::uint64_t value = static_cast<std::uint64_t>(valueNs);
+        if (value > kLargest) value = kLargest;
+        const int bit = highestBit(value);
+        const int shift = bit > kSubBucketBits ? bit - kSubBucketBits : 0;
+        return (shift << kSubBucketBits) + static_cast<int>(value >> shift);
+    }
+
+    static std::int64_t bucketUpperBound(int index)
+    {
+        const int shift = index >= 2 * kSubBuckets ? (index >> kSubBucketBits) - 1 : 0;
+        const std::int64_t top = index - (shift << kSubBucketBits);
+        return ((top + 1) << shift) - 1;
+    }
+
+private:
+    static int highestBit(std::uint64_t value)
+    {
+        int bit = 0;
+        for (int step = 32; step > 0; step >>= 1) {
+            if (value >> step) {
+                value >>= step;
+                bit += step;
+            }
+        }
+        return bit;
+    }
+
+    std::array<std::atomic<std::uint64_t>, kBucketCount> counts_{};
+    std::atomic<std::uint64_t> count_{0};
+    std::atomic<std::int64_t> sumNs_{0};
+    std::atomic<std::int64_t> maxNs_{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
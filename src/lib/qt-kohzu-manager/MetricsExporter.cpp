@@ -0,0 +1,174 @@
+#include "MetricsExporter.h"
+#include "QtKohzuManager.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimer>
+
+namespace {
+
+// Upper bounds in seconds, covering command queue waits up to long motions
+constexpr double kBucketBounds[] = {0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+                                    0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0, 60.0, 120.0};
+
+constexpr CommandKind kKinds[] = {CommandKind::MoveAbsolute, CommandKind::MoveRelative, CommandKind::Origin,
+                                  CommandKind::System};
+constexpr LatencyStage kStages[] = {LatencyStage::Queue, LatencyStage::RoundTrip, LatencyStage::Delivery,
+                                    LatencyStage::Total};
+
+QByteArray seconds(double value)
+{
+    return QByteArray::number(value, 'g', 9);
+}
+
+void header(QByteArray& out, const char* name, const char* type, const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+// One histogram series; labels is either empty or `key="value",...` without braces
+void histogram(QByteArray& out, const char* name, const QByteArray& labels, const LatencyHistogram::Snapshot& snapshot)
+{
+    const QByteArray prefix = labels.isEmpty() ? QByteArray() : labels + ',';
+    for (double bound : kBucketBounds) {
+        const auto boundNs = static_cast<std::int64_t>(bound * 1e9);
+        out += name;
+        out += "_bucket{" + prefix + "le=\"" + seconds(bound) + "\"} ";
+        out += QByteArray::number(static_cast<qulonglong>(snapshot.countAtOrBelow(boundNs)));
+        out += '\n';
+    }
+    out += name;
+    out += "_bucket{" + prefix + "le=\"+Inf\"} " + QByteArray::number(static_cast<qulonglong>(snapshot.count)) + '\n';
+
+    const QByteArray braces = labels.isEmpty() ? QByteArray() : '{' + labels + '}';
+    out += name;
+    out += "_sum" + braces + ' ' + seconds(snapshot.sumNs / 1e9) + '\n';
+    out += name;
+    out += "_count" + braces + ' ' + QByteArray::number(static_cast<qulonglong>(snapshot.count)) + '\n';
+}
+
+void sample(QByteArray& out, const char* name, const QByteArray& labels, qulonglong value)
+{
+    out += name;
+    if (!labels.isEmpty()) out += '{' + labels + '}';
+    out += ' ' + QByteArray::number(value) + '\n';
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(QtKohzuManager *manager, QObject *parent)
+    : QObject(parent), manager_(manager)
+{
+    writer_.setMaxThreadCount(1);
+    timer_ = new QTimer(this);
+    connect(timer_, &QTimer::timeout, this, &MetricsExporter::writeNow);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    timer_->stop();
+    writer_.waitForDone();
+}
+
+void MetricsExporter::start(const QString &filePath, int intervalMs)
+{
+    filePath_ = filePath;
+    timer_->start(qMax(100, intervalMs));
+    writeNow();
+}
+
+void MetricsExporter::stop()
+{
+    timer_->stop();
+}
+
+QByteArray MetricsExporter::prometheusText() const
+{
+    const auto metrics = manager_->metrics();
+    QByteArray out;
+    out.reserve(64 * 1024);
+
+    header(out, "qtkohzu_command_latency_seconds", "histogram",
+           "Command latency by kind and stage (queue, round_trip, delivery, total).");
+    for (CommandKind kind : kKinds) {
+        for (LatencyStage stage : kStages) {
+            const QByteArray labels = QByteArray("kind=\"") + CommandMetrics::kindName(kind) + "\",stage=\""
+                                      + CommandMetrics::stageName(stage) + '"';
+            histogram(out, "qtkohzu_command_latency_seconds", labels, metrics->latency(kind, stage).snapshot());
+        }
+    }
+
+    header(out, "qtkohzu_axis_command_latency_seconds", "histogram", "Submit-to-delivery command latency per axis.");
+    for (int axisNo = 1; axisNo <= CommandMetrics::kMaxAxes; ++axisNo) {
+        const auto snapshot = metrics->axisLatency(axisNo).snapshot();
+        if (snapshot.count == 0) continue;   // keep the file small: only axes that were driven
+        histogram(out, "qtkohzu_axis_command_latency_seconds", "axis=\"" + QByteArray::number(axisNo) + '"', snapshot);
+    }
+
+    header(out, "qtkohzu_poll_lateness_seconds", "histogram", "How late polled axes were sampled relative to their period.");
+    histogram(out, "qtkohzu_poll_lateness_seconds", QByteArray(), metrics->pollLateness().snapshot());
+
+    header(out, "qtkohzu_commands_total", "counter", "Completed commands by kind and result.");
+    for (CommandKind kind : kKinds) {
+        const QByteArray kindLabel = QByteArray("kind=\"") + CommandMetrics::kindName(kind) + '"';
+        sample(out, "qtkohzu_commands_total", kindLabel + ",result=\"ok\"", metrics->succeeded(kind));
+        sample(out, "qtkohzu_commands_total", kindLabel + ",result=\"error\"", metrics->failed(kind));
+        sample(out, "qtkohzu_commands_total", kindLabel + ",result=\"timeout\"", metrics->timedOut(kind));
+    }
+    header(out, "qtkohzu_commands_rejected_total", "counter", "Commands refused because the queue was full.");
+    sample(out, "qtkohzu_commands_rejected_total", QByteArray(), metrics->rejected());
+    header(out, "qtkohzu_commands_coalesced_total", "counter", "Queued moves merged into another or superseded by a newer target.");
+    sample(out, "qtkohzu_commands_coalesced_total", "action=\"merged\"", metrics->merged());
+    sample(out, "qtkohzu_commands_coalesced_total", "action=\"superseded\"", metrics->superseded());
+    header(out, "qtkohzu_poll_ticks_total", "counter", "Monitoring ticks.");
+    sample(out, "qtkohzu_poll_ticks_total", QByteArray(), metrics->pollTicks());
+    header(out, "qtkohzu_poll_deferred_total", "counter", "Due axes pushed to a later tick by the query budget.");
+    sample(out, "qtkohzu_poll_deferred_total", QByteArray(), metrics->pollDeferred());
+    header(out, "qtkohzu_link_losses_total", "counter", "Connections dropped after being established.");
+    sample(out, "qtkohzu_link_losses_total", QByteArray(), metrics->linkLosses());
+    header(out, "qtkohzu_reconnects_total", "counter", "Successful automatic reconnects.");
+    sample(out, "qtkohzu_reconnects_total", QByteArray(), metrics->reconnects());
+
+    header(out, "qtkohzu_pending_commands", "gauge", "Commands queued or in flight.");
+    sample(out, "qtkohzu_pending_commands", QByteArray(), static_cast<qulonglong>(manager_->pendingCommandCount()));
+    header(out, "qtkohzu_axis_pending_commands", "gauge", "Commands queued or in flight per axis (axes with any).");
+    for (int axisNo = 1; axisNo <= CommandMetrics::kMaxAxes; ++axisNo) {
+        const int axisPending = manager_->pendingCommandCountForAxis(axisNo);
+        if (axisPending == 0) continue;
+        sample(out, "qtkohzu_axis_pending_commands", "axis=\"" + QByteArray::number(axisNo) + '"', static_cast<qulonglong>(axisPending));
+    }
+    header(out, "qtkohzu_inflight_commands", "gauge", "Commands sent and waiting for a reply.");
+    sample(out, "qtkohzu_inflight_commands", QByteArray(), static_cast<qulonglong>(manager_->inFlightCommandCount()));
+    header(out, "qtkohzu_connected", "gauge", "1 while the controller link is up.");
+    sample(out, "qtkohzu_connected", QByteArray(),
+           manager_->connectionState() == QtKohzuManager::ConnectionState::Connected ? 1 : 0);
+    return out;
+}
+
+bool MetricsExporter::writeNow()
+{
+    if (filePath_.isEmpty()) return false;
+    if (writing_.exchange(true, std::memory_order_acq_rel)) return false;
+
+    const QString filePath = filePath_;
+    const QByteArray text = prometheusText();
+    writer_.start([this, filePath, text]() {
+        QDir().mkpath(QFileInfo(filePath).absolutePath());
+        // Scrapers never see a half-written file
+        QSaveFile file(filePath);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(text);
+            file.commit();
+        }
+        writing_.store(false, std::memory_order_release);
+    });
+    return true;
+}
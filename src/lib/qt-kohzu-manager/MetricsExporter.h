@@ -0,0 +1,48 @@
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+
+class QTimer;
+class QtKohzuManager;
+
+// Periodically writes the CommandMetrics of a QtKohzuManager as a Prometheus
+// text-format file (for node_exporter's textfile collector or a plain scrape).
+//
+// Histograms are exported with fixed `le` buckets from 100 us to 120 s; the
+// bucket counts come from the log-linear histograms and are accurate to their
+// ~6% bucket width. The text is collected on the manager's (GUI) thread from
+// atomics only; the file itself is written and synced on a writer thread, and
+// a tick that finds the previous write still busy is skipped.
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsExporter(QtKohzuManager* manager, QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    // Rewrites the file every intervalMs (atomically, via QSaveFile)
+    void start(const QString& filePath, int intervalMs = 5000);
+    void stop();
+    QString filePath() const { return filePath_; }
+
+    QByteArray prometheusText() const;
+
+public slots:
+    // Queues one rewrite; false if no file is set or a write is still running
+    bool writeNow();
+
+private:
+    QtKohzuManager* manager_;
+    QTimer* timer_;
+    QString filePath_;
+    QThreadPool writer_;   // single thread, so rewrites never overtake each other
+    std::atomic<bool> writing_{false};
+};
+
+#endif // METRICSEXPORTER_H
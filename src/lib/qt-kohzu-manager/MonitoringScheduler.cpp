@@ -0,0 +1,175 @@
+#include "MonitoringScheduler.h"
+#include "CommandMetrics.h"
+#include "controller/KohzuController.h"
+#include <algorithm>
+#include <vector>
+
+MonitoringScheduler::MonitoringScheduler(boost::asio::io_context& ioContext, std::shared_ptr<KohzuController> controller,
+                                         std::shared_ptr<AxisSnapshotBuffer> snapshot, MonitoringConfig config,
+                                         std::shared_ptr<CommandMetrics> metrics)
+    : timer_(ioContext), controller_(std::move(controller)), snapshot_(std::move(snapshot)),
+      metrics_(std::move(metrics)), config_(config)
+{
+}
+
+void MonitoringScheduler::start()
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self]() {
+        if (self->running_) return;
+        self->running_ = true;
+        self->scheduleNext();
+    });
+}
+
+void MonitoringScheduler::stop()
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self]() {
+        self->running_ = false;
+        self->timer_.cancel();
+    });
+}
+
+void MonitoringScheduler::setAxes(const std::set<int>& axes)
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self, axes]() {
+        for (int axisNo : axes) {
+            if (!self->trackedAxes_.count(axisNo)) {
+                // Newly tracked axes get one sample right away
+                self->scheduleFor(axisNo).nextDue = Clock::now();
+            }
+        }
+        self->trackedAxes_ = axes;
+    });
+}
+
+void MonitoringScheduler::setConfig(const MonitoringConfig& config)
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self, config]() {
+        self->config_ = config;
+        self->config_.maxQueriesPerTick = std::max(config.maxQueriesPerTick, 1);
+    });
+}
+
+void MonitoringScheduler::notifyCommandIssued(int axisNo)
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self, axisNo]() {
+        AxisSchedule& schedule = self->scheduleFor(axisNo);
+        ++schedule.pendingCommands;
+        self->setMode(axisNo, schedule, AxisMode::Moving);
+        schedule.nextDue = Clock::now();
+    });
+}
+
+void MonitoringScheduler::notifyCommandFinished(int axisNo)
+{
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self, axisNo]() {
+        AxisSchedule& schedule = self->scheduleFor(axisNo);
+        schedule.pendingCommands = std::max(schedule.pendingCommands - 1, 0);
+        if (schedule.pendingCommands == 0) {
+            // Keep sampling for a while so the final position is not lost
+            const auto now = Clock::now();
+            self->setMode(axisNo, schedule, AxisMode::Settling);
+            schedule.settlingUntil = now + self->config_.settlingDuration;
+            schedule.nextDue = now;
+        }
+    });
+}
+
+MonitoringScheduler::AxisSchedule& MonitoringScheduler::scheduleFor(int axisNo)
+{
+    return schedules_[axisNo];
+}
+
+void MonitoringScheduler::setMode(int axisNo, AxisSchedule& schedule, AxisMode mode)
+{
+    schedule.mode = mode;
+
+    AxisMotionStatus status = AxisMotionStatus::Idle;
+    if (mode == AxisMode::Moving) status = AxisMotionStatus::Moving;
+    else if (mode == AxisMode::Settling) status = AxisMotionStatus::Settling;
+
+    snapshot_->beginWrite();
+    snapshot_->writeStatus(axisNo, status);
+    snapshot_->endWrite();
+}
+
+std::chrono::milliseconds MonitoringScheduler::periodFor(AxisMode mode) const
+{
+    switch (mode) {
+    case AxisMode::Moving: return config_.movingPeriod;
+    case AxisMode::Settling: return config_.settlingPeriod;
+    case AxisMode::Idle: return config_.idlePeriod;
+    }
+    return config_.idlePeriod;
+}
+
+void MonitoringScheduler::scheduleNext()
+{
+    if (!running_) return;
+    timer_.expires_after(config_.tick);
+    auto self = shared_from_this();
+    timer_.async_wait([self](const boost::system::error_code& ec) {
+        if (ec) return;
+        self->tick();
+        self->scheduleNext();
+    });
+}
+
+void MonitoringScheduler::tick()
+{
+    const auto now = Clock::now();
+
+    std::vector<std::pair<int, AxisSchedule*>> due;
+    for (auto it = schedules_.begin(); it != schedules_.end();) {
+        AxisSchedule& schedule = it->second;
+        if (schedule.mode == AxisMode::Settling && now >= schedule.settlingUntil) {
+            setMode(it->first, schedule, AxisMode::Idle);
+        }
+        // Idle axes nobody displays need no heartbeat
+        if (schedule.mode == AxisMode::Idle && !trackedAxes_.count(it->first)) {
+            it = schedules_.erase(it);
+            continue;
+        }
+        if (schedule.nextDue <= now) {
+            due.emplace_back(it->first, &schedule);
+        }
+        ++it;
+    }
+
+    // Moving before Settling before Idle; within a mode the most overdue axis goes first
+    std::sort(due.begin(), due.end(), [](const auto& a, const auto& b) {
+        if (a.second->mode != b.second->mode) return a.second->mode < b.second->mode;
+        return a.second->nextDue < b.second->nextDue;
+    });
+    int deferred = 0;
+    if (due.size() > static_cast<size_t>(config_.maxQueriesPerTick)) {
+        deferred = static_cast<int>(due.size()) - config_.maxQueriesPerTick;
+        due.resize(config_.maxQueriesPerTick);
+    }
+
+    std::set<int> selected;
+    for (auto& [axisNo, schedule] : due) {
+        selected.insert(axisNo);
+        if (metrics_) {
+            metrics_->recordPollLateness(std::chrono::duration_cast<std::chrono::nanoseconds>(now - schedule->nextDue).count());
+        }
+        schedule->nextDue = now + periodFor(schedule->mode);
+    }
+    if (metrics_) {
+        metrics_->recordPollTick(deferred);
+    }
+
+    for (int axisNo : monitored_) {
+        if (!selected.count(axisNo)) controller_->removeAxisToMonitor(axisNo);
+    }
+    for (int axisNo : selected) {
+        if (!monitored_.count(axisNo)) controller_->addAxisToMonitor(axisNo);
+    }
+    monitored_ = std::move(selected);
+}
@@ -0,0 +1,77 @@
+#ifndef MONITORINGSCHEDULER_H
+#define MONITORINGSCHEDULER_H
+
+#include "AxisSnapshot.h"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+
+class CommandMetrics;
+class KohzuController;
+
+// 축별 모니터링 주기 설정
+struct MonitoringConfig {
+    std::chrono::milliseconds tick{10};              // KohzuController 모니터링 기본 주기
+    std::chrono::milliseconds movingPeriod{10};      // 이동 중인 축
+    std::chrono::milliseconds settlingPeriod{50};    // 명령 완료 직후 꼬리 구간
+    std::chrono::milliseconds settlingDuration{1500};
+    std::chrono::milliseconds idlePeriod{1000};      // 정지 축 heartbeat
+    int maxQueriesPerTick = 8;                       // 한 tick에 모든 축이 나눠 쓰는 질의 수
+};
+
+// Decides which axes KohzuController queries on each monitoring tick.
+//
+// Every axis carries a mode (Moving / Settling / Idle) with its own sampling
+// period. On each tick the axes that are due are ordered by mode and then by
+// how overdue they are, and at most maxQueriesPerTick of them are put into
+// the controller's monitor set; the rest wait for the next tick. These polls
+// go out next to CommandPipeline's window, not through it (see there). All
+// state is owned by the io thread, public calls are posted there.
+class MonitoringScheduler : public std::enable_shared_from_this<MonitoringScheduler>
+{
+public:
+    enum class AxisMode { Moving, Settling, Idle };
+
+    MonitoringScheduler(boost::asio::io_context& ioContext, std::shared_ptr<KohzuController> controller,
+                        std::shared_ptr<AxisSnapshotBuffer> snapshot, MonitoringConfig config = {},
+                        std::shared_ptr<CommandMetrics> metrics = nullptr);
+
+    void start();
+    void stop();
+
+    void setAxes(const std::set<int>& axes);     // axes that get at least the idle heartbeat
+    void setConfig(const MonitoringConfig& config);
+    void notifyCommandIssued(int axisNo);        // axis enters Moving
+    void notifyCommandFinished(int axisNo);      // axis enters Settling
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct AxisSchedule {
+        AxisMode mode = AxisMode::Idle;
+        int pendingCommands = 0;
+        Clock::time_point nextDue{};
+        Clock::time_point settlingUntil{};
+    };
+
+    void scheduleNext();
+    void tick();
+    std::chrono::milliseconds periodFor(AxisMode mode) const;
+    AxisSchedule& scheduleFor(int axisNo);
+    void setMode(int axisNo, AxisSchedule& schedule, AxisMode mode);
+
+    boost::asio::steady_timer timer_;
+    std::shared_ptr<KohzuController> controller_;
+    std::shared_ptr<AxisSnapshotBuffer> snapshot_;
+    std::shared_ptr<CommandMetrics> metrics_;   // optional: poll lateness and deferred axes
+    MonitoringConfig config_;
+    bool running_ = false;
+
+    std::set<int> trackedAxes_;
+    std::map<int, AxisSchedule> schedules_;
+    std::set<int> monitored_;       // axes currently in the controller's monitor set
+};
+
+#endif // MONITORINGSCHEDULER_H
@@ -0,0 +1,26 @@
+#ifndef MOTIONCHANNEL_H
+#define MOTIONCHANNEL_H
+
+#include "AxisSnapshot.h"
+#include <boost/asio/io_context.hpp>
+#include <memory>
+
+class CommandPipeline;
+class MonitoringScheduler;
+
+// Io-thread side of one controller connection, for code that drives the
+// controller from the io thread itself (see AwaitableMotion in qt-kohzu-coro).
+// Empty when not connected. The channel shares ownership of the io_context,
+// so every handle stays valid after a disconnect; the retired pipeline is
+// closed then and fails new and pending commands alike. Coroutines still
+// running on a private context that the manager has stopped never resume.
+struct MotionChannel {
+    std::shared_ptr<boost::asio::io_context> ioContext;
+    std::shared_ptr<CommandPipeline> pipeline;
+    std::shared_ptr<MonitoringScheduler> scheduler;
+    std::shared_ptr<AxisSnapshotBuffer> snapshot;
+
+    bool isValid() const { return ioContext && pipeline; }
+};
+
+#endif // MOTIONCHANNEL_H
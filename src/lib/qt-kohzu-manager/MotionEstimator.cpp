@@ -0,0 +1,128 @@
+#include "MotionEstimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Weight of the newest observation in the velocity and learned-speed averages
+constexpr double kVelocityWeight = 0.5;
+constexpr double kLearnWeight = 0.2;
+}
+
+MotionEstimator::MotionEstimator(MotionEstimatorConfig config)
+    : config_(config)
+{
+}
+
+void MotionEstimator::commandMove(int axisNo, bool hasTarget, int targetPulse, int speedTable, std::int64_t nowNs)
+{
+    if (!isValid(axisNo)) return;
+
+    AxisState& axis = axes_[axisNo];
+    if (!axis.estimating) ++estimatingCount_;
+    axis.estimating = true;
+    axis.hasTarget = hasTarget;
+    axis.targetPulse = targetPulse;
+    axis.speedTable = (speedTable >= 0 && speedTable < kSpeedTables) ? speedTable : -1;
+    axis.samplesSinceCommand = 0;
+
+    // Until the first sample of this move, run at the speed this table gave last time
+    axis.velocity = 0.0;
+    if (hasTarget && axis.hasSample && axis.speedTable >= 0 && targetPulse != axis.lastPulse) {
+        axis.velocity = learnedSpeed_[axis.speedTable] * (targetPulse > axis.lastPulse ? 1.0 : -1.0);
+    }
+    // The estimate starts when the command goes out, not at the last (idle) sample
+    if (axis.hasSample) axis.lastNs = std::max(axis.lastNs, nowNs);
+}
+
+void MotionEstimator::addSample(int axisNo, std::int64_t timestampNs, int positionPulse)
+{
+    if (!isValid(axisNo)) return;
+
+    AxisState& axis = axes_[axisNo];
+    if (axis.hasSample && timestampNs <= axis.lastNs) {
+        // Older than what the estimate already started from
+        axis.lastPulse = positionPulse;
+        return;
+    }
+
+    if (axis.estimating && axis.hasSample) {
+        const double predicted = extrapolate(axis, timestampNs);
+        error_.record(static_cast<std::int64_t>(std::llround(std::abs(predicted - positionPulse))));
+
+        const double observed = double(positionPulse - axis.lastPulse) / double(timestampNs - axis.lastNs);
+        axis.velocity = axis.samplesSinceCommand == 0 && axis.velocity == 0.0
+                            ? observed
+                            : kVelocityWeight * observed + (1.0 - kVelocityWeight) * axis.velocity;
+        // The first interval of a move includes the acceleration ramp; learn from the rest
+        if (axis.speedTable >= 0 && axis.samplesSinceCommand > 0 && observed != 0.0) {
+            double& learned = learnedSpeed_[axis.speedTable];
+            learned = learned == 0.0 ? std::abs(observed) : kLearnWeight * std::abs(observed) + (1.0 - kLearnWeight) * learned;
+        }
+        ++axis.samplesSinceCommand;
+    }
+
+    axis.hasSample = true;
+    axis.lastNs = timestampNs;
+    axis.lastPulse = positionPulse;
+
+    if (axis.estimating && axis.hasTarget && positionPulse == axis.targetPulse) {
+        stop(axis);
+    }
+}
+
+void MotionEstimator::finishMove(int axisNo)
+{
+    if (!isValid(axisNo)) return;
+    stop(axes_[axisNo]);
+}
+
+void MotionEstimator::reset(int axisNo)
+{
+    if (!isValid(axisNo)) return;
+    stop(axes_[axisNo]);
+    axes_[axisNo] = AxisState{};
+}
+
+bool MotionEstimator::isEstimating(int axisNo) const
+{
+    return isValid(axisNo) && axes_[axisNo].estimating;
+}
+
+int MotionEstimator::estimate(int axisNo, std::int64_t nowNs) const
+{
+    if (!isValid(axisNo)) return 0;
+    const AxisState& axis = axes_[axisNo];
+    if (!axis.estimating || !axis.hasSample) return axis.lastPulse;
+    return static_cast<int>(std::lround(extrapolate(axis, nowNs)));
+}
+
+double MotionEstimator::learnedSpeed(int speedTable) const
+{
+    if (speedTable < 0 || speedTable >= kSpeedTables) return 0.0;
+    return learnedSpeed_[speedTable] * 1e9;
+}
+
+double MotionEstimator::extrapolate(const AxisState &axis, std::int64_t nowNs) const
+{
+    const std::int64_t elapsed = std::clamp<std::int64_t>(nowNs - axis.lastNs, 0, config_.maxExtrapolationNs);
+    double delta = axis.velocity * double(elapsed);
+    delta = std::clamp(delta, -double(config_.maxDeviationPulse), double(config_.maxDeviationPulse));
+
+    double position = axis.lastPulse + delta;
+    // Never run past the commanded end point
+    if (axis.hasTarget) {
+        if (axis.targetPulse >= axis.lastPulse) {
+            position = std::clamp(position, double(axis.lastPulse), double(axis.targetPulse));
+        } else {
+            position = std::clamp(position, double(axis.targetPulse), double(axis.lastPulse));
+        }
+    }
+    return position;
+}
+
+void MotionEstimator::stop(AxisState &axis)
+{
+    if (axis.estimating) --estimatingCount_;
+    axis.estimating = false;
+    axis.velocity = 0.0;
+}
@@ -0,0 +1,78 @@
+#ifndef MOTIONESTIMATOR_H
+#define MOTIONESTIMATOR_H
+
+#include "AxisSnapshot.h"
+#include "LatencyHistogram.h"
+#include <array>
+#include <cstdint>
+
+// 추정 설정
+struct MotionEstimatorConfig {
+    int maxDeviationPulse = 2000;              // 마지막 실측값에서 벗어날 수 있는 최대 거리 (오차 한계)
+    std::int64_t maxExtrapolationNs = 300'000'000;   // 샘플이 이보다 오래되면 더 진행하지 않음
+};
+
+// Client-side position estimate between controller samples, per axis.
+//
+// A move command arms the axis with its target and speed table index. The
+// estimate runs from the last real sample at a velocity taken from recent
+// samples (seeded, before the first sample of a move, with the speed
+// learned for that speed table index on earlier moves) and stops at the
+// target, at maxDeviationPulse from the sample and after maxExtrapolationNs,
+// and ends when the controller reports the move complete. Every real sample replaces the estimate; how far the estimate was off at
+// that moment is recorded in errorHistogram(), in pulses.
+//
+// GUI thread only.
+class MotionEstimator
+{
+public:
+    static constexpr int kMaxAxes = AxisStateSnapshot::kMaxAxes;
+    static constexpr int kSpeedTables = 10;
+
+    explicit MotionEstimator(MotionEstimatorConfig config = {});
+
+    void setConfig(const MotionEstimatorConfig& config) { config_ = config; }
+    const MotionEstimatorConfig& config() const { return config_; }
+
+    // hasTarget = false for moves whose end point is not known (origin return)
+    void commandMove(int axisNo, bool hasTarget, int targetPulse, int speedTable, std::int64_t nowNs);
+    void addSample(int axisNo, std::int64_t timestampNs, int positionPulse);
+    // The controller reported the move done; the display falls back to the samples
+    void finishMove(int axisNo);
+    void reset(int axisNo);
+
+    // True while the axis is between a move command and its end
+    bool isEstimating(int axisNo) const;
+    bool anyEstimating() const { return estimatingCount_ > 0; }
+    int estimate(int axisNo, std::int64_t nowNs) const;
+
+    // |estimate - sample| in pulses at each sample that arrived mid-move
+    const LatencyHistogram& errorHistogram() const { return error_; }
+    // Steady speed seen for a speed table index, pulses per second (0 = not seen yet)
+    double learnedSpeed(int speedTable) const;
+
+private:
+    struct AxisState {
+        bool estimating = false;
+        bool hasSample = false;
+        bool hasTarget = false;
+        int targetPulse = 0;
+        int speedTable = -1;
+        int lastPulse = 0;
+        std::int64_t lastNs = 0;
+        double velocity = 0.0;         // pulses per ns
+        int samplesSinceCommand = 0;
+    };
+
+    static bool isValid(int axisNo) { return axisNo >= 1 && axisNo <= kMaxAxes; }
+    double extrapolate(const AxisState& axis, std::int64_t nowNs) const;
+    void stop(AxisState& axis);
+
+    MotionEstimatorConfig config_;
+    std::array<AxisState, kMaxAxes + 1> axes_{};
+    std::array<double, kSpeedTables> learnedSpeed_{};   // pulses per ns
+    int estimatingCount_ = 0;
+    LatencyHistogram error_;
+};
+
+#endif // MOTIONESTIMATOR_H
@@ -0,0 +1,277 @@
+#include "MotionSequence.h"
+#include "AxisSnapshot.h"
+#include "CommandPipeline.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+constexpr int kMaxLoopCount = 1000000;
+constexpr long long kMaxExecutedSteps = 10000000;   // dry-run budget, guards against runaway nested loops
+
+class SequenceParser
+{
+public:
+    SequenceParser(MotionSequence& sequence, QString& error) : sequence_(sequence), error_(error) {}
+
+    bool parseSteps(const QJsonArray& array, const QString& path)
+    {
+        for (int i = 0; i < array.size(); ++i) {
+            const QString where = QString("%1[%2]").arg(path).arg(i);
+            if (!array[i].isObject()) {
+                return fail(where, "step must be an object");
+            }
+            if (!parseStep(array[i].toObject(), where)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    bool fail(const QString& where, const QString& message)
+    {
+        error_ = QString("%1: %2").arg(where, message);
+        return false;
+    }
+
+    bool axisFor(const QJsonObject& obj, const QString& key, const QString& where, int& axisNo)
+    {
+        axisNo = obj[key].toInt(0);
+        if (sequence_.motors.count(axisNo) == 0) {
+            return fail(where, QString("axis %1 is not declared in \"axes\"").arg(obj[key].toVariant().toString()));
+        }
+        return true;
+    }
+
+    bool speedFor(const QJsonObject& obj, const QString& where, int& speed)
+    {
+        speed = obj.contains("speed") ? obj["speed"].toInt(-1) : CommandPipeline::kSpeedTables - 1;
+        if (speed < 0 || speed >= CommandPipeline::kSpeedTables) {
+            return fail(where, QString("speed must be 0-%1").arg(CommandPipeline::kSpeedTables - 1));
+        }
+        return true;
+    }
+
+    bool parseStep(const QJsonObject& obj, const QString& where)
+    {
+        SequenceStep step;
+        if (obj.contains("move")) {
+            step.type = SequenceStep::Type::Move;
+            if (!axisFor(obj, "move", where, step.axisNo) || !speedFor(obj, where, step.speed)) return false;
+            const MotorCatalog& catalog = *sequence_.catalog;
+            const int motorIndex = sequence_.motors.at(step.axisNo);
+            const StageMotorInfo& motor = catalog.at(motorIndex);
+            if (obj.contains("to") == obj.contains("by")) {
+                return fail(where, "move needs exactly one of \"to\" or \"by\"");
+            }
+            step.isAbsolute = obj.contains("to");
+            const double physical = obj[step.isAbsolute ? "to" : "by"].toDouble();
+            step.pulse = catalog.nanoToPulse(motorIndex, MotorCatalog::toNano(physical));
+            // Same window MainWindow enforces for manual moves
+            if (step.isAbsolute && !catalog.inRange(motorIndex, catalog.pulseToNano(motorIndex, step.pulse))) {
+                return fail(where, QString("target %1 %2 is out of range (0 ~ %3 %2)")
+                                       .arg(physical).arg(motor.unit_symbol)
+                                       .arg(MotorCatalog::formatNano(catalog.rangeNano(motorIndex), motor.display_precision)));
+            }
+            step.description = QString("%1: move axis %2 %3 %4 %5").arg(where).arg(step.axisNo)
+                                   .arg(step.isAbsolute ? "to" : "by").arg(physical).arg(motor.unit_symbol).toStdString();
+        } else if (obj.contains("origin")) {
+            step.type = SequenceStep::Type::Origin;
+            if (!axisFor(obj, "origin", where, step.axisNo) || !speedFor(obj, where, step.speed)) return false;
+            step.description = QString("%1: origin axis %2").arg(where).arg(step.axisNo).toStdString();
+        } else if (obj.contains("system")) {
+            step.type = SequenceStep::Type::System;
+            if (!axisFor(obj, "system", where, step.axisNo)) return false;
+            if (!obj.contains("no") || !obj.contains("value")) {
+                return fail(where, "system needs \"no\" and \"value\"");
+            }
+            step.systemNo = obj["no"].toInt();
+            step.value = obj["value"].toInt();
+            step.description = QString("%1: setSystem axis %2 #%3 = %4").arg(where).arg(step.axisNo)
+                                   .arg(step.systemNo).arg(step.value).toStdString();
+        } else if (obj.contains("wait")) {
+            step.type = SequenceStep::Type::Wait;
+            const QJsonValue wait = obj["wait"];
+            if (wait.isArray()) {
+                for (const QJsonValue& value : wait.toArray()) {
+                    const int axisNo = value.toInt(0);
+                    if (sequence_.motors.count(axisNo) == 0) {
+                        return fail(where, QString("wait on undeclared axis %1").arg(value.toVariant().toString()));
+                    }
+                    step.axes.push_back(axisNo);
+                }
+            } else if (wait.toString() != "all") {
+                return fail(where, "wait must be an axis list or \"all\"");
+            }
+            step.description = QString("%1: wait").arg(where).toStdString();
+        } else if (obj.contains("delay")) {
+            step.type = SequenceStep::Type::Delay;
+            const int delayMs = obj["delay"].toInt(-1);
+            if (delayMs < 0) {
+                return fail(where, "delay must be a non-negative number of milliseconds");
+            }
+            step.delay = std::chrono::milliseconds(delayMs);
+            step.description = QString("%1: delay %2 ms").arg(where).arg(delayMs).toStdString();
+        } else if (obj.contains("loop")) {
+            const int count = obj["loop"].toInt(0);
+            if (count < 1 || count > kMaxLoopCount) {
+                return fail(where, QString("loop count must be 1-%1").arg(kMaxLoopCount));
+            }
+            if (!obj["steps"].isArray()) {
+                return fail(where, "loop needs a \"steps\" array");
+            }
+            const int begin = static_cast<int>(sequence_.steps.size());
+            step.type = SequenceStep::Type::LoopBegin;
+            step.count = count;
+            step.description = QString("%1: loop x%2").arg(where).arg(count).toStdString();
+            sequence_.steps.push_back(step);
+
+            if (!parseSteps(obj["steps"].toArray(), where + ".steps")) return false;
+
+            SequenceStep end;
+            end.type = SequenceStep::Type::LoopEnd;
+            end.match = begin;
+            end.description = QString("%1: end loop").arg(where).toStdString();
+            sequence_.steps[begin].match = static_cast<int>(sequence_.steps.size());
+            sequence_.steps.push_back(end);
+            return true;
+        } else {
+            return fail(where, "unknown step (expected move, origin, system, wait, delay or loop)");
+        }
+        sequence_.steps.push_back(step);
+        return true;
+    }
+
+    MotionSequence& sequence_;
+    QString& error_;
+};
+
+} // namespace
+
+bool MotionSequence::parse(const QByteArray &json, std::shared_ptr<const MotorCatalog> catalog,
+                           MotionSequence &sequence, QString &error)
+{
+    sequence = MotionSequence();
+    sequence.catalog = std::move(catalog);
+    if (!sequence.catalog) {
+        error = "no motor catalog";
+        return false;
+    }
+
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        error = QString("offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+        return false;
+    }
+    const QJsonObject root = doc.object();
+
+    const QJsonObject axes = root["axes"].toObject();
+    for (auto it = axes.begin(); it != axes.end(); ++it) {
+        bool ok = false;
+        const int axisNo = it.key().toInt(&ok);
+        if (!ok || axisNo < 1 || axisNo > AxisStateSnapshot::kMaxAxes) {
+            error = QString("axes: invalid axis number \"%1\"").arg(it.key());
+            return false;
+        }
+        const QString motorName = it.value().toString();
+        const int motorIndex = sequence.catalog->indexOf(motorName);
+        if (motorIndex < 0) {
+            error = QString("axes.%1: unknown motor \"%2\"").arg(it.key(), motorName);
+            return false;
+        }
+        sequence.motors[axisNo] = motorIndex;
+    }
+
+    if (!root["steps"].isArray()) {
+        error = "missing \"steps\" array";
+        return false;
+    }
+    SequenceParser parser(sequence, error);
+    return parser.parseSteps(root["steps"].toArray(), "steps");
+}
+
+bool MotionSequence::load(const QString &filePath, std::shared_ptr<const MotorCatalog> catalog,
+                          MotionSequence &sequence, QString &error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+    return parse(file.readAll(), std::move(catalog), sequence, error);
+}
+
+bool MotionSequence::validate(const std::map<int, int> &startPulses, std::string &error) const
+{
+    std::map<int, int> positions = startPulses;
+    std::vector<int> remaining(steps.size(), 0);   // loop iterations left, indexed by LoopBegin
+    long long executed = 0;
+
+    for (std::size_t pc = 0; pc < steps.size(); ++pc) {
+        if (++executed > kMaxExecutedSteps) {
+            error = "sequence expands to more than " + std::to_string(kMaxExecutedSteps) + " steps";
+            return false;
+        }
+        const SequenceStep& step = steps[pc];
+        switch (step.type) {
+        case SequenceStep::Type::Move: {
+            int& position = positions[step.axisNo];
+            const int target = step.isAbsolute ? step.pulse : position + step.pulse;
+            const int motorIndex = motors.at(step.axisNo);
+            const qint64 targetNano = catalog->pulseToNano(motorIndex, target);
+            if (!catalog->inRange(motorIndex, targetNano)) {
+                const StageMotorInfo& motor = catalog->at(motorIndex);
+                error = step.description + ": reaches "
+                        + MotorCatalog::formatNano(targetNano, motor.display_precision).toStdString() + " "
+                        + motor.unit_symbol.toStdString() + ", outside 0 ~ "
+                        + MotorCatalog::formatNano(catalog->rangeNano(motorIndex), motor.display_precision).toStdString();
+                return false;
+            }
+            position = target;
+            break;
+        }
+        case SequenceStep::Type::Origin:
+            positions[step.axisNo] = 0;
+            break;
+        case SequenceStep::Type::LoopBegin:
+            remaining[pc] = step.count;
+            break;
+        case SequenceStep::Type::LoopEnd:
+            if (--remaining[step.match] > 0) {
+                pc = static_cast<std::size_t>(step.match);   // continue after LoopBegin
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+
+std::vector<int> MotionSequence::axisNumbers() const
+{
+    std::vector<int> axes;
+    for (const auto& [axisNo, motor] : motors) {
+        axes.push_back(axisNo);
+    }
+    return axes;
+}
+
+std::vector<int> MotionSequence::startDependentAxes() const
+{
+    std::map<int, bool> dependsOnStart;   // axis -> first motion step was relative
+    for (const SequenceStep& step : steps) {
+        if (step.type == SequenceStep::Type::Move || step.type == SequenceStep::Type::Origin) {
+            dependsOnStart.emplace(step.axisNo, step.type == SequenceStep::Type::Move && !step.isAbsolute);
+        }
+    }
+    std::vector<int> axes;
+    for (const auto& [axisNo, relative] : dependsOnStart) {
+        if (relative) axes.push_back(axisNo);
+    }
+    return axes;
+}
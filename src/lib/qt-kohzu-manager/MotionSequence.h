@@ -0,0 +1,77 @@
+#ifndef MOTIONSEQUENCE_H
+#define MOTIONSEQUENCE_H
+
+#include "MotorCatalog.h"
+#include <QByteArray>
+#include <QString>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 시퀀스 한 단계 (펄스 단위로 변환된 상태)
+struct SequenceStep {
+    enum class Type {
+        Move,       // 이동 명령 전송 (완료를 기다리지 않음)
+        Origin,     // 원점 복귀 전송
+        System,     // setSystem 전송
+        Wait,       // 지정 축(비어 있으면 전체)의 명령 완료 대기
+        Delay,      // 고정 시간 대기
+        LoopBegin,  // count번 반복 시작
+        LoopEnd     // 대응하는 LoopBegin으로 복귀
+    };
+
+    Type type = Type::Wait;
+    int axisNo = 0;
+    bool isAbsolute = true;
+    int pulse = 0;
+    int speed = 9;
+    int systemNo = 0;
+    int value = 0;
+    std::vector<int> axes;                    // Wait 대상
+    std::chrono::milliseconds delay{0};
+    int count = 1;                            // LoopBegin 반복 횟수
+    int match = -1;                           // LoopBegin <-> LoopEnd 인덱스
+    std::string description;                  // 진행 표시용 ("steps[3].steps[0]: move axis 1 to 2.5 mm")
+};
+
+// A motion sequence parsed from JSON, already converted to pulses.
+//
+// Format:
+//   {
+//     "axes":  { "1": "XA05A-R201", "2": "RA04A-W" },
+//     "steps": [
+//       { "move": 1, "to": 2.5, "speed": 9 },     absolute, physical units
+//       { "move": 1, "by": -0.1 },                relative
+//       { "origin": 2, "speed": 5 },
+//       { "system": 1, "no": 2, "value": 8 },
+//       { "wait": [1, 2] },                       or "wait": "all"
+//       { "delay": 250 },                         milliseconds
+//       { "loop": 10, "steps": [ ... ] }
+//     ]
+//   }
+//
+// Commands are sent without waiting; commands for one axis run in order and
+// "wait" blocks until the listed axes are idle.
+struct MotionSequence {
+    std::vector<SequenceStep> steps;
+    std::shared_ptr<const MotorCatalog> catalog;   // unit conversion and range checks
+    std::map<int, int> motors;                      // axis -> motor index in catalog
+
+    // Parses and checks structure, motor names and absolute targets
+    static bool parse(const QByteArray& json, std::shared_ptr<const MotorCatalog> catalog,
+                      MotionSequence& sequence, QString& error);
+    static bool load(const QString& filePath, std::shared_ptr<const MotorCatalog> catalog,
+                     MotionSequence& sequence, QString& error);
+
+    // Dry-runs every step, loops included, from the given start positions and
+    // checks that every target stays inside its motor's travel range.
+    bool validate(const std::map<int, int>& startPulses, std::string& error) const;
+
+    std::vector<int> axisNumbers() const;
+    // Axes whose first motion step is relative, i.e. whose dry run depends on the start position
+    std::vector<int> startDependentAxes() const;
+};
+
+#endif // MOTIONSEQUENCE_H
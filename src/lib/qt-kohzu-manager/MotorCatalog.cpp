@@ -0,0 +1,181 @@
+#include "MotorCatalog.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <mutex>
+
+namespace {
+
+std::mutex sharedMutex;
+std::shared_ptr<const MotorCatalog> sharedCatalog;
+
+const StageMotorInfo kDefaultMotor = {"Default", UnitType::Linear, "pulse", 1.0, 1000000.0, 0};
+
+qint64 divideRounded(qint64 numerator, qint64 denominator)
+{
+    const qint64 half = denominator / 2;
+    return numerator >= 0 ? (numerator + half) / denominator : -((-numerator + half) / denominator);
+}
+
+qint64 powerOfTen(int exponent)
+{
+    qint64 value = 1;
+    while (exponent-- > 0) value *= 10;
+    return value;
+}
+
+} // namespace
+
+std::shared_ptr<const MotorCatalog> MotorCatalog::fromJson(const QByteArray &json, QString &error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(json, &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        error = QString("offset %1: %2").arg(parseError.offset).arg(parseError.errorString());
+        return nullptr;
+    }
+    const QJsonValue motors = doc.object().value("motors");
+    if (!motors.isArray()) {
+        error = "missing \"motors\" array";
+        return nullptr;
+    }
+
+    std::shared_ptr<MotorCatalog> catalog(new MotorCatalog());
+    catalog->append(kDefaultMotor);
+
+    const QJsonArray entries = motors.toArray();
+    for (int i = 0; i < entries.size(); ++i) {
+        const QJsonObject obj = entries[i].toObject();
+        const QString where = QString("motors[%1]").arg(i);
+
+        StageMotorInfo motor;
+        motor.name = obj.value("name").toString();
+        const QString unit = obj.value("unit").toString();
+        motor.unit_type = unit == "angular" ? UnitType::Angular : UnitType::Linear;
+        motor.unit_symbol = obj.value("symbol").toString(unit == "angular" ? "°" : "mm");
+        motor.value_per_pulse = obj.value("value_per_pulse").toDouble();
+        motor.travel_range = obj.value("travel_range").toDouble();
+        motor.display_precision = obj.value("precision").toInt(4);
+
+        if (motor.name.isEmpty()) {
+            error = where + ": missing name";
+            return nullptr;
+        }
+        if (unit != "linear" && unit != "angular") {
+            error = QString("%1 (%2): unit must be \"linear\" or \"angular\"").arg(where, motor.name);
+            return nullptr;
+        }
+        // Step sizes must be exact in nano-units for the fixed-point conversions
+        const qint64 nano = toNano(motor.value_per_pulse);
+        if (nano <= 0 || std::abs(fromNano(nano) - motor.value_per_pulse) > 1e-12 * motor.value_per_pulse) {
+            error = QString("%1 (%2): value_per_pulse must be positive with at most 9 decimals").arg(where, motor.name);
+            return nullptr;
+        }
+        if (!(motor.travel_range > 0.0) || motor.display_precision < 0 || motor.display_precision > 9) {
+            error = QString("%1 (%2): travel_range must be positive and precision 0-9").arg(where, motor.name);
+            return nullptr;
+        }
+
+        if (motor.name == kDefaultMotor.name) {
+            continue;   // index 0 is reserved for the built-in definition
+        }
+        if (catalog->indexOf(motor.name) >= 0) {
+            error = QString("%1: duplicate motor \"%2\"").arg(where, motor.name);
+            return nullptr;
+        }
+        catalog->append(motor);
+    }
+    return catalog;
+}
+
+std::shared_ptr<const MotorCatalog> MotorCatalog::load(const QString &filePath, QString &error)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return nullptr;
+    }
+    auto catalog = fromJson(file.readAll(), error);
+    if (!catalog) {
+        error = QString("%1: %2").arg(filePath, error);
+    }
+    return catalog;
+}
+
+std::shared_ptr<const MotorCatalog> MotorCatalog::builtIn()
+{
+    static const std::shared_ptr<const MotorCatalog> catalog = []() {
+        std::shared_ptr<MotorCatalog> table(new MotorCatalog());
+        table->append(kDefaultMotor);
+        return table;
+    }();
+    return catalog;
+}
+
+std::shared_ptr<const MotorCatalog> MotorCatalog::shared()
+{
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    return sharedCatalog ? sharedCatalog : builtIn();
+}
+
+void MotorCatalog::install(std::shared_ptr<const MotorCatalog> catalog)
+{
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    sharedCatalog = std::move(catalog);
+}
+
+void MotorCatalog::toPhysicalNano(const int *motorIndex, const int *pulses, qint64 *out, std::size_t count) const
+{
+    const qint64* scale = nanoPerPulse_.data();
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = qint64(pulses[i]) * scale[motorIndex[i]];
+    }
+}
+
+void MotorCatalog::toPulses(const int *motorIndex, const qint64 *nano, int *out, std::size_t count) const
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = nanoToPulse(motorIndex[i], nano[i]);
+    }
+}
+
+int MotorCatalog::nanoToPulse(int index, qint64 nano) const
+{
+    const qint64 pulse = divideRounded(nano, nanoPerPulse_[index]);
+    return static_cast<int>(std::clamp<qint64>(pulse, INT_MIN, INT_MAX));
+}
+
+qint64 MotorCatalog::toNano(double value)
+{
+    // +-9.2e9 units is the qint64 limit; no stage comes close
+    const double scaled = std::clamp(value * double(kNanoPerUnit), -9.2e18, 9.2e18);
+    return static_cast<qint64>(std::llround(scaled));
+}
+
+QString MotorCatalog::formatNano(qint64 nano, int precision)
+{
+    precision = std::clamp(precision, 0, 9);
+    const qint64 rounded = divideRounded(nano, powerOfTen(9 - precision));
+    const qint64 magnitude = rounded < 0 ? -rounded : rounded;
+    const qint64 scale = powerOfTen(precision);
+
+    QString text = rounded < 0 ? QString("-") : QString();
+    text += QString::number(magnitude / scale);
+    if (precision > 0) {
+        text += '.';
+        text += QString::number(magnitude % scale).rightJustified(precision, '0');
+    }
+    return text;
+}
+
+void MotorCatalog::append(const StageMotorInfo &motor)
+{
+    indexByName_.insert(motor.name, size());
+    motors_.push_back(motor);
+    nanoPerPulse_.push_back(toNano(motor.value_per_pulse));
+    rangeNano_.push_back(toNano(motor.travel_range * 2.0));
+}
@@ -0,0 +1,75 @@
+#ifndef MOTORCATALOG_H
+#define MOTORCATALOG_H
+
+#include "StageMotorInfo.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Immutable, index-addressed table of stage models.
+//
+// Loaded once from a JSON catalog and shared read-only, so callers keep a
+// motor index and never look a model up by name on the hot path. Positions
+// are exact fixed-point values in nano-units (1e-9 mm or 1e-9 °): every
+// catalog step size is a decimal with at most nine fractional digits, so
+// pulse * nanoPerPulse is exact and only the final display rounds.
+//
+// Catalog format:
+//   { "motors": [ { "name": "RA04A-W", "unit": "angular", "symbol": "°",
+//                   "value_per_pulse": 0.002, "travel_range": 177.0, "precision": 3 }, ... ] }
+//
+// Index 0 is always the "Default" motor (1 pulse per unit), added if the file
+// does not define it.
+class MotorCatalog
+{
+public:
+    static constexpr qint64 kNanoPerUnit = 1000000000;
+    static constexpr int kDefaultIndex = 0;
+
+    static std::shared_ptr<const MotorCatalog> fromJson(const QByteArray& json, QString& error);
+    static std::shared_ptr<const MotorCatalog> load(const QString& filePath, QString& error);
+    // Only the "Default" motor
+    static std::shared_ptr<const MotorCatalog> builtIn();
+
+    // Process-wide catalog; builtIn() until one is installed
+    static std::shared_ptr<const MotorCatalog> shared();
+    static void install(std::shared_ptr<const MotorCatalog> catalog);
+
+    int size() const { return static_cast<int>(motors_.size()); }
+    // Name lookup for file/preset boundaries; -1 if unknown
+    int indexOf(const QString& name) const { return indexByName_.value(name, -1); }
+    const StageMotorInfo& at(int index) const { return motors_[index]; }
+
+    qint64 nanoPerPulse(int index) const { return nanoPerPulse_[index]; }
+    // Upper end of the allowed window 0 ~ 2 * travel_range
+    qint64 rangeNano(int index) const { return rangeNano_[index]; }
+
+    // Batched kernels over parallel arrays (one element per axis)
+    void toPhysicalNano(const int* motorIndex, const int* pulses, qint64* out, std::size_t count) const;
+    void toPulses(const int* motorIndex, const qint64* nano, int* out, std::size_t count) const;
+
+    qint64 pulseToNano(int index, int pulse) const { return qint64(pulse) * nanoPerPulse_[index]; }
+    // Rounds half away from zero, saturating at the int range
+    int nanoToPulse(int index, qint64 nano) const;
+    bool inRange(int index, qint64 nano) const { return nano >= 0 && nano <= rangeNano_[index]; }
+
+    static qint64 toNano(double value);
+    static double fromNano(qint64 nano) { return double(nano) / double(kNanoPerUnit); }
+    // Exact decimal text rounded to `precision` (0-9) fractional digits
+    static QString formatNano(qint64 nano, int precision);
+
+private:
+    MotorCatalog() = default;
+    void append(const StageMotorInfo& motor);
+
+    std::vector<StageMotorInfo> motors_;
+    std::vector<qint64> nanoPerPulse_;   // contiguous for the batched kernels
+    std::vector<qint64> rangeNano_;
+    QHash<QString, int> indexByName_;
+};
+
+#endif // MOTORCATALOG_H
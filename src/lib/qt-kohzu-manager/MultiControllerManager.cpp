@@ -0,0 +1,136 @@
+#include "MultiControllerManager.h"
+#include "IoContextPool.h"
+
+MultiControllerManager::MultiControllerManager(int ioThreads, QObject *parent)
+    : QObject(parent),
+    pool_(std::make_shared<IoContextPool>(ioThreads > 0 ? ioThreads : IoContextPool::defaultThreadCount()))
+{
+    qRegisterMetaType<ControllerAxisSample>("ControllerAxisSample");
+    qRegisterMetaType<QVector<ControllerAxisSample>>("QVector<ControllerAxisSample>");
+}
+
+MultiControllerManager::~MultiControllerManager()
+{
+    // No handler may touch a manager once it is gone: stop the shared threads first
+    pool_->stop();
+    for (Controller& controller : controllers_) {
+        delete controller.manager;
+    }
+}
+
+int MultiControllerManager::addController(const QString &host, quint16 port)
+{
+    const int index = controllerCount();
+    // Not parented: destroyed explicitly after the pool has stopped
+    auto* manager = new QtKohzuManager(pool_);
+    controllers_.push_back({manager, host, port});
+
+    connect(manager, &QtKohzuManager::connectionStateChanged, this, [this, index](QtKohzuManager::ConnectionState state) {
+        emit connectionStateChanged(index, state);
+    });
+    connect(manager, &QtKohzuManager::logMessage, this, [this, index](const QString& message) {
+        const Controller& controller = controllers_[index];
+        emit logMessage(QString("[%1 %2:%3] %4").arg(index).arg(controller.host).arg(controller.port).arg(message));
+    });
+    connect(manager, &QtKohzuManager::positionsUpdated, this, [this, index](const QVector<AxisSample>& samples) {
+        collectPositions(index, samples);
+    });
+    connect(manager, &QtKohzuManager::commandCompleted, this, [this, index](int axisNo, bool isOrigin, bool success) {
+        emit commandCompleted(index, axisNo, isOrigin, success);
+    });
+    return index;
+}
+
+int MultiControllerManager::ioThreadCount() const
+{
+    return pool_->threadCount();
+}
+
+QtKohzuManager *MultiControllerManager::controller(int index) const
+{
+    return (index >= 0 && index < controllerCount()) ? controllers_[index].manager : nullptr;
+}
+
+void MultiControllerManager::connectAll()
+{
+    for (int i = 0; i < controllerCount(); ++i) {
+        connectController(i);
+    }
+}
+
+void MultiControllerManager::disconnectAll()
+{
+    for (int i = 0; i < controllerCount(); ++i) {
+        disconnectController(i);
+    }
+}
+
+void MultiControllerManager::connectController(int index)
+{
+    if (QtKohzuManager* manager = controller(index)) {
+        manager->connectToController(controllers_[index].host, controllers_[index].port);
+    }
+}
+
+void MultiControllerManager::disconnectController(int index)
+{
+    if (QtKohzuManager* manager = controller(index)) {
+        manager->disconnectFromController();
+    }
+}
+
+void MultiControllerManager::move(int controller, int axisNo, int pulse, int speed, bool isAbsolute)
+{
+    if (QtKohzuManager* manager = this->controller(controller)) {
+        manager->move(axisNo, pulse, speed, isAbsolute);
+    }
+}
+
+void MultiControllerManager::moveOrigin(int controller, int axisNo, int speed)
+{
+    if (QtKohzuManager* manager = this->controller(controller)) {
+        manager->moveOrigin(axisNo, speed);
+    }
+}
+
+void MultiControllerManager::setSystem(int controller, int axisNo, int systemNo, int value)
+{
+    if (QtKohzuManager* manager = this->controller(controller)) {
+        manager->setSystem(axisNo, systemNo, value);
+    }
+}
+
+void MultiControllerManager::addAxisToPoll(int controller, int axisNo)
+{
+    if (QtKohzuManager* manager = this->controller(controller)) {
+        manager->addAxisToPoll(axisNo);
+    }
+}
+
+void MultiControllerManager::removeAxisToPoll(int controller, int axisNo)
+{
+    if (QtKohzuManager* manager = this->controller(controller)) {
+        manager->removeAxisToPoll(axisNo);
+    }
+}
+
+void MultiControllerManager::collectPositions(int controller, const QVector<AxisSample> &samples)
+{
+    for (const AxisSample& sample : samples) {
+        pendingPositions_.append({controller, sample.axisNo, sample.positionPulse, sample.timestampNs});
+    }
+    // Batches delivered in the same event loop pass are merged into one signal
+    if (!flushScheduled_) {
+        flushScheduled_ = true;
+        QMetaObject::invokeMethod(this, [this]() { flushPositions(); }, Qt::QueuedConnection);
+    }
+}
+
+void MultiControllerManager::flushPositions()
+{
+    flushScheduled_ = false;
+    if (pendingPositions_.isEmpty()) return;
+    QVector<ControllerAxisSample> samples;
+    samples.swap(pendingPositions_);
+    emit positionsUpdated(samples);
+}
@@ -0,0 +1,82 @@
+#ifndef MULTICONTROLLERMANAGER_H
+#define MULTICONTROLLERMANAGER_H
+
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "QtKohzuManager.h"
+
+class IoContextPool;
+
+// (컨트롤러, 축) 단위 위치 샘플
+struct ControllerAxisSample {
+    int controller = 0;             // addController가 돌려준 인덱스
+    int axisNo = 0;
+    int positionPulse = 0;
+    std::int64_t timestampNs = 0;   // steady_clock 기준 샘플 시각
+};
+
+Q_DECLARE_METATYPE(ControllerAxisSample)
+
+// Several Kohzu controllers behind one object, sharing a small io thread pool.
+//
+// Each controller is a QtKohzuManager pinned to one context of the pool, so
+// reconnects, pipelining and monitoring behave exactly as with a single
+// controller. Axes are addressed as (controller, axis). Position batches of
+// all controllers that arrive in the same event loop pass go out as one
+// positionsUpdated signal.
+class MultiControllerManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MultiControllerManager(int ioThreads = 0, QObject *parent = nullptr);   // 0 = pool default
+    ~MultiControllerManager();
+
+    // Returns the controller index used by every other call
+    int addController(const QString& host, quint16 port);
+    int controllerCount() const { return static_cast<int>(controllers_.size()); }
+    int ioThreadCount() const;
+    // Per-controller configuration and state (pipeline, monitoring, snapshot, ...)
+    QtKohzuManager* controller(int index) const;
+
+public slots:
+    void connectAll();
+    void disconnectAll();
+    void connectController(int index);
+    void disconnectController(int index);
+
+    void move(int controller, int axisNo, int pulse, int speed, bool isAbsolute);
+    void moveOrigin(int controller, int axisNo, int speed);
+    void setSystem(int controller, int axisNo, int systemNo, int value);
+    void addAxisToPoll(int controller, int axisNo);
+    void removeAxisToPoll(int controller, int axisNo);
+
+signals:
+    void connectionStateChanged(int controller, QtKohzuManager::ConnectionState state);
+    void logMessage(const QString& message);
+    // Only axes whose position changed, across every controller
+    void positionsUpdated(const QVector<ControllerAxisSample>& samples);
+    void commandCompleted(int controller, int axisNo, bool isOriginCommand, bool success);
+
+private:
+    struct Controller {
+        QtKohzuManager* manager = nullptr;
+        QString host;
+        quint16 port = 0;
+    };
+
+    void collectPositions(int controller, const QVector<AxisSample>& samples);
+    void flushPositions();
+
+    std::shared_ptr<IoContextPool> pool_;
+    std::vector<Controller> controllers_;
+    QVector<ControllerAxisSample> pendingPositions_;
+    bool flushScheduled_ = false;
+};
+
+#endif // MULTICONTROLLERMANAGER_H
@@ -0,0 +1,180 @@
+#include "PositionPublisher.h"
+#include "TrajectoryRecorder.h"
+#include "controller/AxisState.h"
+#include <algorithm>
+
+PositionPublisher::PositionPublisher(boost::asio::io_context& ioContext, std::shared_ptr<AxisState> axisState,
+                                     std::shared_ptr<AxisSnapshotBuffer> snapshot, Sink sink)
+    : timer_(ioContext), axisState_(std::move(axisState)), snapshot_(std::move(snapshot)), sink_(std::move(sink))
+{
+}
+
+void PositionPublisher::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) return;
+        running_ = true;
+    }
+    auto self = shared_from_this();
+    boost::asio::post(timer_.get_executor(), [self]() { self->scheduleNext(); });
+}
+
+void PositionPublisher::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+}
+
+void PositionPublisher::setAxes(const std::vector<int>& axes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    axes_ = axes;
+}
+
+void PositionPublisher::setCoalescingInterval(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    interval_ = std::max(interval, std::chrono::milliseconds(1));
+}
+
+void PositionPublisher::setSampleInterval(std::chrono::milliseconds interval)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleInterval_ = std::max(interval, std::chrono::milliseconds(1));
+}
+
+void PositionPublisher::setRecorder(std::shared_ptr<TrajectoryRecorder> recorder)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    recorder_ = std::move(recorder);
+}
+
+void PositionPublisher::setStallTimeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stallTimeout_ = std::max(timeout, std::chrono::milliseconds(1));
+}
+
+void PositionPublisher::scheduleNext()
+{
+    std::chrono::milliseconds interval;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        interval = sampleInterval_;
+    }
+    timer_.expires_after(interval);
+    auto self = shared_from_this();
+    timer_.async_wait([self](const boost::system::error_code& ec) {
+        if (ec) return;
+        self->sample();
+        self->scheduleNext();
+    });
+}
+
+void PositionPublisher::sample()
+{
+    std::vector<int> axes;
+    std::shared_ptr<TrajectoryRecorder> recorder;
+    std::chrono::milliseconds interval;
+    std::chrono::milliseconds stallTimeout;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        axes = axes_;
+        recorder = recorder_;
+        interval = interval_;
+        stallTimeout = stallTimeout_;
+    }
+
+    // Forget axes that were removed so they are re-published when added again
+    for (auto it = lastPublished_.begin(); it != lastPublished_.end();) {
+        if (std::find(axes.begin(), axes.end(), it->first) == axes.end()) {
+            lastRecorded_.erase(it->first);
+            it = lastPublished_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Compared before the snapshot moves on to this sample's positions
+    checkProgress(axes, now, stallTimeout);
+
+    snapshot_->beginWrite();
+    for (int axisNo : axes) {
+        snapshot_->writePosition(axisNo, axisState_->getPosition(axisNo), now);
+    }
+    snapshot_->endWrite();
+
+    if (recorder) {
+        record(*recorder, axes);
+    } else {
+        lastRecorded_.clear();
+    }
+
+    if (now - lastPublishNs_ >= std::chrono::nanoseconds(interval).count()) {
+        lastPublishNs_ = now;
+        publishChanges(axes);
+    }
+}
+
+void PositionPublisher::publishChanges(const std::vector<int>& axes)
+{
+    const AxisStateSnapshot state = snapshot_->read();
+    std::vector<AxisSample> changes;
+    for (int axisNo : axes) {
+        const AxisSnapshotEntry& entry = state[axisNo];
+        auto it = lastPublished_.find(axisNo);
+        if (it != lastPublished_.end() && it->second == entry.positionPulse) continue;
+        lastPublished_[axisNo] = entry.positionPulse;
+        changes.push_back({axisNo, entry.positionPulse, entry.timestampNs});
+    }
+
+    if (!changes.empty() && sink_) {
+        sink_(std::move(changes));
+    }
+}
+
+void PositionPublisher::record(TrajectoryRecorder& recorder, const std::vector<int>& axes)
+{
+    // Status is set by MonitoringScheduler on this same thread; the snapshot
+    // holds both halves with the time of the sample, and reading it here never waits
+    const AxisStateSnapshot state = snapshot_->read();
+    for (int axisNo : axes) {
+        const AxisSnapshotEntry& entry = state[axisNo];
+        auto it = lastRecorded_.find(axisNo);
+        if (it != lastRecorded_.end() && it->second.positionPulse == entry.positionPulse
+            && it->second.status == entry.status) {
+            continue;
+        }
+        lastRecorded_[axisNo] = entry;
+        recorder.append(axisNo, entry.timestampNs, entry.positionPulse, entry.status);
+    }
+}
+
+void PositionPublisher::checkProgress(const std::vector<int>& axes, std::int64_t now, std::chrono::milliseconds stallTimeout)
+{
+    const AxisStateSnapshot state = snapshot_->read();
+    bool moving = false;
+    bool progressed = false;
+    for (int axisNo : axes) {
+        if (state[axisNo].status != AxisMotionStatus::Moving) continue;
+        moving = true;
+        if (state[axisNo].positionPulse != axisState_->getPosition(axisNo)) {
+            progressed = true;
+        }
+    }
+
+    if (!moving || progressed || lastProgressNs_ == 0) {
+        lastProgressNs_ = now;
+        stalled_ = false;
+        return;
+    }
+    if (!stalled_ && now - lastProgressNs_ >= std::chrono::nanoseconds(stallTimeout).count()) {
+        stalled_ = true;
+        if (stallSink_) stallSink_();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef POSITIONPUBLISHER_H
+#define POSITIONPUBLISHER_H
+
+#include "AxisSample.h"
+#include "AxisSnapshot.h"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class AxisState;
+class TrajectoryRecorder;
+
+// Samples AxisState from the io thread at the monitoring tick and hands only
+// the axes whose position changed to the sink, at most once per coalescing
+// interval. The GUI thread is woken only when there is something new to show.
+// Every sample is written to the shared AxisSnapshotBuffer for lock-free
+// multi-axis reads, and, when a TrajectoryRecorder is attached, every change
+// of position or motion status is appended to its history with the snapshot
+// time of the sample that first saw it.
+//
+// It also watches the link: while the scheduler reports an axis as moving, its
+// position must keep changing. When no moving axis has produced a new position
+// for the stall timeout, the monitoring reads are no longer coming back and the
+// stall sink is called once.
+class PositionPublisher : public std::enable_shared_from_this<PositionPublisher>
+{
+public:
+    using Sink = std::function<void(std::vector<AxisSample>&&)>;
+    using StallSink = std::function<void()>;
+
+    PositionPublisher(boost::asio::io_context& ioContext, std::shared_ptr<AxisState> axisState,
+                      std::shared_ptr<AxisSnapshotBuffer> snapshot, Sink sink);
+
+    void start();
+    void stop();
+
+    // Thread-safe; newly added axes are published once even if unchanged.
+    void setAxes(const std::vector<int>& axes);
+    void setCoalescingInterval(std::chrono::milliseconds interval);
+    // Thread-safe; how often AxisState is sampled, normally the monitoring tick
+    void setSampleInterval(std::chrono::milliseconds interval);
+    // Thread-safe; null detaches
+    void setRecorder(std::shared_ptr<TrajectoryRecorder> recorder);
+    // Set before start(); the timeout is thread-safe
+    void setStallSink(StallSink sink) { stallSink_ = std::move(sink); }
+    void setStallTimeout(std::chrono::milliseconds timeout);
+
+private:
+    void scheduleNext();
+    void sample();
+    void publishChanges(const std::vector<int>& axes);
+    void record(TrajectoryRecorder& recorder, const std::vector<int>& axes);
+    void checkProgress(const std::vector<int>& axes, std::int64_t now, std::chrono::milliseconds stallTimeout);
+
+    boost::asio::steady_timer timer_;
+    std::shared_ptr<AxisState> axisState_;
+    std::shared_ptr<AxisSnapshotBuffer> snapshot_;
+    Sink sink_;
+    StallSink stallSink_;
+
+    std::mutex mutex_;
+    std::vector<int> axes_;
+    std::chrono::milliseconds interval_{20};
+    std::chrono::milliseconds sampleInterval_{10};
+    std::chrono::milliseconds stallTimeout_{10000};
+    std::shared_ptr<TrajectoryRecorder> recorder_;
+    bool running_ = false;
+
+    // Only touched on the io thread
+    std::map<int, int> lastPublished_;
+    std::map<int, AxisSnapshotEntry> lastRecorded_;
+    std::int64_t lastPublishNs_ = 0;
+    std::int64_t lastProgressNs_ = 0;   // last time a moving axis changed position, or none was moving
+    bool stalled_ = false;
+};
+
+#endif // POSITIONPUBLISHER_H
@@ -2,11 +2,66 @@
 #include <QStandardPaths>
 #include <QDir>
 #include <QFile>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
 
-PresetManager::PresetManager(QObject *parent) : QObject(parent) {}
+namespace {
+
+bool hasSameSettings(const AxisPreset& a, const AxisPreset& b)
+{
+    return a.motorName == b.motorName && a.isAbsolute == b.isAbsolute
+           && a.value == b.value && a.speed == b.speed;
+}
+
+bool isSamePreset(const AxisPreset& a, const AxisPreset& b)
+{
+    return a.id == b.id && hasSameSettings(a, b);
+}
+
+// The following run on the writer thread.
+
+// QSaveFile writes to a temporary file and renames it over the target on
+// commit, so a crash never leaves a half-written journal.
+void replaceJournal(const QString& journalPath, const QByteArray& image)
+{
+    QSaveFile file(journalPath);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(image);
+        file.commit();
+    }
+}
+
+// A torn append is detected and dropped on the next load
+void appendToJournal(const QString& journalPath, const QByteArray& records)
+{
+    QFile file(journalPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        file.write(records);
+    }
+}
+
+} // namespace
+
+PresetManager::PresetManager(QObject *parent) : QObject(parent)
+{
+    writer_.setMaxThreadCount(1);
+
+    flushTimer_ = new QTimer(this);
+    flushTimer_->setSingleShot(true);
+    flushTimer_->setInterval(500);
+    connect(flushTimer_, &QTimer::timeout, this, &PresetManager::writePending);
+}
+
+PresetManager::~PresetManager()
+{
+    flush();
+}
 
 QString PresetManager::getPresetsDirectory() {
     QString path = "";
@@ -18,53 +73,184 @@ QString PresetManager::getPresetsDirectory() {
     return path;
 }
 
-QString PresetManager::getPresetFilePath(int axisNumber) {
-    return getPresetsDirectory() + QString("/axis_%1.json").arg(axisNumber);
-}
+void PresetManager::ensureLoaded()
+{
+    if (loaded_) return;
+    loaded_ = true;
 
-QList<AxisPreset> PresetManager::loadPresets(int axisNumber) {
-    QList<AxisPreset> presets;
-    QFile file(getPresetFilePath(axisNumber));
-    if (!file.open(QIODevice::ReadOnly)) {
-        return presets;
+    journalPath_ = getPresetsDirectory() + "/presets.journal";
+    if (store_.load(journalPath_)) {
+        // A torn tail is rewritten by the first flush
+        if (store_.needsCompaction()) {
+            rewriteJournal_ = true;
+            scheduleFlush();
+        }
+        return;
+    }
+
+    if (QFile::exists(journalPath_)) {
+        // Not a journal we can read; keep it for inspection instead of overwriting it
+        QFile::remove(journalPath_ + ".bad");
+        QFile::rename(journalPath_, journalPath_ + ".bad");
     }
+    store_.clear();
+    importLegacyFiles();
+    rewriteJournal_ = true;
+    scheduleFlush();
+}
+
+void PresetManager::importLegacyFiles()
+{
+    // One-way: the JSON files are read once and never written again
+    static const QRegularExpression pattern("^axis_(\\d+)\\.json$");
+    QDir dir(getPresetsDirectory());
+    const QStringList files = dir.entryList({"axis_*.json"}, QDir::Files);
+    for (const QString& fileName : files) {
+        const QRegularExpressionMatch match = pattern.match(fileName);
+        if (!match.hasMatch()) continue;
+        const int axisNumber = match.captured(1).toInt();
 
-    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-    QJsonArray array = doc.array();
+        QFile file(dir.filePath(fileName));
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
 
-    for (const QJsonValue &value : array) {
-        QJsonObject obj = value.toObject();
-        AxisPreset preset;
-        preset.id = QUuid(obj["id"].toString());
-        preset.motorName = obj["motorName"].toString();
-        preset.isAbsolute = obj["isAbsolute"].toBool();
-        preset.value = obj["value"].toDouble();
-        preset.speed = obj["speed"].toInt();
-        presets.append(preset);
+        // Files are newest first; insert oldest first so the journal keeps that order
+        for (auto it = array.end(); it != array.begin();) {
+            --it;
+            QJsonObject obj = (*it).toObject();
+            AxisPreset preset;
+            preset.id = QUuid(obj["id"].toString());
+            if (preset.id.isNull()) {
+                preset.id = QUuid::createUuid();
+            }
+            preset.motorName = obj["motorName"].toString();
+            preset.isAbsolute = obj["isAbsolute"].toBool();
+            preset.value = obj["value"].toDouble();
+            preset.speed = obj["speed"].toInt();
+            store_.put(axisNumber, preset);
+        }
+        trimHistory(axisNumber);
     }
-    return presets;
+}
+
+QList<AxisPreset> PresetManager::loadPresets(int axisNumber) {
+    ensureLoaded();
+    return store_.presets(axisNumber);
+}
+
+QList<AxisPreset> PresetManager::presetsForMotor(const QString &motorName)
+{
+    ensureLoaded();
+    return store_.presetsForMotor(motorName);
 }
 
 void PresetManager::savePresets(int axisNumber, const QList<AxisPreset>& presets) {
-    QJsonArray array;
-    for (const AxisPreset &preset : presets) {
-        QJsonObject obj;
-        obj["id"] = preset.id.toString();
-        obj["motorName"] = preset.motorName;
-        obj["isAbsolute"] = preset.isAbsolute;
-        obj["value"] = preset.value;
-        obj["speed"] = preset.speed;
-        array.append(obj);
-    }
-
-    QFile file(getPresetFilePath(axisNumber));
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(array).toJson());
+    ensureLoaded();
+
+    // Only the difference goes to the journal: tombstones for dropped entries,
+    // and re-inserts only if the remaining order or contents changed
+    QSet<QUuid> keep;
+    for (const AxisPreset& preset : presets) {
+        keep.insert(preset.id);
+    }
+    QList<AxisPreset> remaining;
+    const QList<AxisPreset> current = store_.presets(axisNumber);
+    for (const AxisPreset& preset : current) {
+        if (keep.contains(preset.id)) {
+            remaining.append(preset);
+        } else {
+            store_.remove(preset.id);
+        }
+    }
+
+    const bool unchanged = std::equal(remaining.cbegin(), remaining.cend(), presets.cbegin(), presets.cend(), isSamePreset);
+    if (!unchanged) {
+        for (auto it = presets.crbegin(); it != presets.crend(); ++it) {
+            store_.put(axisNumber, *it);
+        }
     }
+    trimHistory(axisNumber);
+    scheduleFlush();
 }
 
 void PresetManager::addPreset(int axisNumber, const AxisPreset &newPreset) {
-    QList<AxisPreset> presets = loadPresets(axisNumber);
-    presets.prepend(newPreset); // Add to the top of the list
-    savePresets(axisNumber, presets);
+    ensureLoaded();
+
+    const QList<AxisPreset> presets = store_.presets(axisNumber);
+    for (int i = 0; i < presets.size(); ++i) {
+        if (hasSameSettings(presets[i], newPreset)) {
+            if (i == 0) return; // Already the most recent entry, nothing to write
+            store_.remove(presets[i].id);
+            break;
+        }
+    }
+    store_.put(axisNumber, newPreset); // Becomes the top of the list
+    trimHistory(axisNumber);
+    scheduleFlush();
+}
+
+void PresetManager::removePreset(const QUuid &id)
+{
+    ensureLoaded();
+    if (store_.remove(id)) {
+        scheduleFlush();
+    }
+}
+
+void PresetManager::setHistoryLimit(int limit)
+{
+    historyLimit_ = qMax(1, limit);
+    if (!loaded_) return;
+    const QList<int> axes = store_.axes();
+    for (int axisNumber : axes) {
+        trimHistory(axisNumber);
+    }
+    scheduleFlush();
+}
+
+void PresetManager::setFlushDelay(int delayMs)
+{
+    flushTimer_->setInterval(qMax(0, delayMs));
+}
+
+void PresetManager::trimHistory(int axisNumber)
+{
+    const QList<AxisPreset> presets = store_.presets(axisNumber);
+    for (int i = historyLimit_; i < presets.size(); ++i) {
+        store_.remove(presets[i].id);
+    }
+}
+
+void PresetManager::scheduleFlush()
+{
+    // Changes made before the timer fires share one write; the timer is not
+    // restarted, so a steady stream of moves still gets flushed
+    if (!flushTimer_->isActive()) {
+        flushTimer_->start();
+    }
+}
+
+void PresetManager::writePending()
+{
+    if (!loaded_) return;
+
+    const QString journalPath = journalPath_;
+    if (rewriteJournal_ || store_.needsCompaction()) {
+        rewriteJournal_ = false;
+        const QByteArray image = store_.compactedImage();
+        writer_.start([journalPath, image]() { replaceJournal(journalPath, image); });
+        return;
+    }
+
+    const QByteArray records = store_.takePendingRecords();
+    if (!records.isEmpty()) {
+        writer_.start([journalPath, records]() { appendToJournal(journalPath, records); });
+    }
+}
+
+void PresetManager::flush()
+{
+    flushTimer_->stop();
+    writePending();
+    writer_.waitForDone();
 }
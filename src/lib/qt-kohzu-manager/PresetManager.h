@@ -4,32 +4,56 @@
 #include <QObject>
 #include <QString>
 #include <QList>
+#include <QThreadPool>
 #include <QUuid>
+#include "AxisPreset.h"
+#include "PresetStore.h"
 
-// 단일 프리셋 데이터를 담는 구조체
-struct AxisPreset {
-    QUuid id;
-    QString motorName;
-    bool isAbsolute;
-    double value;
-    int speed;
-
-    bool operator==(const AxisPreset& other) const { return id == other.id; }
-};
+class QTimer;
 
+// Presets of every axis live in one append-only journal
+// (resources/presets/presets.journal). Changes update the in-memory index at
+// once and are appended to the journal in batches off the GUI thread; the
+// journal is compacted when superseded records dominate. Existing
+// axis_N.json files are imported once when no journal exists yet.
 class PresetManager : public QObject
 {
     Q_OBJECT
 public:
     explicit PresetManager(QObject *parent = nullptr);
+    ~PresetManager();
 
     QList<AxisPreset> loadPresets(int axisNumber);
+    QList<AxisPreset> presetsForMotor(const QString& motorName);
     void savePresets(int axisNumber, const QList<AxisPreset>& presets);
+    // Moves an identical entry (same motor, mode, value and speed) to the top instead of duplicating it
     void addPreset(int axisNumber, const AxisPreset& preset);
+    void removePreset(const QUuid& id);
+
+    // Oldest entries of an axis beyond the limit are dropped (default 100)
+    void setHistoryLimit(int limit);
+    int historyLimit() const { return historyLimit_; }
+    // Changes are written at most this long after the first unsaved one (default 500 ms)
+    void setFlushDelay(int delayMs);
+
+    // Writes every pending change now and waits for the writer to finish
+    void flush();
 
 private:
     QString getPresetsDirectory();
-    QString getPresetFilePath(int axisNumber);
+    void ensureLoaded();
+    void importLegacyFiles();
+    void trimHistory(int axisNumber);
+    void scheduleFlush();
+    void writePending();
+
+    PresetStore store_;
+    bool loaded_ = false;
+    bool rewriteJournal_ = false;
+    QString journalPath_;
+    int historyLimit_ = 100;
+    QTimer* flushTimer_;
+    QThreadPool writer_;   // single thread, so journal writes never overtake each other
 };
 
 #endif // PRESETMANAGER_H
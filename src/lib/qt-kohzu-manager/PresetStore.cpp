@@ -0,0 +1,296 @@
+#include "PresetStore.h"
+#include <QFile>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Journal layout (little endian):
+//   header: "KZPJ" quint16 version
+//   put:    quint8 1, qint32 axis, 16 byte uuid, quint8 isAbsolute,
+//           double value, qint32 speed, quint16 nameLength, UTF-8 name
+//   remove: quint8 2, 16 byte uuid
+constexpr char kMagic[4] = {'K', 'Z', 'P', 'J'};
+constexpr quint16 kVersion = 1;
+constexpr quint8 kOpPut = 1;
+constexpr quint8 kOpRemove = 2;
+constexpr int kUuidSize = 16;
+
+// Compact once superseded records outnumber live ones, but not for tiny journals
+constexpr int kMinDeadRecordsForCompaction = 1024;
+
+template <typename T>
+void appendValue(QByteArray& out, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(T));
+}
+
+void appendUuid(QByteArray& out, const QUuid& id)
+{
+    out.append(id.toRfc4122());
+}
+
+class RecordReader
+{
+public:
+    RecordReader(const char* data, qsizetype size) : data_(data), size_(size) {}
+
+    bool atEnd() const { return offset_ >= size_; }
+    qsizetype offset() const { return offset_; }
+
+    template <typename T>
+    bool read(T& value)
+    {
+        if (size_ - offset_ < qsizetype(sizeof(T))) return false;
+        value = qFromLittleEndian<T>(data_ + offset_);
+        offset_ += sizeof(T);
+        return true;
+    }
+
+    bool readUuid(QUuid& id)
+    {
+        if (size_ - offset_ < kUuidSize) return false;
+        id = QUuid::fromRfc4122(QByteArray::fromRawData(data_ + offset_, kUuidSize));
+        offset_ += kUuidSize;
+        return true;
+    }
+
+    bool readUtf8(qsizetype length, QString& text)
+    {
+        if (size_ - offset_ < length) return false;
+        text = QString::fromUtf8(data_ + offset_, length);
+        offset_ += length;
+        return true;
+    }
+
+private:
+    const char* data_;
+    qsizetype size_;
+    qsizetype offset_ = 0;
+};
+
+} // namespace
+
+QByteArray PresetStore::journalHeader()
+{
+    QByteArray header(kMagic, sizeof(kMagic));
+    appendValue(header, kVersion);
+    return header;
+}
+
+bool PresetStore::load(const QString &journalPath)
+{
+    clear();
+
+    QFile file(journalPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    // One sequential pass over the mapped file; no document tree is built
+    const qint64 size = file.size();
+    const uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray contents;
+    if (!mapped) {
+        contents = file.readAll();
+    }
+    const char* data = mapped ? reinterpret_cast<const char*>(mapped) : contents.constData();
+    const qsizetype length = mapped ? qsizetype(size) : contents.size();
+
+    const QByteArray header = journalHeader();
+    if (length < header.size() || std::memcmp(data, header.constData(), header.size()) != 0) {
+        return false;
+    }
+
+    RecordReader reader(data + header.size(), length - header.size());
+    while (!reader.atEnd()) {
+        quint8 op = 0;
+        QUuid id;
+        bool complete = reader.read(op);
+        if (complete && op == kOpPut) {
+            qint32 axisNumber = 0;
+            quint8 isAbsolute = 0;
+            double value = 0.0;
+            qint32 speed = 0;
+            quint16 nameLength = 0;
+            AxisPreset preset;
+            complete = reader.read(axisNumber) && reader.readUuid(id) && reader.read(isAbsolute)
+                       && reader.read(value) && reader.read(speed) && reader.read(nameLength)
+                       && reader.readUtf8(nameLength, preset.motorName);
+            if (complete) {
+                preset.id = id;
+                preset.isAbsolute = isAbsolute != 0;
+                preset.value = value;
+                preset.speed = speed;
+                applyPut(axisNumber, preset);
+            }
+        } else if (complete && op == kOpRemove) {
+            complete = reader.readUuid(id);
+            if (complete) {
+                applyRemove(id);
+            }
+        } else {
+            complete = false;
+        }
+
+        if (!complete) {
+            // Torn write at the end of the file (or garbage); keep what was read so far
+            truncatedTail_ = true;
+            break;
+        }
+    }
+    return true;
+}
+
+void PresetStore::clear()
+{
+    byId_.clear();
+    byAxis_.clear();
+    byMotor_.clear();
+    nextSequence_ = 1;
+    deadRecords_ = 0;
+    truncatedTail_ = false;
+    pending_.clear();
+}
+
+void PresetStore::put(int axisNumber, const AxisPreset &preset)
+{
+    applyPut(axisNumber, preset);
+    encodePut(pending_, axisNumber, preset);
+}
+
+bool PresetStore::remove(const QUuid &id)
+{
+    if (!applyRemove(id)) {
+        return false;
+    }
+    encodeRemove(pending_, id);
+    return true;
+}
+
+void PresetStore::applyPut(int axisNumber, const AxisPreset &preset)
+{
+    if (applyRemove(preset.id)) {
+        // applyRemove counted the old put; the tombstone it stands for is never written
+        --deadRecords_;
+    }
+
+    Entry entry;
+    entry.axisNumber = axisNumber;
+    entry.sequence = nextSequence_++;
+    entry.preset = preset;
+    byAxis_[axisNumber].insert(entry.sequence, preset.id);
+    byMotor_[preset.motorName].insert(preset.id);
+    byId_.insert(preset.id, entry);
+}
+
+bool PresetStore::applyRemove(const QUuid &id)
+{
+    auto it = byId_.find(id);
+    if (it == byId_.end()) {
+        return false;
+    }
+
+    auto axisIt = byAxis_.find(it->axisNumber);
+    axisIt->remove(it->sequence);
+    if (axisIt->isEmpty()) {
+        byAxis_.erase(axisIt);
+    }
+    auto motorIt = byMotor_.find(it->preset.motorName);
+    motorIt->remove(id);
+    if (motorIt->isEmpty()) {
+        byMotor_.erase(motorIt);
+    }
+    byId_.erase(it);
+
+    // The put that created the entry and this tombstone are both dead weight now
+    deadRecords_ += 2;
+    return true;
+}
+
+QList<AxisPreset> PresetStore::presets(int axisNumber) const
+{
+    QList<AxisPreset> result;
+    auto axisIt = byAxis_.constFind(axisNumber);
+    if (axisIt == byAxis_.cend()) {
+        return result;
+    }
+    result.reserve(axisIt->size());
+    for (auto it = axisIt->cend(); it != axisIt->cbegin();) {
+        --it;
+        result.append(byId_.value(it.value()).preset);
+    }
+    return result;
+}
+
+QList<AxisPreset> PresetStore::presetsForMotor(const QString &motorName) const
+{
+    QMap<quint64, AxisPreset> ordered;
+    for (const QUuid& id : byMotor_.value(motorName)) {
+        const Entry& entry = byId_.constFind(id).value();
+        ordered.insert(entry.sequence, entry.preset);
+    }
+    QList<AxisPreset> result = ordered.values();
+    std::reverse(result.begin(), result.end());
+    return result;
+}
+
+std::optional<AxisPreset> PresetStore::find(const QUuid &id) const
+{
+    auto it = byId_.constFind(id);
+    if (it == byId_.cend()) {
+        return std::nullopt;
+    }
+    return it->preset;
+}
+
+bool PresetStore::needsCompaction() const
+{
+    return truncatedTail_ || (deadRecords_ >= kMinDeadRecordsForCompaction && deadRecords_ > byId_.size());
+}
+
+QByteArray PresetStore::takePendingRecords()
+{
+    QByteArray records;
+    records.swap(pending_);
+    return records;
+}
+
+QByteArray PresetStore::compactedImage()
+{
+    // Oldest first across all axes so replay reproduces every axis order
+    QMap<quint64, const Entry*> ordered;
+    for (auto it = byId_.cbegin(); it != byId_.cend(); ++it) {
+        ordered.insert(it->sequence, &it.value());
+    }
+
+    QByteArray image = journalHeader();
+    for (const Entry* entry : std::as_const(ordered)) {
+        encodePut(image, entry->axisNumber, entry->preset);
+    }
+    deadRecords_ = 0;
+    truncatedTail_ = false;
+    pending_.clear();
+    return image;
+}
+
+void PresetStore::encodePut(QByteArray &out, int axisNumber, const AxisPreset &preset)
+{
+    const QByteArray name = preset.motorName.toUtf8().left(0xFFFF);
+    appendValue(out, kOpPut);
+    appendValue(out, qint32(axisNumber));
+    appendUuid(out, preset.id);
+    appendValue(out, quint8(preset.isAbsolute ? 1 : 0));
+    appendValue(out, preset.value);
+    appendValue(out, qint32(preset.speed));
+    appendValue(out, quint16(name.size()));
+    out.append(name);
+}
+
+void PresetStore::encodeRemove(QByteArray &out, const QUuid &id)
+{
+    appendValue(out, kOpRemove);
+    appendUuid(out, id);
+}
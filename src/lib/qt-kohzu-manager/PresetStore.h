@@ -0,0 +1,77 @@
+#ifndef PRESETSTORE_H
+#define PRESETSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QUuid>
+#include <optional>
+#include "AxisPreset.h"
+
+// In-memory preset index backed by an append-only binary journal.
+//
+// Every change is encoded as one journal record: a put carries the whole
+// preset, a removal is a tombstone carrying only the id. Replaying the
+// journal in order rebuilds the index. Records written since the last
+// takePendingRecords() call are kept in a buffer so the caller decides when
+// and on which thread they hit the disk. Superseded records are counted, and
+// compactedImage() produces a journal holding only the live presets.
+//
+// Not thread-safe; owned by one thread.
+class PresetStore
+{
+public:
+    // Replays a journal file. Returns false if the file is missing or not a
+    // preset journal. A truncated tail is dropped and reported through
+    // needsCompaction() so the next compaction rewrites a clean file.
+    bool load(const QString& journalPath);
+    void clear();
+
+    // Inserts or replaces a preset and makes it the newest entry of its axis
+    void put(int axisNumber, const AxisPreset& preset);
+    // Returns false if the id is unknown
+    bool remove(const QUuid& id);
+
+    // Newest first
+    QList<AxisPreset> presets(int axisNumber) const;
+    QList<AxisPreset> presetsForMotor(const QString& motorName) const;
+    std::optional<AxisPreset> find(const QUuid& id) const;
+    QList<int> axes() const { return byAxis_.keys(); }
+
+    int liveCount() const { return byId_.size(); }
+    int deadCount() const { return deadRecords_; }
+    bool needsCompaction() const;
+
+    // Encoded records not yet handed out; clears the buffer
+    QByteArray takePendingRecords();
+    // A complete journal (header plus one put per live preset, oldest first).
+    // Resets the dead record count and the pending buffer.
+    QByteArray compactedImage();
+
+    static QByteArray journalHeader();
+
+private:
+    struct Entry {
+        int axisNumber = 0;
+        quint64 sequence = 0;
+        AxisPreset preset;
+    };
+
+    void applyPut(int axisNumber, const AxisPreset& preset);
+    bool applyRemove(const QUuid& id);
+    static void encodePut(QByteArray& out, int axisNumber, const AxisPreset& preset);
+    static void encodeRemove(QByteArray& out, const QUuid& id);
+
+    QHash<QUuid, Entry> byId_;
+    QHash<int, QMap<quint64, QUuid>> byAxis_;      // sequence -> id, oldest first
+    QHash<QString, QSet<QUuid>> byMotor_;
+    quint64 nextSequence_ = 1;
+    int deadRecords_ = 0;
+    bool truncatedTail_ = false;
+    QByteArray pending_;
+};
+
+#endif // PRESETSTORE_H
@@ -3,180 +3,888 @@
 #include "core/TcpClient.h"
 #include "protocol/ProtocolHandler.h"
 #include "controller/AxisState.h"
+#include "PositionPublisher.h"
+#include "MonitoringScheduler.h"
+#include "CommandPipeline.h"
+#include "CaptureProxy.h"
+#include "WireCapture.h"
+#include "IoContextPool.h"
+#include "ScanEngine.h"
+#include "SequenceRunner.h"
+#include "HomingPlanner.h"
+#include "TrajectoryRecorder.h"
 #include "spdlog/spdlog.h"
+#include <QTimer>
+#include <future>
+#include <mutex>
+#include <stdexcept>
 
-QtKohzuManager::QtKohzuManager(QObject *parent) : QObject(parent)
+struct QtKohzuManager::ControllerSession {
+    std::shared_ptr<boost::asio::io_context> ioContext;   // declared first so it outlives everything bound to it
+    std::shared_ptr<CaptureProxy> captureProxy;           // outlives the client
+    std::shared_ptr<ICommunicationClient> client;
+    std::shared_ptr<ProtocolHandler> protocolHandler;
+    std::shared_ptr<AxisState> axisState;
+    std::shared_ptr<KohzuController> kohzuController;
+    std::shared_ptr<PositionPublisher> positionPublisher;
+    std::shared_ptr<MonitoringScheduler> monitoringScheduler;
+    std::shared_ptr<CommandPipeline> commandPipeline;
+    std::shared_ptr<ScanEngine> scanEngine;
+    std::shared_ptr<SequenceRunner> sequenceRunner;
+    std::shared_ptr<HomingPlanner> homingPlanner;
+};
+
+// TcpClient::connect blocks, so an attempt may still be stuck in it after its
+// deadline or a disconnect. Abandoning it clears the owner; whatever the
+// attempt produces afterwards is torn down on the io thread and never reaches
+// the manager.
+struct QtKohzuManager::ConnectAttempt {
+    std::mutex mutex;
+    QtKohzuManager* owner = nullptr;
+    std::atomic<bool> finished{false};   // the connect thread is about to return
+};
+
+struct QtKohzuManager::SequenceProgress {
+    QVector<QString> descriptions;            // GUI 스레드에서 만든 뒤 읽기 전용
+    std::atomic<int> latestStep{-1};
+    std::atomic<bool> deliveryScheduled{false};
+};
+
+QtKohzuManager::QtKohzuManager(QObject *parent)
+    : QObject(parent), snapshotBuffer_(std::make_shared<AxisSnapshotBuffer>()),
+      metrics_(std::make_shared<CommandMetrics>()), responses_(std::make_unique<ResponseQueue>())
 {
     qRegisterMetaType<std::string>("std::string");
-    pollTimer_ = new QTimer(this);
-    connect(pollTimer_, &QTimer::timeout, this, &QtKohzuManager::pollPositions);
+    qRegisterMetaType<AxisSample>("AxisSample");
+    qRegisterMetaType<QVector<AxisSample>>("QVector<AxisSample>");
+    qRegisterMetaType<ScanArrival>("ScanArrival");
+
+    reconnectTimer_ = new QTimer(this);
+    reconnectTimer_->setSingleShot(true);
+    connect(reconnectTimer_, &QTimer::timeout, this, &QtKohzuManager::startConnectAttempt);
+}
+
+QtKohzuManager::QtKohzuManager(std::shared_ptr<IoContextPool> pool, QObject *parent)
+    : QtKohzuManager(parent)
+{
+    pool_ = std::move(pool);
 }
 
 QtKohzuManager::~QtKohzuManager()
 {
+    Q_ASSERT(!pool_ || !pool_->isRunning());
     cleanup();
+    joinConnectThreads(true);
+    if (pool_ && ioContext_) {
+        pool_->release(*ioContext_, this);
+        ioContext_.reset();
+    }
 }
 
-void QtKohzuManager::connectToController(const QString &host, quint16 port)
+void QtKohzuManager::setReconnectBackoff(int initialMs, int maxMs)
+{
+    reconnectInitialMs_ = qMax(1, initialMs);
+    reconnectMaxMs_ = qMax(reconnectInitialMs_, maxMs);
+}
+
+void QtKohzuManager::setMonitoringStallTimeout(int timeoutMs)
+{
+    monitoringStallTimeoutMs_ = qMax(1, timeoutMs);
+    if (session_) {
+        session_->positionPublisher->setStallTimeout(std::chrono::milliseconds(monitoringStallTimeoutMs_));
+    }
+}
+
+void QtKohzuManager::ensureIoThread()
 {
-    try {
-        cleanup();
-        ioContext_ = std::make_unique<boost::asio::io_context>();
-        client_ = std::make_shared<TcpClient>(*ioContext_, host.toStdString(), QString::number(port).toStdString());
-        client_->connect(host.toStdString(), QString::number(port).toStdString());
+    if (ioContext_) return;
 
-        protocolHandler_ = std::make_shared<ProtocolHandler>(client_);
-        axisState_ = std::make_shared<AxisState>();
-        kohzuController_ = std::make_shared<KohzuController>(protocolHandler_, axisState_);
+    if (pool_) {
+        // Kept across reconnects; returned to the pool on destruction. The pool
+        // is stopped before this object goes away, so the handler cannot outlive it.
+        boost::asio::io_context& context = pool_->acquire(this, [this](const std::string& what) {
+            const QString reason = QString::fromStdString(what);
+            QMetaObject::invokeMethod(this, [this, reason]() { onLinkLost(reason); }, Qt::QueuedConnection);
+        });
+        ioContext_ = std::shared_ptr<boost::asio::io_context>(pool_, &context);
+        return;
+    }
 
-        ioThread_ = std::make_unique<std::thread>([this]() {
+    ioContext_ = std::make_shared<boost::asio::io_context>();
+    ioThread_ = std::make_unique<std::thread>([this, ioContext = ioContext_.get()]() {
+        // Prevent io_context::run() from returning immediately if there's no work.
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard(ioContext->get_executor());
+        for (;;) {
             try {
-                if(ioContext_) {
-                    // Prevent io_context::run() from returning immediately if there's no work.
-                    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard(ioContext_->get_executor());
-                    ioContext_->run();
-                }
+                ioContext->run();
+                return;
             } catch (const std::exception& e) {
+                // A handler of the connection threw; treat it as a dropped link and keep the thread alive
                 spdlog::error("io_context exception: {}", e.what());
+                const QString reason = QString::fromStdString(e.what());
+                QMetaObject::invokeMethod(this, [this, reason]() { onLinkLost(reason); }, Qt::QueuedConnection);
+            }
+        }
+    });
+}
+
+void QtKohzuManager::connectToController(const QString &host, quint16 port)
+{
+    retireSession(std::move(session_));
+    reconnectTimer_->stop();
+    host_ = host;
+    port_ = port;
+    reconnectAttempt_ = 0;
+    setConnectionState(ConnectionState::Connecting);
+    startConnectAttempt();
+}
+
+void QtKohzuManager::startConnectAttempt()
+{
+    ensureIoThread();
+    abandonConnectAttempt();
+    joinConnectThreads(false);
+
+    const quint64 attemptId = ++connectAttemptId_;
+    const std::string host = host_.toStdString();
+    const std::string port = QString::number(port_).toStdString();
+    const MonitoringConfig monitoringConfig = monitoringConfig_;
+    const PipelineConfig pipelineConfig = pipelineConfig_;
+    const auto coalescing = std::chrono::milliseconds(coalescingIntervalMs_);
+    const auto stallTimeout = std::chrono::milliseconds(monitoringStallTimeoutMs_);
+    auto snapshot = snapshotBuffer_;
+    auto metrics = metrics_;
+    auto captureWriter = captureWriter_;
+    auto trajectoryRecorder = trajectoryRecorder_;
+
+    auto attempt = std::make_shared<ConnectAttempt>();
+    attempt->owner = this;
+    connectAttempt_ = attempt;
+
+    // The deadline is kept here; a connect still blocked when it passes is abandoned
+    const int timeoutMs = connectTimeoutMs_;
+    QTimer::singleShot(timeoutMs, this, [this, attemptId, timeoutMs]() {
+        if (attemptId != connectAttemptId_ || !connectAttempt_) return;
+        abandonConnectAttempt();
+        // A result already on its way to this thread is stale from now on
+        onConnectAttemptFinished(++connectAttemptId_, nullptr, QString("connection timed out after %1 ms").arg(timeoutMs));
+    });
+
+    // Only copies cross over; the manager is reached through attempt->owner alone
+    std::thread thread([attempt, attemptId, host, port, monitoringConfig, pipelineConfig, coalescing, stallTimeout,
+                        snapshot, metrics, captureWriter, trajectoryRecorder, ioContext = ioContext_]() {
+        auto session = std::make_shared<ControllerSession>();
+        std::string error;
+        try {
+            std::string clientHost = host;
+            std::string clientPort = port;
+            if (captureWriter) {
+                // TcpClient talks to the recording relay, which talks to the controller
+                session->captureProxy = std::make_shared<CaptureProxy>(host, port, captureWriter);
+                std::string proxyError;
+                if (!session->captureProxy->start(proxyError)) {
+                    throw std::runtime_error(proxyError);
+                }
+                clientHost = "127.0.0.1";
+                clientPort = std::to_string(session->captureProxy->port());
+            }
+            session->client = std::make_shared<TcpClient>(*ioContext, clientHost, clientPort);
+            session->client->connect(clientHost, clientPort);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+
+        // The rest is built and started on the io thread. The handler holds the
+        // context only weakly, so a context stopped before it runs is still
+        // freed (and the handler with it).
+        boost::asio::io_context& context = *ioContext;
+        std::weak_ptr<boost::asio::io_context> weakContext = ioContext;
+        boost::asio::post(context, [attempt, attemptId, session, error, weakContext, monitoringConfig, pipelineConfig,
+                                    coalescing, stallTimeout, snapshot, metrics, trajectoryRecorder, &context]() mutable {
+            std::lock_guard<std::mutex> lock(attempt->mutex);
+            QtKohzuManager* owner = attempt->owner;
+            if (!owner) {
+                // Abandoned: the connected client is released here, on its own thread
+                return;
+            }
+            if (error.empty()) {
+                try {
+                    session->ioContext = weakContext.lock();
+                    session->protocolHandler = std::make_shared<ProtocolHandler>(session->client);
+                    session->axisState = std::make_shared<AxisState>();
+                    session->kohzuController = std::make_shared<KohzuController>(session->protocolHandler, session->axisState);
+
+                    // Only a batch of changed axes crosses over to the GUI thread
+                    session->positionPublisher = std::make_shared<PositionPublisher>(context, session->axisState, snapshot,
+                        [owner](std::vector<AxisSample>&& changes) {
+                            QVector<AxisSample> samples(changes.begin(), changes.end());
+                            QMetaObject::invokeMethod(owner, [owner, samples]() {
+                                emit owner->positionsUpdated(samples);
+                            }, Qt::QueuedConnection);
+                        });
+                    session->positionPublisher->setCoalescingInterval(coalescing);
+                    session->positionPublisher->setSampleInterval(monitoringConfig.tick);
+                    session->positionPublisher->setRecorder(trajectoryRecorder);
+                    session->positionPublisher->setStallTimeout(stallTimeout);
+                    session->positionPublisher->setStallSink([owner, stallTimeout]() {
+                        const QString reason = QString("no position from a moving axis for %1 ms").arg(stallTimeout.count());
+                        QMetaObject::invokeMethod(owner, [owner, reason]() { owner->onLinkLost(reason); }, Qt::QueuedConnection);
+                    });
+                    session->monitoringScheduler = std::make_shared<MonitoringScheduler>(context, session->kohzuController,
+                                                                                         snapshot, monitoringConfig, metrics);
+                    session->commandPipeline = std::make_shared<CommandPipeline>(context, session->kohzuController,
+                                                                                 pipelineConfig, metrics);
+                    // An axis is polled as moving once its move is sent, not while it waits in the queue
+                    session->commandPipeline->setDispatchHook([scheduler = session->monitoringScheduler](int axisNo, CommandKind kind) {
+                        if (kind != CommandKind::System) scheduler->notifyCommandIssued(axisNo);
+                    });
+                    session->scanEngine = std::make_shared<ScanEngine>(context, session->commandPipeline,
+                                                                       session->monitoringScheduler);
+                    session->sequenceRunner = std::make_shared<SequenceRunner>(context, session->commandPipeline,
+                                                                               session->monitoringScheduler);
+                    session->homingPlanner = std::make_shared<HomingPlanner>(context, session->commandPipeline,
+                                                                             session->monitoringScheduler);
+
+                    session->kohzuController->start();
+                    // The scheduler decides which axes are in the monitor set on every tick
+                    session->kohzuController->startMonitoring({}, static_cast<int>(monitoringConfig.tick.count()));
+                    session->monitoringScheduler->start();
+                    session->positionPublisher->start();
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
             }
+            std::shared_ptr<ControllerSession> result = error.empty() ? session : nullptr;
+            const QString errorText = QString::fromStdString(error);
+            QMetaObject::invokeMethod(owner, [owner, attemptId, result, errorText]() {
+                owner->onConnectAttemptFinished(attemptId, result, errorText);
+            }, Qt::QueuedConnection);
         });
+        attempt->finished.store(true, std::memory_order_release);
+    });
+    connectThreads_.emplace_back(std::move(thread), std::move(attempt));
+}
 
-        kohzuController_->start();
-        // startMonitoring now only takes the period
-        kohzuController_->startMonitoring({}, 100);
-        pollTimer_->start(100);
+void QtKohzuManager::joinConnectThreads(bool wait)
+{
+    // Without wait only finished threads are joined: one may stay blocked in
+    // TcpClient::connect well past its deadline, and this runs on the GUI thread
+    for (auto it = connectThreads_.begin(); it != connectThreads_.end();) {
+        if (wait || it->second->finished.load(std::memory_order_acquire)) {
+            it->first.join();
+            it = connectThreads_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
 
-        emit connectionStatusChanged(true);
-        emit logMessage(QString("Successfully connected to %1:%2").arg(host).arg(port));
+void QtKohzuManager::abandonConnectAttempt()
+{
+    if (!connectAttempt_) return;
+    std::lock_guard<std::mutex> lock(connectAttempt_->mutex);
+    connectAttempt_->owner = nullptr;
+    connectAttempt_.reset();
+}
 
-    } catch (const std::exception& e) {
-        emit logMessage(QString("Connection failed: %1").arg(e.what()));
-        emit connectionStatusChanged(false);
+void QtKohzuManager::onConnectAttemptFinished(quint64 attemptId, std::shared_ptr<ControllerSession> session, const QString &error)
+{
+    // A newer connect/disconnect superseded this attempt
+    if (attemptId != connectAttemptId_ || connectionState_ == ConnectionState::Disconnected) {
+        retireSession(std::move(session));
+        return;
     }
+    connectAttempt_.reset();
+
+    if (!session) {
+        if (connectionState_ == ConnectionState::Reconnecting) {
+            log(LogSeverity::Warning, 0, QString("Reconnect to %1:%2 failed: %3").arg(host_).arg(port_).arg(error));
+            scheduleReconnect();
+        } else {
+            log(LogSeverity::Error, 0, QString("Connection failed: %1").arg(error));
+            setConnectionState(ConnectionState::Disconnected);
+            emit connectionStatusChanged(false);
+        }
+        return;
+    }
+
+    const bool isReconnect = connectionState_ == ConnectionState::Reconnecting;
+    if (isReconnect) {
+        metrics_->recordReconnect();
+    }
+    session_ = session;
+    consecutiveTimeouts_ = 0;
+    reconnectAttempt_ = 0;
+
+    // Re-subscribe the monitored axes and restore controller settings on the new link
+    syncPolledAxes();
+    reapplySystemSettings();
+
+    setConnectionState(ConnectionState::Connected);
+    emit connectionStatusChanged(true);
+    log(LogSeverity::Info, 0,
+        QString("%1 to %2:%3").arg(isReconnect ? "Reconnected" : "Successfully connected").arg(host_).arg(port_));
+}
+
+void QtKohzuManager::onLinkLost(const QString &reason)
+{
+    if (connectionState_ != ConnectionState::Connected) return;
+
+    log(LogSeverity::Warning, 0, QString("Connection to %1:%2 lost: %3").arg(host_).arg(port_).arg(reason));
+    metrics_->recordLinkLoss();
+    retireSession(std::move(session_));
+    setConnectionState(ConnectionState::Reconnecting);
+    scheduleReconnect();
+}
+
+void QtKohzuManager::onCommandTimedOut(int axisNo)
+{
+    log(LogSeverity::Warning, axisNo, QString("Axis %1 command timed out.").arg(axisNo));
+    if (++consecutiveTimeouts_ >= linkLossTimeouts_) {
+        onLinkLost(QString("%1 consecutive command timeouts").arg(consecutiveTimeouts_));
+    }
+}
+
+void QtKohzuManager::scheduleReconnect()
+{
+    // Exponential backoff capped at reconnectMaxMs_
+    const int shift = qMin(reconnectAttempt_, 16);
+    const int delayMs = static_cast<int>(qMin<qint64>(qint64(reconnectInitialMs_) << shift, reconnectMaxMs_));
+    ++reconnectAttempt_;
+    log(LogSeverity::Info, 0, QString("Reconnecting in %1 ms (attempt %2).").arg(delayMs).arg(reconnectAttempt_));
+    reconnectTimer_->start(delayMs);
+}
+
+void QtKohzuManager::retireSession(std::shared_ptr<ControllerSession> session)
+{
+    if (!session) return;
+
+    session->positionPublisher->stop();
+    session->monitoringScheduler->stop();
+    session->scanEngine->abort();
+    session->sequenceRunner->abort();
+    session->homingPlanner->abort();
+    // Holders of a MotionChannel keep this pipeline; it must not take new work
+    session->commandPipeline->close();
+    session->kohzuController->stopMonitoring();
+
+    // Released on its own io thread once the handlers already queued for it
+    // have run. A context that no longer runs cannot race with the destructors,
+    // and a handler posted to it would never run, so the session goes here.
+    // A pool is checked under its own lock, so the post cannot slip in between
+    // the check and stop(); once stopped its threads are joined and the session
+    // is released right here when the rejected handler goes out of scope.
+    boost::asio::io_context& context = *session->ioContext;
+    if (pool_) {
+        auto release = [session = std::move(session)]() mutable { session.reset(); };
+        pool_->post(context, std::move(release));
+    } else if (!context.stopped()) {
+        boost::asio::post(context, [session = std::move(session)]() mutable { session.reset(); });
+    }
+}
+
+bool QtKohzuManager::setCaptureFile(const QString &path)
+{
+    if (path.isEmpty()) {
+        // Sessions that still relay keep the writer alive; closing it stops the recording now
+        if (captureWriter_) captureWriter_->close();
+        captureWriter_.reset();
+        return true;
+    }
+
+    auto writer = std::make_shared<CaptureWriter>();
+    std::string error;
+    if (!writer->open(path.toStdString(), error)) {
+        log(LogSeverity::Error, 0, QString("Cannot record traffic: %1").arg(QString::fromStdString(error)));
+        return false;
+    }
+    if (captureWriter_) captureWriter_->close();
+    captureWriter_ = std::move(writer);
+    log(LogSeverity::Info, 0, QString("Recording controller traffic to %1 from the next connect.").arg(path));
+    return true;
+}
+
+bool QtKohzuManager::startTrajectoryRecording(const QString &filePath, int samplesPerAxis)
+{
+    stopTrajectoryRecording();
+    QString error;
+    auto recorder = TrajectoryRecorder::open(filePath, samplesPerAxis, error);
+    if (!recorder) {
+        log(LogSeverity::Error, 0, QString("Cannot record trajectories: %1").arg(error));
+        return false;
+    }
+    trajectoryRecorder_ = std::move(recorder);
+    if (session_) {
+        session_->positionPublisher->setRecorder(trajectoryRecorder_);
+    }
+    return true;
+}
+
+void QtKohzuManager::stopTrajectoryRecording()
+{
+    // A publisher tick already running keeps the mapping alive until it returns
+    trajectoryRecorder_.reset();
+    if (session_) {
+        session_->positionPublisher->setRecorder(nullptr);
+    }
+}
+
+void QtKohzuManager::reapplySystemSettings()
+{
+    for (auto axisIt = systemSettings_.cbegin(); axisIt != systemSettings_.cend(); ++axisIt) {
+        for (auto it = axisIt->cbegin(); it != axisIt->cend(); ++it) {
+            submitCommand(axisIt.key(), CommandKind::System, 0, 0, it.key(), it.value());
+        }
+    }
+}
+
+void QtKohzuManager::log(LogSeverity severity, int axisNo, const QString &message)
+{
+    emit logEvent(severity, axisNo, message);
+    emit logMessage(message);
+}
+
+void QtKohzuManager::setConnectionState(ConnectionState state)
+{
+    if (connectionState_ == state) return;
+    connectionState_ = state;
+    emit connectionStateChanged(state);
 }
 
 void QtKohzuManager::disconnectFromController()
 {
     cleanup();
+    setConnectionState(ConnectionState::Disconnected);
     emit connectionStatusChanged(false);
-    emit logMessage("Disconnected.");
+    log(LogSeverity::Info, 0, "Disconnected.");
 }
 
 void QtKohzuManager::cleanup()
 {
-    pollTimer_->stop();
+    ++connectAttemptId_;
+    abandonConnectAttempt();
+    joinConnectThreads(false);
+    reconnectTimer_->stop();
+    retireSession(std::move(session_));
+    // A scan still reporting back from the retired session is ignored
+    ++scanId_;
+    scanning_ = false;
+    ++sequenceId_;
+    sequenceRunning_ = false;
+    ++homingId_;
+    homing_ = false;
+
+    // A pooled context keeps serving other connections
+    if (!pool_ && ioContext_) {
+        // The retired session is destroyed by a handler queued above; wait until
+        // it and everything queued before it has run, then stop the context
+        std::promise<void> drained;
+        boost::asio::post(*ioContext_, [&drained]() { drained.set_value(); });
+        drained.get_future().wait();
 
-    if (kohzuController_) {
-        // Stop the monitoring thread first
-        kohzuController_->stopMonitoring();
-    }
-    if (ioContext_) {
         // Signal the io_context to stop, allowing run() to exit
         ioContext_->stop();
+        if (ioThread_ && ioThread_->joinable()) {
+            // Wait for the thread to finish gracefully
+            ioThread_->join();
+        }
+        ioThread_.reset();
+        // A session still on its way to the GUI thread keeps the stopped context alive
+        ioContext_.reset();
+    }
+
+    // Clear the polling list and remembered settings after everything is cleaned up
+    clearPollAxes();
+    systemSettings_.clear();
+}
+
+bool QtKohzuManager::move(int axisNo, int pulse, int speed, bool isAbsolute)
+{
+    return submitCommand(axisNo, isAbsolute ? CommandKind::MoveAbsolute : CommandKind::MoveRelative, pulse, speed, 0, 0);
+}
+
+bool QtKohzuManager::moveOrigin(int axisNo, int speed)
+{
+    return submitCommand(axisNo, CommandKind::Origin, 0, speed, 0, 0);
+}
+
+void QtKohzuManager::setSystem(int axisNo, int systemNo, int value)
+{
+    systemSettings_[axisNo][systemNo] = value;
+    submitCommand(axisNo, CommandKind::System, 0, 0, systemNo, value);
+}
+
+bool QtKohzuManager::submitTagged(quint64 tag, int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value)
+{
+    if (!session_) return false;
+    if (kind == CommandKind::System) {
+        systemSettings_[axisNo][systemNo] = value;
     }
-    if (ioThread_ && ioThread_->joinable()) {
-        // Wait for the thread to finish gracefully
-        ioThread_->join();
+    return submitCommand(axisNo, kind, pulse, speed, systemNo, value, tag);
+}
+
+bool QtKohzuManager::startScan(const ScanDefinition &definition)
+{
+    if (!session_) {
+        log(LogSeverity::Warning, 0, "Scan not started: not connected.");
+        return false;
+    }
+    std::string error;
+    if (!ScanEngine::validate(definition, error)) {
+        log(LogSeverity::Warning, 0, QString("Scan not started: %1").arg(QString::fromStdString(error)));
+        return false;
     }
 
-    // Reset all resources
-    ioThread_.reset();
-    kohzuController_.reset();
-    axisState_.reset();
-    protocolHandler_.reset();
-    client_.reset();
-    ioContext_.reset();
+    const quint64 scanId = ++scanId_;
+    scanning_ = true;
+    log(LogSeverity::Info, 0, QString("Scan started: %1 points.").arg(ScanEngine::pointCount(definition)));
 
-    // Clear the polling list after everything is cleaned up
-    clearPollAxes();
+    session_->scanEngine->start(definition,
+        [this](const ScanArrival& arrival) {
+            QMetaObject::invokeMethod(this, [this, arrival]() { emit scanPointArrived(arrival); }, Qt::QueuedConnection);
+        },
+        [this, scanId](bool completed, const std::string& message) {
+            const QString text = QString::fromStdString(message);
+            QMetaObject::invokeMethod(this, [this, scanId, completed, text]() {
+                if (scanId == scanId_) {
+                    scanning_ = false;
+                }
+                log(completed ? LogSeverity::Info : LogSeverity::Warning, 0,
+                    QString("Scan %1: %2").arg(completed ? "finished" : "stopped", text));
+                emit scanFinished(completed, text);
+            }, Qt::QueuedConnection);
+        });
+    return true;
+}
+
+void QtKohzuManager::abortScan()
+{
+    if (session_) {
+        session_->scanEngine->abort();
+    }
 }
 
-void QtKohzuManager::move(int axisNo, int pulse, int speed, bool isAbsolute)
+bool QtKohzuManager::runSequence(const MotionSequence &sequence)
 {
-    if (!kohzuController_) return;
+    if (!session_) {
+        log(LogSeverity::Warning, 0, "Sequence not started: not connected.");
+        return false;
+    }
 
-    kohzuController_->addAxisToMonitor(axisNo);
+    std::map<int, int> startPulses;
+    const AxisStateSnapshot positions = snapshot();
+    for (int axisNo : sequence.axisNumbers()) {
+        startPulses[axisNo] = positions[axisNo].positionPulse;
+    }
+    // Relative targets are only checked against a start position that is known and will still hold
+    for (int axisNo : sequence.startDependentAxes()) {
+        QString reason;
+        if (positions[axisNo].timestampNs == 0) {
+            reason = "its position has not been read yet";
+        } else if (session_->commandPipeline->pendingCountForAxis(axisNo) > 0) {
+            reason = "it still has commands pending";
+        }
+        if (!reason.isEmpty()) {
+            log(LogSeverity::Warning, axisNo,
+                QString("Sequence not started: axis %1 starts with a relative move but %2.").arg(axisNo).arg(reason));
+            return false;
+        }
+    }
+    std::string error;
+    if (!sequence.validate(startPulses, error)) {
+        log(LogSeverity::Warning, 0, QString("Sequence not started: %1").arg(QString::fromStdString(error)));
+        return false;
+    }
 
-    auto callback = [this, axisNo](const ProtocolResponse& resp) {
-        QMetaObject::invokeMethod(this, "onControllerResponse", Qt::QueuedConnection,
-                                  Q_ARG(int, axisNo), Q_ARG(bool, false),
-                                  Q_ARG(std::string, resp.fullResponse), Q_ARG(char, resp.status));
-    };
-    if (isAbsolute) {
-        kohzuController_->moveAbsolute(axisNo, pulse, speed, 0, callback);
-    } else {
-        kohzuController_->moveRelative(axisNo, pulse, speed, 0, callback);
+    const quint64 sequenceId = ++sequenceId_;
+    sequenceRunning_ = true;
+    log(LogSeverity::Info, 0, QString("Sequence started: %1 steps.").arg(sequence.steps.size()));
+
+    // 스텝마다 GUI 로 이벤트를 보내지 않는다: io 스레드는 최신 스텝만 기록하고
+    // 전달이 대기 중이 아닐 때만 한 번 예약한다.
+    auto progress = std::make_shared<SequenceProgress>();
+    for (const SequenceStep& step : sequence.steps) {
+        progress->descriptions.append(QString::fromStdString(step.description));
+    }
+    session_->sequenceRunner->start(sequence,
+        [this, sequenceId, progress](int stepIndex) {
+            progress->latestStep.store(stepIndex, std::memory_order_release);
+            if (progress->deliveryScheduled.exchange(true, std::memory_order_acq_rel)) {
+                return;
+            }
+            QMetaObject::invokeMethod(this, [this, sequenceId, progress]() {
+                progress->deliveryScheduled.store(false, std::memory_order_release);
+                const int stepIndex = progress->latestStep.load(std::memory_order_acquire);
+                if (sequenceId != sequenceId_ || stepIndex < 0 || stepIndex >= progress->descriptions.size()) {
+                    return;
+                }
+                emit sequenceProgress(stepIndex, progress->descriptions.at(stepIndex));
+            }, Qt::QueuedConnection);
+        },
+        [this, sequenceId](bool completed, const std::string& message) {
+            const QString text = QString::fromStdString(message);
+            QMetaObject::invokeMethod(this, [this, sequenceId, completed, text]() {
+                if (sequenceId != sequenceId_) {
+                    // 새 시퀀스에 밀려난 실행: 현재 실행의 상태를 덮어쓰지 않는다.
+                    return;
+                }
+                sequenceRunning_ = false;
+                log(completed ? LogSeverity::Info : LogSeverity::Warning, 0,
+                    QString("Sequence %1: %2").arg(completed ? "finished" : "stopped", text));
+                emit sequenceFinished(completed, text);
+            }, Qt::QueuedConnection);
+        });
+    return true;
+}
+
+void QtKohzuManager::abortSequence()
+{
+    if (session_) {
+        session_->sequenceRunner->abort();
     }
 }
 
-void QtKohzuManager::moveOrigin(int axisNo, int speed)
+bool QtKohzuManager::startHoming(const HomingPlan &plan)
 {
-    if (!kohzuController_) return;
+    if (!session_) {
+        log(LogSeverity::Warning, 0, "Homing not started: not connected.");
+        return false;
+    }
+    std::string error;
+    if (!HomingPlanner::validate(plan, error)) {
+        log(LogSeverity::Warning, 0, QString("Homing not started: %1").arg(QString::fromStdString(error)));
+        return false;
+    }
 
-    kohzuController_->addAxisToMonitor(axisNo);
+    const quint64 homingId = ++homingId_;
+    homing_ = true;
+    log(LogSeverity::Info, 0, QString("Homing started: %1 axes.").arg(plan.axes.size()));
 
-    auto callback = [this, axisNo](const ProtocolResponse& resp) {
-        QMetaObject::invokeMethod(this, "onControllerResponse", Qt::QueuedConnection,
-                                  Q_ARG(int, axisNo), Q_ARG(bool, true),
-                                  Q_ARG(std::string, resp.fullResponse), Q_ARG(char, resp.status));
-    };
-    kohzuController_->moveOrigin(axisNo, speed, 0, callback);
+    session_->homingPlanner->start(plan,
+        [this](const HomingAxisResult& result) {
+            const double seconds = result.startedNs != 0 ? double(result.finishedNs - result.startedNs) / 1e9 : 0.0;
+            QMetaObject::invokeMethod(this, [this, result, seconds]() {
+                log(result.success ? LogSeverity::Info : LogSeverity::Warning, result.axisNo,
+                    QString("Axis %1 origin return %2 (%3 s).")
+                        .arg(result.axisNo).arg(result.success ? "done" : "failed").arg(seconds, 0, 'f', 1));
+                emit homingAxisFinished(result.axisNo, result.success, seconds);
+            }, Qt::QueuedConnection);
+        },
+        [this, homingId](bool completed, const std::string& message, std::int64_t) {
+            const QString text = QString::fromStdString(message);
+            QMetaObject::invokeMethod(this, [this, homingId, completed, text]() {
+                if (homingId == homingId_) {
+                    homing_ = false;
+                }
+                log(completed ? LogSeverity::Info : LogSeverity::Warning, 0,
+                    QString("Homing %1: %2").arg(completed ? "finished" : "stopped", text));
+                emit homingFinished(completed, text);
+            }, Qt::QueuedConnection);
+        });
+    return true;
 }
 
-void QtKohzuManager::setSystem(int axisNo, int systemNo, int value)
+void QtKohzuManager::abortHoming()
 {
-    if (!kohzuController_) return;
+    if (session_) {
+        session_->homingPlanner->abort();
+    }
+}
+
+bool QtKohzuManager::submitCommand(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value, quint64 tag)
+{
+    if (!session_) return false;
+
+    const bool isMotion = kind != CommandKind::System;
+    const bool isOrigin = kind == CommandKind::Origin;
+    auto scheduler = session_->monitoringScheduler;
+    const std::int64_t enqueuedNs = monotonicNs();
 
-    auto callback = [this, axisNo](const ProtocolResponse& resp) {
-        QMetaObject::invokeMethod(this, "onControllerResponse", Qt::QueuedConnection,
-                                  Q_ARG(int, axisNo), Q_ARG(bool, false),
-                                  Q_ARG(std::string, resp.fullResponse), Q_ARG(char, resp.status));
+    auto callback = [this, tag, axisNo, kind, isMotion, isOrigin, scheduler, enqueuedNs](const CommandResult& result) {
+        if (result.merged) {
+            // The move it was folded into reports the command; only a tagged caller still needs its reply
+            if (tag == 0) return;
+        } else if (isMotion && result.sentNs != 0) {
+            scheduler->notifyCommandFinished(axisNo);
+        }
+        ResponseRecord record;
+        record.tag = tag;
+        record.enqueuedNs = enqueuedNs;
+        record.sentNs = result.sentNs;
+        record.receivedNs = result.receivedNs;
+        record.axisNo = axisNo;
+        record.kind = static_cast<unsigned char>(kind);
+        record.isOrigin = isOrigin;
+        record.timedOut = result.timedOut;
+        record.superseded = result.superseded;
+        record.merged = result.merged;
+        record.status = result.status;
+        record.setText(result.fullResponse);
+        publishResponse(record);
     };
 
-    kohzuController_->setSystem(axisNo, systemNo, value, callback);
+    // User and automation input: queued moves of the axis are merged or replaced
+    if (!session_->commandPipeline->submit(axisNo, kind, pulse, speed, systemNo, value, callback, QueuePolicy::Coalesce)) {
+        metrics_->recordRejected();
+        log(LogSeverity::Warning, axisNo, QString("Axis %1 command rejected: %2 commands pending on the axis, %3 in total.")
+                                              .arg(axisNo)
+                                              .arg(session_->commandPipeline->pendingCountForAxis(axisNo))
+                                              .arg(session_->commandPipeline->pendingCount()));
+        emit commandCompleted(axisNo, isOrigin, false);
+        return false;
+    }
+    return true;
+}
+
+void QtKohzuManager::setPipelineConfig(const PipelineConfig &config)
+{
+    pipelineConfig_ = config;
+    if (session_) {
+        session_->commandPipeline->setConfig(pipelineConfig_);
+    }
+}
+
+int QtKohzuManager::pendingCommandCount() const
+{
+    return session_ ? session_->commandPipeline->pendingCount() : 0;
+}
+
+int QtKohzuManager::pendingCommandCountForAxis(int axisNo) const
+{
+    return session_ ? session_->commandPipeline->pendingCountForAxis(axisNo) : 0;
+}
+
+MotionChannel QtKohzuManager::motionChannel() const
+{
+    MotionChannel channel;
+    if (session_) {
+        channel.ioContext = session_->ioContext;
+        channel.pipeline = session_->commandPipeline;
+        channel.scheduler = session_->monitoringScheduler;
+        channel.snapshot = snapshotBuffer_;
+    }
+    return channel;
+}
+
+int QtKohzuManager::inFlightCommandCount() const
+{
+    return session_ ? session_->commandPipeline->inFlightCount() : 0;
 }
 
 void QtKohzuManager::addAxisToPoll(int axisNo)
 {
     if (!axesToPoll_.contains(axisNo)) {
         axesToPoll_.append(axisNo);
+        syncPolledAxes();
     }
 }
 
 void QtKohzuManager::removeAxisToPoll(int axisNo)
 {
     axesToPoll_.removeAll(axisNo);
+    systemSettings_.remove(axisNo);
+    syncPolledAxes();
 }
 
 void QtKohzuManager::clearPollAxes()
 {
     axesToPoll_.clear();
+    syncPolledAxes();
 }
 
-void QtKohzuManager::pollPositions()
+void QtKohzuManager::setPositionCoalescingInterval(int intervalMs)
 {
-    if (axisState_) {
-        for (int axisNo : std::as_const(axesToPoll_)) {
-            int pos = axisState_->getPosition(axisNo);
-            emit positionUpdated(axisNo, pos);
-        }
+    coalescingIntervalMs_ = qMax(1, intervalMs);
+    if (session_) {
+        session_->positionPublisher->setCoalescingInterval(std::chrono::milliseconds(coalescingIntervalMs_));
     }
 }
 
-void QtKohzuManager::onControllerResponse(int axisNo, bool isOriginCommand, const std::string& fullResponse, char status)
+void QtKohzuManager::setMonitoringConfig(const MonitoringConfig &config)
 {
-    QTimer::singleShot(1000, this, [this, axisNo](){
-        if(kohzuController_){
-            kohzuController_->removeAxisToMonitor(axisNo);
+    monitoringConfig_ = config;
+    if (session_) {
+        session_->monitoringScheduler->setConfig(monitoringConfig_);
+        session_->positionPublisher->setSampleInterval(monitoringConfig_.tick);
+    }
+}
+
+void QtKohzuManager::syncPolledAxes()
+{
+    if (session_) {
+        session_->positionPublisher->setAxes(std::vector<int>(axesToPoll_.begin(), axesToPoll_.end()));
+        session_->monitoringScheduler->setAxes(std::set<int>(axesToPoll_.begin(), axesToPoll_.end()));
+    }
+}
+
+void QtKohzuManager::publishResponse(const ResponseRecord &record)
+{
+    // While earlier records are travelling around the ring, keep using the
+    // fallback so responses are never reordered.
+    if (overflowPending_.load() == 0 && responses_->push(record)) {
+        // One queued call drains everything pushed until the GUI thread gets to it
+        if (!drainScheduled_.exchange(true)) {
+            QMetaObject::invokeMethod(this, [this]() { drainResponses(); }, Qt::QueuedConnection);
         }
-    });
+        return;
+    }
+
+    ++overflowPending_;
+    QMetaObject::invokeMethod(this, [this, record]() {
+        drainResponses();
+        handleResponse(record);
+        --overflowPending_;
+    }, Qt::QueuedConnection);
+}
 
-    QString commandType = isOriginCommand ? "Origin" : "Move";
+void QtKohzuManager::drainResponses()
+{
+    // Cleared before popping: a push racing with this drain either gets popped
+    // here or schedules another drain.
+    drainScheduled_.store(false);
+    ResponseRecord record;
+    while (responses_->pop(record)) {
+        handleResponse(record);
+    }
+}
+
+void QtKohzuManager::handleResponse(const ResponseRecord &record)
+{
+    if (record.merged) {
+        // Counted, logged and announced through the move it was folded into
+        emit commandResult(record.tag, record.axisNo, record.status == 'C',
+                           QString::fromLatin1(record.text, record.length).trimmed());
+        return;
+    }
+    if (record.superseded) {
+        // Replaced by a newer move before it was sent: not a failure, and the
+        // pipeline already counted it. The newer move reports completion.
+        emit commandResult(record.tag, record.axisNo, false, QString::fromLatin1(record.text, record.length).trimmed());
+        log(LogSeverity::Info, record.axisNo, QString("Axis %1 Move command superseded by a newer move.").arg(record.axisNo));
+        return;
+    }
+
+    metrics_->recordCommand(static_cast<CommandKind>(record.kind), record.axisNo, record.status == 'C', record.timedOut,
+                            record.enqueuedNs, record.sentNs, record.receivedNs, monotonicNs());
+
+    if (record.timedOut) {
+        onCommandTimedOut(record.axisNo);
+    } else if (record.status == 'C') {
+        consecutiveTimeouts_ = 0;
+    }
+
+    // Tagged callers are waiting on this reply; answer them before the log line is built
+    if (record.tag != 0) {
+        emit commandResult(record.tag, record.axisNo, record.status == 'C',
+                           QString::fromLatin1(record.text, record.length).trimmed());
+    }
+
+    QString commandType = record.isOrigin ? "Origin" : "Move";
     QString message = QString("Axis %1 %2 command %3. Response: %4")
-                          .arg(axisNo)
+                          .arg(record.axisNo)
                           .arg(commandType)
-                          .arg(status == 'C' ? "completed" : "failed")
-                          .arg(QString::fromStdString(fullResponse).trimmed());
-    emit logMessage(message);
+                          .arg(record.status == 'C' ? "completed" : "failed")
+                          .arg(QString::fromLatin1(record.text, record.length).trimmed());
+    log(record.status == 'C' ? LogSeverity::Info : LogSeverity::Warning, record.axisNo, message);
+    emit commandCompleted(record.axisNo, record.isOrigin, record.status == 'C');
 }
-
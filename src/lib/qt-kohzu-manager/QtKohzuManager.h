@@ -2,17 +2,30 @@
 #define QTKOHZUMANAGER_H
 
 #include <QObject>
+#include <atomic>
 #include <memory>
 #include <thread>
 #include <vector>
 #include <boost/asio.hpp>
 #include <QList>
-#include <QTimer>
+#include <QMap>
+#include <QVector>
+#include "AxisSample.h"
+#include "AxisSnapshot.h"
+#include "MonitoringScheduler.h"
+#include "CommandPipeline.h"
+#include "CommandMetrics.h"
+#include "ResponseRing.h"
+#include "ScanEngine.h"
+#include "MotionSequence.h"
+#include "HomingPlanner.h"
+#include "MotionChannel.h"
 
-class KohzuController;
-class ICommunicationClient;
-class ProtocolHandler;
-class AxisState;
+class CaptureWriter;
+class IoContextPool;
+class TrajectoryRecorder;
+
+class QTimer;
 
 class QtKohzuManager : public QObject
 {
@@ -20,46 +33,191 @@ class QtKohzuManager : public QObject
     Q_PROPERTY(std::string fullResponse READ getFullResponse WRITE setFullResponse)
 
 public:
+    enum class ConnectionState { Disconnected, Connecting, Connected, Reconnecting };
+    Q_ENUM(ConnectionState)
+    enum class LogSeverity { Info, Warning, Error };
+    Q_ENUM(LogSeverity)
+
     explicit QtKohzuManager(QObject *parent = nullptr);
+    // Runs the connection on a context borrowed from a shared pool instead of
+    // a private io thread. The pool must be stopped before this object is
+    // destroyed (MultiControllerManager does this).
+    explicit QtKohzuManager(std::shared_ptr<IoContextPool> pool, QObject *parent = nullptr);
     ~QtKohzuManager();
 
     std::string getFullResponse() const { return ""; }
     void setFullResponse(const std::string& resp) { }
 
+    // Per-axis sampling periods and the shared query budget; applies immediately when connected
+    void setMonitoringConfig(const MonitoringConfig& config);
+    MonitoringConfig monitoringConfig() const { return monitoringConfig_; }
+
+    // In-flight window, queue limit and timeouts of the command channel
+    void setPipelineConfig(const PipelineConfig& config);
+    PipelineConfig pipelineConfig() const { return pipelineConfig_; }
+    int pendingCommandCount() const;
+    int pendingCommandCountForAxis(int axisNo) const;
+    int inFlightCommandCount() const;
+    // Pipeline, scheduler and snapshot of the current connection, for
+    // procedures that run on the io thread (e.g. coroutines); empty when not connected
+    MotionChannel motionChannel() const;
+
+    // Latency histograms and counters; kept across reconnects, safe to read from any thread
+    std::shared_ptr<const CommandMetrics> metrics() const { return metrics_; }
+
+    // Wait-free for the writer: position, motion status and timestamp of every axis from one consistent cut
+    AxisStateSnapshot snapshot() const { return snapshotBuffer_->read(); }
+
+    // Connection handling: connect deadline, reconnect backoff, how many
+    // consecutive command timeouts count as a dropped link, and how long
+    // moving axes may go without a new position before the link counts as lost
+    void setConnectTimeout(int timeoutMs) { connectTimeoutMs_ = qMax(1, timeoutMs); }
+    void setReconnectBackoff(int initialMs, int maxMs);
+    void setLinkLossTimeouts(int count) { linkLossTimeouts_ = qMax(1, count); }
+    void setMonitoringStallTimeout(int timeoutMs);
+    ConnectionState connectionState() const { return connectionState_; }
+
+    // Records all controller traffic to a capture file (see WireCapture.h)
+    // from the next connect on; an empty path stops recording. The file is
+    // kept across reconnects. Returns false if it cannot be created.
+    bool setCaptureFile(const QString& path);
+
+    // Keeps the history of every polled axis in a memory-mapped ring file
+    // (see TrajectoryRecorder.h); recording continues across reconnects.
+    bool startTrajectoryRecording(const QString& filePath, int samplesPerAxis = 65536);
+    void stopTrajectoryRecording();
+    // Null when not recording; exports may run on any thread
+    std::shared_ptr<const TrajectoryRecorder> trajectoryRecorder() const { return trajectoryRecorder_; }
+
+    // Step scan run entirely on the io thread; returns false (with a log line)
+    // if not connected or the definition is out of the motor ranges
+    bool startScan(const ScanDefinition& definition);
+    bool isScanning() const { return scanning_; }
+
+    // Streams a parsed sequence from the io thread. Relative moves are checked
+    // against the current snapshot positions before anything is sent.
+    bool runSequence(const MotionSequence& sequence);
+    bool isSequenceRunning() const { return sequenceRunning_; }
+
+    // Origin return of several axes at once, ordered by the plan's
+    // dependencies (see HomingPlanner.h); returns false (with a log line)
+    // if not connected or the plan is invalid
+    bool startHoming(const HomingPlan& plan);
+    bool isHoming() const { return homing_; }
+
+    // Same as move/moveOrigin/setSystem, but the result is also reported
+    // through commandResult with the caller's tag, so callers with several
+    // commands outstanding per axis can match replies to requests. Returns
+    // false, and reports nothing, when not connected or the queue is full.
+    bool submitTagged(quint64 tag, int axisNo, CommandKind kind, int pulse, int speed, int systemNo = 0, int value = 0);
+
 public slots:
+    // Returns immediately; the result arrives through connectionStatusChanged
     void connectToController(const QString& host, quint16 port);
     void disconnectFromController();
-    void move(int axisNo, int pulse, int speed, bool isAbsolute);
-    void moveOrigin(int axisNo, int speed);
+    // False when not connected or the axis queue is full; the command is dropped
+    bool move(int axisNo, int pulse, int speed, bool isAbsolute);
+    bool moveOrigin(int axisNo, int speed);
     void setSystem(int axisNo, int systemNo, int value);
+    void abortScan();
+    void abortSequence();
+    void abortHoming();
 
     // Slots for MainWindow to manage polling
     void addAxisToPoll(int axisNo);
     void removeAxisToPoll(int axisNo);
     void clearPollAxes();
+    // Upper bound on how often changed positions are delivered (default 20 ms)
+    void setPositionCoalescingInterval(int intervalMs);
 
 signals:
     void connectionStatusChanged(bool connected);
+    void connectionStateChanged(QtKohzuManager::ConnectionState state);
     void logMessage(const QString& message);
-    void positionUpdated(int axisNo, int positionPulse);
-
-private slots:
-    void onControllerResponse(int axisNo, bool isOriginCommand, const std::string& fullResponse, char status);
-    void pollPositions();
+    // The same line with its severity and axis (0 = none), for views that filter
+    void logEvent(QtKohzuManager::LogSeverity severity, int axisNo, const QString& message);
+    // Only axes whose position changed since the last batch are included
+    void positionsUpdated(const QVector<AxisSample>& samples);
+    void commandCompleted(int axisNo, bool isOriginCommand, bool success);
+    void commandResult(quint64 tag, int axisNo, bool success, const QString& response);
+    void scanPointArrived(const ScanArrival& arrival);
+    void scanFinished(bool completed, const QString& message);
+    void sequenceProgress(int stepIndex, const QString& description);
+    void sequenceFinished(bool completed, const QString& message);
+    void homingAxisFinished(int axisNo, bool success, double seconds);
+    void homingFinished(bool completed, const QString& message);
 
 private:
+    // io thread -> GUI thread response channel; sized for a full pipeline window on every axis
+    using ResponseQueue = SpscRing<ResponseRecord, 1024>;
+
+    // Everything that belongs to one TCP connection; rebuilt on reconnect
+    struct ControllerSession;
+    // One connect in progress; its blocking part runs on a thread of its own
+    struct ConnectAttempt;
+    // Latest step of one sequence run, published by the io thread
+    struct SequenceProgress;
+
     void cleanup();
+    void ensureIoThread();
+    void startConnectAttempt();
+    void abandonConnectAttempt();
+    void joinConnectThreads(bool wait);
+    void onConnectAttemptFinished(quint64 attemptId, std::shared_ptr<ControllerSession> session, const QString& error);
+    void onLinkLost(const QString& reason);
+    void onCommandTimedOut(int axisNo);
+    void scheduleReconnect();
+    void retireSession(std::shared_ptr<ControllerSession> session);
+    void reapplySystemSettings();
+    void log(LogSeverity severity, int axisNo, const QString& message);   // emits logEvent and logMessage
+    void setConnectionState(ConnectionState state);
+    void syncPolledAxes();
+    bool submitCommand(int axisNo, CommandKind kind, int pulse, int speed, int systemNo, int value, quint64 tag = 0);
+    void publishResponse(const ResponseRecord& record);   // io thread
+    void drainResponses();                                // GUI thread
+    void handleResponse(const ResponseRecord& record);
 
-    std::unique_ptr<boost::asio::io_context> ioContext_;
+    // The io thread outlives individual connections. Every session shares
+    // ownership of its context, so one released late never sees it freed.
+    std::shared_ptr<IoContextPool> pool_;
+    std::shared_ptr<boost::asio::io_context> ioContext_;   // private, or aliasing one of pool_
     std::unique_ptr<std::thread> ioThread_;
-    std::shared_ptr<ICommunicationClient> client_;
-    std::shared_ptr<ProtocolHandler> protocolHandler_;
-    std::shared_ptr<AxisState> axisState_;
-    std::shared_ptr<KohzuController> kohzuController_;
+    std::shared_ptr<ControllerSession> session_;
+    std::shared_ptr<ConnectAttempt> connectAttempt_;
+    // Connect threads not joined yet, each with its attempt (finished flag)
+    std::vector<std::pair<std::thread, std::shared_ptr<ConnectAttempt>>> connectThreads_;
+    std::shared_ptr<AxisSnapshotBuffer> snapshotBuffer_;
+    std::shared_ptr<CommandMetrics> metrics_;
+    std::shared_ptr<CaptureWriter> captureWriter_;
+    std::shared_ptr<TrajectoryRecorder> trajectoryRecorder_;
+    std::unique_ptr<ResponseQueue> responses_;
+    std::atomic<bool> drainScheduled_{false};
+    std::atomic<int> overflowPending_{0};   // records sent around a full ring, still in flight
 
-    QTimer* pollTimer_;
     QList<int> axesToPoll_;
+    int coalescingIntervalMs_ = 20;
+    MonitoringConfig monitoringConfig_;
+    PipelineConfig pipelineConfig_;
+
+    ConnectionState connectionState_ = ConnectionState::Disconnected;
+    QString host_;
+    quint16 port_ = 0;
+    quint64 connectAttemptId_ = 0;
+    int connectTimeoutMs_ = 3000;
+    int reconnectInitialMs_ = 500;
+    int reconnectMaxMs_ = 30000;
+    int reconnectAttempt_ = 0;
+    int linkLossTimeouts_ = 2;
+    int monitoringStallTimeoutMs_ = 10000;
+    int consecutiveTimeouts_ = 0;
+    QTimer* reconnectTimer_;
+    QMap<int, QMap<int, int>> systemSettings_;   // axis -> (systemNo -> value), re-applied on reconnect
+    quint64 scanId_ = 0;
+    bool scanning_ = false;
+    quint64 sequenceId_ = 0;
+    bool sequenceRunning_ = false;
+    quint64 homingId_ = 0;
+    bool homing_ = false;
 };
 
 #endif // QTKOHZUMANAGER_H
-
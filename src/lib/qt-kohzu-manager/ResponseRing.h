@@ -0,0 +1,85 @@
+#ifndef RESPONSERING_H
+#define RESPONSERING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 컨트롤러 응답 한 건 (io 스레드 → GUI 스레드, 고정 크기)
+struct ResponseRecord {
+    static constexpr std::size_t kMaxText = 95;
+
+    std::uint64_t tag = 0;          // submitTagged 호출자 태그 (0 = 태그 없음)
+    std::int64_t enqueuedNs = 0;    // steady_clock 기준 submit 시각
+    std::int64_t sentNs = 0;        // 컨트롤러로 전송된 시각 (0 = 전송 전 취소)
+    std::int64_t receivedNs = 0;    // io 스레드에서 응답을 받은 시각
+    int axisNo = 0;
+    unsigned char kind = 0;         // CommandKind
+    bool isOrigin = false;
+    bool timedOut = false;
+    bool superseded = false;        // 전송 전에 더 새로운 이동으로 대체됨
+    bool merged = false;            // 뒤의 이동에 합쳐짐; 실행 결과는 그 이동이 한 번만 보고
+    char status = 'E';
+    unsigned char length = 0;
+    char text[kMaxText + 1] = {};
+
+    // Longer responses are truncated; Kohzu replies are well below the limit
+    void setText(const std::string& response)
+    {
+        length = static_cast<unsigned char>(response.size() < kMaxText ? response.size() : kMaxText);
+        std::memcpy(text, response.data(), length);
+        text[length] = '\0';
+    }
+};
+
+// Bounded single-producer/single-consumer ring of preallocated slots.
+//
+// The producer is the io thread, the consumer the GUI thread. Head and tail
+// sit on separate cache lines and each side caches the other's index, so a
+// push or pop normally touches no shared line except the slot itself.
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side. Returns false when the ring is full.
+    bool push(const T& value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == Capacity) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == Capacity) return false;
+        }
+        slots_[tail & (Capacity - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool pop(T& value)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cachedTail_) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head == cachedTail_) return false;
+        }
+        value = slots_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t cachedTail_ = 0;   // consumer's view of tail_
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t cachedHead_ = 0;   // producer's view of head_
+    alignas(64) std::array<T, Capacity> slots_{};
+};
+
+#endif // RESPONSERING_H
@@ -0,0 +1,284 @@
+#include "ScanEngine.h"
+#include "AxisSnapshot.h"
+#include "CommandPipeline.h"
+#include "MonitoringScheduler.h"
+
+namespace {
+
+// start + (stop - start) * index / (points - 1), exact in nano-units
+qint64 positionNanoAt(const ScanAxis& axis, int index)
+{
+    const qint64 start = MotorCatalog::toNano(axis.start);
+    if (axis.points <= 1) return start;
+    const qint64 span = MotorCatalog::toNano(axis.stop) - start;
+    const qint64 intervals = axis.points - 1;
+    return start + span / intervals * index + span % intervals * index / intervals;
+}
+
+bool validateAxis(const MotorCatalog& catalog, const ScanAxis& axis, const char* role, std::string& error)
+{
+    const std::string prefix = std::string(role) + " axis " + std::to_string(axis.axisNo) + ": ";
+    if (axis.axisNo < 1 || axis.axisNo > AxisStateSnapshot::kMaxAxes) {
+        error = prefix + "axis number out of range";
+        return false;
+    }
+    if (axis.points < 1) {
+        error = prefix + "needs at least one point";
+        return false;
+    }
+    if (axis.speed < 0 || axis.speed >= CommandPipeline::kSpeedTables) {
+        error = prefix + "speed table must be 0-" + std::to_string(CommandPipeline::kSpeedTables - 1);
+        return false;
+    }
+    if (axis.motorIndex < 0 || axis.motorIndex >= catalog.size()) {
+        error = prefix + "unknown motor index " + std::to_string(axis.motorIndex);
+        return false;
+    }
+    if (catalog.nanoPerPulse(axis.motorIndex) <= 0) {
+        error = prefix + "motor has no pulse scale";
+        return false;
+    }
+    // Same travel window MainWindow enforces for manual moves
+    const StageMotorInfo& motor = catalog.at(axis.motorIndex);
+    for (double position : {axis.start, axis.stop}) {
+        if (!catalog.inRange(axis.motorIndex, MotorCatalog::toNano(position))) {
+            error = prefix + "position " + std::to_string(position) + " outside 0 ~ "
+                    + MotorCatalog::formatNano(catalog.rangeNano(axis.motorIndex), motor.display_precision).toStdString();
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+ScanEngine::ScanEngine(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+                       std::shared_ptr<MonitoringScheduler> scheduler)
+    : ioContext_(ioContext), pipeline_(std::move(pipeline)), scheduler_(std::move(scheduler)), dwellTimer_(ioContext)
+{
+}
+
+bool ScanEngine::validate(const ScanDefinition& definition, std::string& error)
+{
+    if (!definition.catalog) {
+        error = "no motor catalog";
+        return false;
+    }
+    if (!validateAxis(*definition.catalog, definition.fast, "fast", error)) return false;
+    if (definition.slow) {
+        if (!validateAxis(*definition.catalog, *definition.slow, "slow", error)) return false;
+        if (definition.slow->axisNo == definition.fast.axisNo) {
+            error = "fast and slow axis must differ";
+            return false;
+        }
+    }
+    return true;
+}
+
+int ScanEngine::pointCount(const ScanDefinition& definition)
+{
+    return definition.fast.points * (definition.slow ? definition.slow->points : 1);
+}
+
+void ScanEngine::start(const ScanDefinition& definition, ArrivalSink onArrival, FinishedSink onFinished)
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, definition, onArrival = std::move(onArrival),
+                                   onFinished = std::move(onFinished)]() mutable {
+        if (self->running_) {
+            self->finish(false, "superseded by a new scan");
+        }
+        self->definition_ = definition;
+        self->buildPlan(definition);
+        self->onArrival_ = std::move(onArrival);
+        self->onFinished_ = std::move(onFinished);
+        ++self->generation_;
+        self->running_ = true;
+        self->nextToIssue_ = 0;
+        self->issueWithLookahead(0);
+    });
+}
+
+void ScanEngine::abort()
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self]() {
+        if (self->running_) {
+            self->finish(false, "aborted");
+        }
+    });
+}
+
+void ScanEngine::buildPlan(const ScanDefinition& definition)
+{
+    plan_.clear();
+    const MotorCatalog& catalog = *definition.catalog;
+    const ScanAxis& fast = definition.fast;
+    const int rows = definition.slow ? definition.slow->points : 1;
+    plan_.reserve(static_cast<std::size_t>(fast.points) * rows);
+
+    for (int row = 0; row < rows; ++row) {
+        const bool reversed = definition.pattern == ScanPattern::Snake && row % 2 == 1;
+        for (int k = 0; k < fast.points; ++k) {
+            Step step;
+            step.fastIndex = reversed ? fast.points - 1 - k : k;
+            step.slowIndex = row;
+            const qint64 fastNano = positionNanoAt(fast, step.fastIndex);
+            step.fastPosition = MotorCatalog::fromNano(fastNano);
+            step.fastPulse = catalog.nanoToPulse(fast.motorIndex, fastNano);
+            if (definition.slow) {
+                const qint64 slowNano = positionNanoAt(*definition.slow, row);
+                step.slowPosition = MotorCatalog::fromNano(slowNano);
+                step.slowPulse = catalog.nanoToPulse(definition.slow->motorIndex, slowNano);
+            }
+
+            // Only axes whose target changes are moved; the first point positions both
+            if (plan_.empty()) {
+                step.moveFast = true;
+                step.moveSlow = definition.slow.has_value();
+            } else {
+                step.moveFast = step.fastPulse != plan_.back().fastPulse;
+                step.moveSlow = definition.slow && step.slowPulse != plan_.back().slowPulse;
+            }
+            plan_.push_back(step);
+        }
+    }
+    remainingMoves_.assign(plan_.size(), 0);
+}
+
+bool ScanEngine::canChain(std::size_t index) const
+{
+    // A move may wait in the pipeline behind the previous one only if both
+    // move the fast axis alone; anything else has to wait for the arrival.
+    if (!definition_.lookahead || definition_.dwell.count() > 0) return false;
+    if (index == 0 || index >= plan_.size()) return false;
+    const Step& previous = plan_[index - 1];
+    const Step& step = plan_[index];
+    return previous.moveFast && !previous.moveSlow && step.moveFast && !step.moveSlow;
+}
+
+void ScanEngine::issueWithLookahead(std::size_t index)
+{
+    issue(index);
+    if (running_ && canChain(index + 1)) {
+        issue(index + 1);
+    }
+}
+
+void ScanEngine::issue(std::size_t index)
+{
+    const Step& step = plan_[index];
+    const std::uint64_t generation = generation_;
+    nextToIssue_ = index + 1;
+    remainingMoves_[index] = (step.moveFast ? 1 : 0) + (step.moveSlow ? 1 : 0);
+
+    if (remainingMoves_[index] == 0) {
+        std::weak_ptr<ScanEngine> weakSelf = shared_from_this();
+        boost::asio::post(ioContext_, [weakSelf, generation, index]() {
+            auto self = weakSelf.lock();
+            if (self && self->running_ && self->generation_ == generation) {
+                self->arrive(index);
+            }
+        });
+        return;
+    }
+
+    auto submitMove = [&](const ScanAxis& axis, int pulse) {
+        std::weak_ptr<ScanEngine> weakSelf = shared_from_this();
+        auto scheduler = scheduler_;
+        const int axisNo = axis.axisNo;
+        const bool accepted = pipeline_->submit(axisNo, CommandKind::MoveAbsolute, pulse, axis.speed, 0, 0,
+            [weakSelf, scheduler, axisNo, generation, index](const CommandResult& result) {
+                if (result.sentNs != 0) scheduler->notifyCommandFinished(axisNo);
+                if (auto self = weakSelf.lock()) {
+                    self->onMoveDone(generation, index, result.status, result.fullResponse);
+                }
+            }, QueuePolicy::Keep, this);
+        if (!accepted) {
+            finish(false, "command queue full at axis " + std::to_string(axisNo));
+        }
+        return accepted;
+    };
+
+    if (step.moveFast && !submitMove(definition_.fast, step.fastPulse)) return;
+    if (step.moveSlow && running_) submitMove(*definition_.slow, step.slowPulse);
+}
+
+void ScanEngine::onMoveDone(std::uint64_t generation, std::size_t index, char status, const std::string& response)
+{
+    if (!running_ || generation != generation_) {
+        return;
+    }
+    if (status != 'C') {
+        finish(false, "move to point " + std::to_string(index) + " failed: " + response);
+        return;
+    }
+    if (--remainingMoves_[index] == 0) {
+        arrive(index);
+    }
+}
+
+void ScanEngine::arrive(std::size_t index)
+{
+    const Step& step = plan_[index];
+    ScanArrival arrival;
+    arrival.pointIndex = static_cast<int>(index);
+    arrival.pointCount = static_cast<int>(plan_.size());
+    arrival.fastIndex = step.fastIndex;
+    arrival.slowIndex = step.slowIndex;
+    arrival.fastPosition = step.fastPosition;
+    arrival.slowPosition = step.slowPosition;
+    arrival.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (onArrival_) {
+        onArrival_(arrival);
+    }
+
+    if (index + 1 == plan_.size()) {
+        finish(true, "completed");
+        return;
+    }
+
+    if (nextToIssue_ > index + 1) {
+        // The next move was chained and is already running; keep one queued behind it
+        if (canChain(nextToIssue_)) {
+            issue(nextToIssue_);
+        }
+        return;
+    }
+
+    if (definition_.dwell.count() > 0) {
+        std::weak_ptr<ScanEngine> weakSelf = shared_from_this();
+        const std::uint64_t generation = generation_;
+        dwellTimer_.expires_after(definition_.dwell);
+        dwellTimer_.async_wait([weakSelf, generation, index](const boost::system::error_code& ec) {
+            auto self = weakSelf.lock();
+            if (!ec && self && self->running_ && self->generation_ == generation) {
+                self->issueWithLookahead(index + 1);
+            }
+        });
+        return;
+    }
+    issueWithLookahead(index + 1);
+}
+
+void ScanEngine::finish(bool completed, const std::string& message)
+{
+    running_ = false;
+    ++generation_;
+    dwellTimer_.cancel();
+    if (!completed) {
+        // Drop this scan's chained moves that have not been sent yet
+        pipeline_->cancelQueuedForAxis(definition_.fast.axisNo, this);
+        if (definition_.slow) {
+            pipeline_->cancelQueuedForAxis(definition_.slow->axisNo, this);
+        }
+    }
+
+    FinishedSink onFinished = std::move(onFinished_);
+    onArrival_ = nullptr;
+    onFinished_ = nullptr;
+    if (onFinished) {
+        onFinished(completed, message);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef SCANENGINE_H
+#define SCANENGINE_H
+
+#include "MotorCatalog.h"
+#include <QMetaType>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+class CommandPipeline;
+class MonitoringScheduler;
+
+// 스캔 축 정의 (물리 단위, start/stop 포함 points개 지점)
+struct ScanAxis {
+    int axisNo = 1;
+    int motorIndex = MotorCatalog::kDefaultIndex;   // ScanDefinition::catalog 의 모터 (단위 변환, 범위 검사)
+    double start = 0.0;
+    double stop = 0.0;
+    int points = 1;
+    int speed = 9;          // 속도 테이블 번호 (0~9)
+};
+
+enum class ScanPattern {
+    Raster,     // 매 줄마다 fast 축이 시작점으로 복귀
+    Snake       // 줄마다 fast 축 방향 반전
+};
+
+// 1D (slow 없음) 또는 2D 스캔 정의
+struct ScanDefinition {
+    std::shared_ptr<const MotorCatalog> catalog = MotorCatalog::shared();
+    ScanAxis fast;
+    std::optional<ScanAxis> slow;
+    ScanPattern pattern = ScanPattern::Snake;
+    std::chrono::milliseconds dwell{0};   // 도착 후 다음 이동까지 대기 (측정 시간)
+    bool lookahead = true;                 // dwell 0일 때 다음 이동을 미리 대기열에 넣음
+};
+
+// 한 지점 도착 이벤트
+struct ScanArrival {
+    int pointIndex = 0;
+    int pointCount = 0;
+    int fastIndex = 0;
+    int slowIndex = 0;
+    double fastPosition = 0.0;
+    double slowPosition = 0.0;
+    std::int64_t timestampNs = 0;   // steady_clock 기준 도착 시각
+};
+
+Q_DECLARE_METATYPE(ScanArrival)
+
+// Runs a step scan on the io thread.
+//
+// The whole scan is converted to pulse targets before the first move, so
+// moving on to the next point is only a pipeline submit made from the
+// completion handler of the previous one; the GUI thread is not involved
+// between points. When there is no dwell and consecutive points move only
+// the fast axis, the next move is queued in the pipeline while the current
+// one is still running and goes out as soon as its response arrives.
+class ScanEngine : public std::enable_shared_from_this<ScanEngine>
+{
+public:
+    using ArrivalSink = std::function<void(const ScanArrival&)>;
+    using FinishedSink = std::function<void(bool completed, const std::string& message)>;
+
+    ScanEngine(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+               std::shared_ptr<MonitoringScheduler> scheduler);
+
+    // Validates the definition against the motor ranges; on failure returns
+    // false with a reason and nothing is started.
+    static bool validate(const ScanDefinition& definition, std::string& error);
+    static int pointCount(const ScanDefinition& definition);
+
+    // Thread-safe. A scan already running is aborted first.
+    void start(const ScanDefinition& definition, ArrivalSink onArrival, FinishedSink onFinished);
+    void abort();
+
+private:
+    struct Step {
+        int fastIndex = 0;
+        int slowIndex = 0;
+        int fastPulse = 0;
+        int slowPulse = 0;
+        double fastPosition = 0.0;
+        double slowPosition = 0.0;
+        bool moveFast = false;
+        bool moveSlow = false;
+    };
+
+    void buildPlan(const ScanDefinition& definition);
+    bool canChain(std::size_t index) const;
+    void issue(std::size_t index);
+    void issueWithLookahead(std::size_t index);
+    void onMoveDone(std::uint64_t generation, std::size_t index, char status, const std::string& response);
+    void arrive(std::size_t index);
+    void finish(bool completed, const std::string& message);
+
+    boost::asio::io_context& ioContext_;
+    std::shared_ptr<CommandPipeline> pipeline_;
+    std::shared_ptr<MonitoringScheduler> scheduler_;
+    boost::asio::steady_timer dwellTimer_;
+
+    // io thread only
+    ScanDefinition definition_;
+    std::vector<Step> plan_;
+    std::vector<int> remainingMoves_;   // per step, moves not yet confirmed
+    std::size_t nextToIssue_ = 0;
+    std::uint64_t generation_ = 0;
+    bool running_ = false;
+    ArrivalSink onArrival_;
+    FinishedSink onFinished_;
+};
+
+#endif // SCANENGINE_H
@@ -0,0 +1,203 @@
+#include "SequenceRunner.h"
+#include "CommandPipeline.h"
+#include "MonitoringScheduler.h"
+
+namespace {
+// Retry interval when the pipeline is full of commands that are not ours
+constexpr std::chrono::milliseconds kQueueRetry{10};
+}
+
+SequenceRunner::SequenceRunner(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+                               std::shared_ptr<MonitoringScheduler> scheduler)
+    : ioContext_(ioContext), pipeline_(std::move(pipeline)), scheduler_(std::move(scheduler)), timer_(ioContext)
+{
+}
+
+void SequenceRunner::start(MotionSequence sequence, ProgressSink onProgress, FinishedSink onFinished)
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self, sequence = std::move(sequence), onProgress = std::move(onProgress),
+                                   onFinished = std::move(onFinished)]() mutable {
+        if (self->running_) {
+            self->finish(false, "superseded by a new sequence");
+        }
+        self->sequence_ = std::move(sequence);
+        self->loopRemaining_.assign(self->sequence_.steps.size(), 0);
+        self->onProgress_ = std::move(onProgress);
+        self->onFinished_ = std::move(onFinished);
+        self->pc_ = 0;
+        self->blocked_ = Blocked::No;
+        ++self->generation_;
+        self->running_ = true;
+        self->run();
+    });
+}
+
+void SequenceRunner::abort()
+{
+    auto self = shared_from_this();
+    boost::asio::post(ioContext_, [self]() {
+        if (self->running_) {
+            self->finish(false, "aborted");
+        }
+    });
+}
+
+void SequenceRunner::run()
+{
+    blocked_ = Blocked::No;
+    while (running_ && pc_ < sequence_.steps.size()) {
+        const SequenceStep& step = sequence_.steps[pc_];
+        switch (step.type) {
+        case SequenceStep::Type::Move:
+        case SequenceStep::Type::Origin:
+        case SequenceStep::Type::System:
+            if (!submit(step)) {
+                // Resumed by our next completion, or by a timer if none is outstanding
+                blocked_ = Blocked::QueueFull;
+                if (outstandingTotal_ == 0) {
+                    std::weak_ptr<SequenceRunner> weakSelf = shared_from_this();
+                    const std::uint64_t generation = generation_;
+                    timer_.expires_after(kQueueRetry);
+                    timer_.async_wait([weakSelf, generation](const boost::system::error_code& ec) {
+                        auto self = weakSelf.lock();
+                        if (!ec && self && self->running_ && self->generation_ == generation) {
+                            self->run();
+                        }
+                    });
+                }
+                return;
+            }
+            break;
+        case SequenceStep::Type::Wait:
+            if (!waitSatisfied(step)) {
+                blocked_ = Blocked::Wait;
+                return;
+            }
+            break;
+        case SequenceStep::Type::Delay: {
+            if (onProgress_) onProgress_(static_cast<int>(pc_));
+            blocked_ = Blocked::Delay;
+            ++pc_;
+            std::weak_ptr<SequenceRunner> weakSelf = shared_from_this();
+            const std::uint64_t generation = generation_;
+            timer_.expires_after(step.delay);
+            timer_.async_wait([weakSelf, generation](const boost::system::error_code& ec) {
+                auto self = weakSelf.lock();
+                if (!ec && self && self->running_ && self->generation_ == generation) {
+                    self->run();
+                }
+            });
+            return;
+        }
+        case SequenceStep::Type::LoopBegin:
+            loopRemaining_[pc_] = step.count;
+            break;
+        case SequenceStep::Type::LoopEnd:
+            if (--loopRemaining_[step.match] > 0) {
+                pc_ = static_cast<std::size_t>(step.match) + 1;
+                continue;
+            }
+            break;
+        }
+        if (onProgress_ && step.type != SequenceStep::Type::LoopEnd) {
+            onProgress_(static_cast<int>(pc_));
+        }
+        ++pc_;
+    }
+
+    if (running_ && pc_ >= sequence_.steps.size() && outstandingTotal_ == 0) {
+        finish(true, "completed");
+    }
+    // Otherwise the last completions finish the sequence in onCommandDone
+}
+
+bool SequenceRunner::submit(const SequenceStep& step)
+{
+    CommandKind kind = CommandKind::System;
+    if (step.type == SequenceStep::Type::Move) {
+        kind = step.isAbsolute ? CommandKind::MoveAbsolute : CommandKind::MoveRelative;
+    } else if (step.type == SequenceStep::Type::Origin) {
+        kind = CommandKind::Origin;
+    }
+    const bool isMotion = kind != CommandKind::System;
+    const int axisNo = step.axisNo;
+    const std::uint64_t generation = generation_;
+    std::weak_ptr<SequenceRunner> weakSelf = shared_from_this();
+    auto scheduler = scheduler_;
+
+    const bool accepted = pipeline_->submit(axisNo, kind, step.pulse, step.speed, step.systemNo, step.value,
+        [weakSelf, scheduler, isMotion, axisNo, generation](const CommandResult& result) {
+            if (isMotion && result.sentNs != 0) {
+                scheduler->notifyCommandFinished(axisNo);
+            }
+            if (auto self = weakSelf.lock()) {
+                self->onCommandDone(generation, axisNo, result.status, result.fullResponse);
+            }
+        }, QueuePolicy::Keep, this);
+    if (!accepted) {
+        return false;
+    }
+    ++outstanding_[axisNo];
+    ++outstandingTotal_;
+    return true;
+}
+
+void SequenceRunner::onCommandDone(std::uint64_t generation, int axisNo, char status, const std::string& response)
+{
+    if (generation != generation_) {
+        return;
+    }
+    --outstanding_[axisNo];
+    --outstandingTotal_;
+    if (!running_) {
+        return;
+    }
+    if (status != 'C') {
+        finish(false, "axis " + std::to_string(axisNo) + " command failed: " + response);
+        return;
+    }
+    if (blocked_ == Blocked::QueueFull || blocked_ == Blocked::Wait) {
+        run();
+    } else if (blocked_ == Blocked::No && pc_ >= sequence_.steps.size() && outstandingTotal_ == 0) {
+        finish(true, "completed");
+    }
+}
+
+bool SequenceRunner::waitSatisfied(const SequenceStep& step) const
+{
+    if (step.axes.empty()) {
+        return outstandingTotal_ == 0;
+    }
+    for (int axisNo : step.axes) {
+        auto it = outstanding_.find(axisNo);
+        if (it != outstanding_.end() && it->second > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SequenceRunner::finish(bool completed, const std::string& message)
+{
+    running_ = false;
+    timer_.cancel();
+    if (!completed) {
+        // Drop what the sequence still has queued; commands already sent run to completion
+        for (const auto& [axisNo, count] : outstanding_) {
+            if (count > 0) {
+                pipeline_->cancelQueuedForAxis(axisNo, this);
+            }
+        }
+    }
+    ++generation_;
+    outstanding_.clear();
+    outstandingTotal_ = 0;
+
+    FinishedSink onFinished = std::move(onFinished_);
+    onProgress_ = nullptr;
+    onFinished_ = nullptr;
+    if (onFinished) {
+        onFinished(completed, message);
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef SEQUENCERUNNER_H
+#define SEQUENCERUNNER_H
+
+#include "MotionSequence.h"
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class CommandPipeline;
+class MonitoringScheduler;
+
+// Executes a MotionSequence on the io thread.
+//
+// Commands are streamed into the CommandPipeline back to back until a wait or
+// delay step blocks; completions arriving on the io thread resume the program.
+// The GUI thread only receives progress notifications; the progress sink runs
+// once per executed step on the io thread and must stay cheap. If the pipeline queue
+// is full the runner pauses until one of its own commands completes.
+class SequenceRunner : public std::enable_shared_from_this<SequenceRunner>
+{
+public:
+    using ProgressSink = std::function<void(int stepIndex)>;
+    using FinishedSink = std::function<void(bool completed, const std::string& message)>;
+
+    SequenceRunner(boost::asio::io_context& ioContext, std::shared_ptr<CommandPipeline> pipeline,
+                   std::shared_ptr<MonitoringScheduler> scheduler);
+
+    // Thread-safe. A sequence already running is aborted first.
+    void start(MotionSequence sequence, ProgressSink onProgress, FinishedSink onFinished);
+    void abort();
+
+private:
+    enum class Blocked { No, QueueFull, Wait, Delay };
+
+    void run();
+    bool submit(const SequenceStep& step);
+    void onCommandDone(std::uint64_t generation, int axisNo, char status, const std::string& response);
+    bool waitSatisfied(const SequenceStep& step) const;
+    void finish(bool completed, const std::string& message);
+
+    boost::asio::io_context& ioContext_;
+    std::shared_ptr<CommandPipeline> pipeline_;
+    std::shared_ptr<MonitoringScheduler> scheduler_;
+    boost::asio::steady_timer timer_;
+
+    // io thread only
+    MotionSequence sequence_;
+    std::size_t pc_ = 0;
+    std::vector<int> loopRemaining_;     // indexed by LoopBegin
+    std::map<int, int> outstanding_;     // axis -> commands sent and not yet answered
+    int outstandingTotal_ = 0;
+    Blocked blocked_ = Blocked::No;
+    std::uint64_t generation_ = 0;
+    bool running_ = false;
+    ProgressSink onProgress_;
+    FinishedSink onFinished_;
+};
+
+#endif // SEQUENCERUNNER_H
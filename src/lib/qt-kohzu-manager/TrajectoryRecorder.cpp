@@ -0,0 +1,274 @@
+#include "TrajectoryRecorder.h"
+#include "LatencyHistogram.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'Z', 'T', 'R', 'A', 'J', '0', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr qint64 kFileHeaderSize = 64;
+constexpr qint64 kRingHeaderSize = 64;
+
+struct FileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t axisCount;
+    std::uint32_t capacity;
+};
+
+// Binary export: "KZTRJX01" then one record per sample, little-endian
+constexpr char kExportMagic[8] = {'K', 'Z', 'T', 'R', 'J', 'X', '0', '1'};
+
+void putLe(char* out, std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<char>(value >> (8 * i));
+    }
+}
+
+const char* statusName(AxisMotionStatus status)
+{
+    switch (status) {
+    case AxisMotionStatus::Idle: return "idle";
+    case AxisMotionStatus::Moving: return "moving";
+    case AxisMotionStatus::Settling: return "settling";
+    case AxisMotionStatus::Unknown: break;
+    }
+    return "unknown";
+}
+
+} // namespace
+
+// Lives inside the mapping; both words of a slot are atomics so a concurrent
+// export never reads a torn value, only a stale or overwritten one.
+struct TrajectoryRecorder::Ring {
+    struct Slot {
+        std::atomic<std::int64_t> timestampNs;
+        std::atomic<std::uint64_t> packed;   // pulse (low 32 bits) | status (high 32 bits)
+    };
+
+    alignas(64) std::atomic<std::uint64_t> head;   // samples ever written
+    Slot* slots() { return reinterpret_cast<Slot*>(reinterpret_cast<uchar*>(this) + kRingHeaderSize); }
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "ring atomics must be plain memory");
+
+std::shared_ptr<TrajectoryRecorder> TrajectoryRecorder::open(const QString &filePath, int samplesPerAxis, QString &error)
+{
+    std::shared_ptr<TrajectoryRecorder> recorder(new TrajectoryRecorder());
+    // A multiple of 4 slots keeps every ring on a 64-byte boundary
+    recorder->capacity_ = (std::max(samplesPerAxis, 16) + 3) & ~3;
+    const qint64 ringSize = kRingHeaderSize + qint64(recorder->capacity_) * qint64(sizeof(Ring::Slot));
+    const qint64 fileSize = kFileHeaderSize + ringSize * kMaxAxes;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile& file = recorder->file_;
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::ReadWrite)) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return nullptr;
+    }
+
+    // Reuse the history only if the geometry matches; otherwise start over
+    FileHeader existing = {};
+    const bool matches = file.size() == fileSize
+                         && file.read(reinterpret_cast<char*>(&existing), sizeof(existing)) == qint64(sizeof(existing))
+                         && std::memcmp(existing.magic, kMagic, sizeof(kMagic)) == 0
+                         && existing.version == kVersion && existing.axisCount == std::uint32_t(kMaxAxes)
+                         && existing.capacity == std::uint32_t(recorder->capacity_);
+    if (!matches) {
+        if (!file.resize(0) || !file.resize(fileSize)) {
+            error = QString("%1: %2").arg(filePath, file.errorString());
+            return nullptr;
+        }
+    }
+
+    recorder->base_ = file.map(0, fileSize);
+    if (!recorder->base_) {
+        error = QString("%1: cannot map: %2").arg(filePath, file.errorString());
+        return nullptr;
+    }
+    if (!matches) {
+        // resize() zero-fills, so every ring starts with head = 0
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kVersion;
+        header.axisCount = kMaxAxes;
+        header.capacity = static_cast<std::uint32_t>(recorder->capacity_);
+        std::memcpy(recorder->base_, &header, sizeof(header));
+    }
+
+    const auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+    recorder->wallClockOffsetNs_ = wallNs - monotonicNs();
+    return recorder;
+}
+
+TrajectoryRecorder::~TrajectoryRecorder()
+{
+    if (base_) {
+        file_.unmap(base_);
+    }
+}
+
+TrajectoryRecorder::Ring *TrajectoryRecorder::ring(int axisNo) const
+{
+    const qint64 ringSize = kRingHeaderSize + qint64(capacity_) * qint64(sizeof(Ring::Slot));
+    return reinterpret_cast<Ring*>(base_ + kFileHeaderSize + ringSize * (axisNo - 1));
+}
+
+void TrajectoryRecorder::append(int axisNo, std::int64_t timestampNs, int positionPulse, AxisMotionStatus status)
+{
+    if (axisNo < 1 || axisNo > kMaxAxes) return;
+
+    Ring* r = ring(axisNo);
+    const std::uint64_t head = r->head.load(std::memory_order_relaxed);
+    Ring::Slot& slot = r->slots()[head % std::uint64_t(capacity_)];
+    slot.timestampNs.store(toWallClockNs(timestampNs), std::memory_order_relaxed);
+    slot.packed.store(std::uint64_t(std::uint32_t(positionPulse)) | (std::uint64_t(std::uint32_t(status)) << 32),
+                      std::memory_order_relaxed);
+    r->head.store(head + 1, std::memory_order_release);
+}
+
+std::uint64_t TrajectoryRecorder::samplesWritten(int axisNo) const
+{
+    if (axisNo < 1 || axisNo > kMaxAxes) return 0;
+    return ring(axisNo)->head.load(std::memory_order_acquire);
+}
+
+bool TrajectoryRecorder::copyRange(int axisNo, std::uint64_t begin, std::uint64_t end, Sample *out,
+                                   std::uint64_t &validBegin) const
+{
+    Ring* r = ring(axisNo);
+    Ring::Slot* slots = r->slots();
+    for (std::uint64_t i = begin; i < end; ++i) {
+        const Ring::Slot& slot = slots[i % std::uint64_t(capacity_)];
+        const std::uint64_t packed = slot.packed.load(std::memory_order_relaxed);
+        out[i - begin].timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        out[i - begin].positionPulse = static_cast<int>(std::uint32_t(packed));
+        out[i - begin].status = static_cast<AxisMotionStatus>(std::uint32_t(packed >> 32));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    // The slot of index `head` may be mid-write, so only indices above
+    // head - capacity are known to be intact
+    const std::uint64_t head = r->head.load(std::memory_order_relaxed);
+    const std::uint64_t intact = head + 1 > std::uint64_t(capacity_) ? head + 1 - capacity_ : 0;
+    if (begin >= intact) return true;
+    validBegin = intact;
+    return false;
+}
+
+std::uint64_t TrajectoryRecorder::firstAtOrAfter(int axisNo, std::int64_t fromNs, std::uint64_t begin,
+                                                 std::uint64_t end) const
+{
+    // Samples are appended in time order; a racing overwrite only makes the
+    // answer approximate, and forEach filters by time anyway
+    Ring::Slot* slots = ring(axisNo)->slots();
+    while (begin < end) {
+        const std::uint64_t mid = begin + (end - begin) / 2;
+        if (slots[mid % std::uint64_t(capacity_)].timestampNs.load(std::memory_order_relaxed) < fromNs) {
+            begin = mid + 1;
+        } else {
+            end = mid;
+        }
+    }
+    return begin;
+}
+
+std::uint64_t TrajectoryRecorder::forEach(int axisNo, std::int64_t fromNs, std::int64_t toNs,
+                                          const std::function<void(const Sample&)> &visit) const
+{
+    if (axisNo < 1 || axisNo > kMaxAxes) return 0;
+
+    constexpr std::uint64_t kChunk = 4096;
+    std::vector<Sample> chunk(kChunk);
+    std::uint64_t visited = 0;
+
+    const std::uint64_t head = samplesWritten(axisNo);
+    const std::uint64_t oldest = head + 1 > std::uint64_t(capacity_) ? head + 1 - capacity_ : 0;
+    std::uint64_t index = firstAtOrAfter(axisNo, fromNs, oldest, head);
+    while (index < head) {
+        const std::uint64_t end = std::min(index + kChunk, head);
+        std::uint64_t validBegin = index;
+        if (!copyRange(axisNo, index, end, chunk.data(), validBegin)) {
+            // The writer lapped us; continue from the oldest sample still there
+            index = validBegin;
+            continue;
+        }
+        for (std::uint64_t i = 0; i < end - index; ++i) {
+            const Sample& sample = chunk[i];
+            if (sample.timestampNs > toNs) return visited;
+            if (sample.timestampNs < fromNs) continue;
+            visit(sample);
+            ++visited;
+        }
+        index = end;
+    }
+    return visited;
+}
+
+bool TrajectoryRecorder::exportWindow(const QString &filePath, TrajectoryFormat format, std::int64_t fromNs,
+                                      std::int64_t toNs, std::uint64_t axisMask, QString &error) const
+{
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+
+    // Buffered in blocks so a long window streams with bounded memory
+    QByteArray block;
+    block.reserve(1 << 20);
+    auto flushIfFull = [&file, &block]() {
+        if (block.size() >= (1 << 20) - 64) {
+            file.write(block);
+            block.clear();
+        }
+    };
+
+    if (format == TrajectoryFormat::Csv) {
+        block += "axis,unix_ns,pulse,status\n";
+    } else {
+        block.append(kExportMagic, sizeof(kExportMagic));
+    }
+
+    for (int axisNo = 1; axisNo <= kMaxAxes; ++axisNo) {
+        if (axisMask != 0 && !(axisMask & (std::uint64_t(1) << axisNo))) continue;
+
+        forEach(axisNo, fromNs, toNs, [&](const Sample& sample) {
+            if (format == TrajectoryFormat::Csv) {
+                block += QByteArray::number(axisNo);
+                block += ',';
+                block += QByteArray::number(static_cast<qlonglong>(sample.timestampNs));
+                block += ',';
+                block += QByteArray::number(sample.positionPulse);
+                block += ',';
+                block += statusName(sample.status);
+                block += '\n';
+            } else {
+                // u8 axis, u8 status, i64 unix ns, i32 pulse
+                char record[14];
+                record[0] = static_cast<char>(axisNo);
+                record[1] = static_cast<char>(sample.status);
+                putLe(record + 2, static_cast<std::uint64_t>(sample.timestampNs), 8);
+                putLe(record + 10, static_cast<std::uint32_t>(sample.positionPulse), 4);
+                block.append(record, sizeof(record));
+            }
+            flushIfFull();
+        });
+    }
+    file.write(block);
+
+    if (!file.commit()) {
+        error = QString("%1: %2").arg(filePath, file.errorString());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef TRAJECTORYRECORDER_H
+#define TRAJECTORYRECORDER_H
+
+#include "AxisSnapshot.h"
+#include <QFile>
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+// 내보내기 형식
+enum class TrajectoryFormat { Csv, Binary };
+
+// Per-axis position history in fixed-size rings inside one memory-mapped file.
+//
+// Every axis owns a ring of `capacity` samples (timestamp, pulse, motion
+// status). Timestamps are stored as Unix time so history from before a crash
+// or reboot stays meaningful. append() is two relaxed stores plus a release store of the ring
+// head into the mapping, so recording costs no system call per sample, and
+// because the mapping is shared with the page cache the history survives a
+// crash of the process. Reopening a file with the same geometry continues it.
+//
+// There is one writer (the io thread). Exports run on any thread while
+// recording goes on: a reader copies samples and then re-checks the head,
+// dropping whatever the writer overwrote in the meantime.
+//
+// File layout (native endianness, the file is not meant to travel; use the
+// export for that):
+//   header   64 bytes: "KZTRAJ01", version, axis count, capacity
+//   per axis 64-byte ring header (head = samples ever written) + capacity * 16-byte samples
+class TrajectoryRecorder
+{
+public:
+    static constexpr int kMaxAxes = AxisStateSnapshot::kMaxAxes;
+
+    struct Sample {
+        std::int64_t timestampNs = 0;   // ns since the Unix epoch
+        int positionPulse = 0;
+        AxisMotionStatus status = AxisMotionStatus::Unknown;
+    };
+
+    // Creates or reopens the ring file; null with a message on failure
+    static std::shared_ptr<TrajectoryRecorder> open(const QString& filePath, int samplesPerAxis, QString& error);
+    ~TrajectoryRecorder();
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    // Writer side, one thread only; timestampNs is steady_clock (monotonicNs())
+    void append(int axisNo, std::int64_t timestampNs, int positionPulse, AxisMotionStatus status);
+
+    QString filePath() const { return file_.fileName(); }
+    int capacity() const { return capacity_; }
+    std::uint64_t samplesWritten(int axisNo) const;
+    // steady_clock -> Unix epoch, fixed when the file was opened
+    std::int64_t toWallClockNs(std::int64_t steadyNs) const { return steadyNs + wallClockOffsetNs_; }
+
+    // Visits the retained samples of one axis with timestampNs in [fromNs, toNs]
+    // in time order, up to what was written when the call started; returns the
+    // number visited.
+    std::uint64_t forEach(int axisNo, std::int64_t fromNs, std::int64_t toNs,
+                          const std::function<void(const Sample&)>& visit) const;
+
+    // Streams the window of the axes in `axisMask` (bit n = axis n, 0 = all)
+    // to a file, axis by axis. Safe to call while recording.
+    bool exportWindow(const QString& filePath, TrajectoryFormat format, std::int64_t fromNs, std::int64_t toNs,
+                      std::uint64_t axisMask, QString& error) const;
+
+private:
+    struct Ring;
+
+    TrajectoryRecorder() = default;
+    Ring* ring(int axisNo) const;
+    bool copyRange(int axisNo, std::uint64_t begin, std::uint64_t end, Sample* out, std::uint64_t& validBegin) const;
+    std::uint64_t firstAtOrAfter(int axisNo, std::int64_t fromNs, std::uint64_t begin, std::uint64_t end) const;
+
+    QFile file_;
+    uchar* base_ = nullptr;
+    int capacity_ = 0;
+    std::int64_t wallClockOffsetNs_ = 0;
+};
+
+#endif // TRAJECTORYRECORDER_H
@@ -0,0 +1,148 @@
+#include "WireCapture.h"
+#include "LatencyHistogram.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[8] = {'K', 'Z', 'W', 'I', 'R', 'E', '0', '1'};
+constexpr std::size_t kHeaderSize = sizeof(kMagic) + 8;
+constexpr std::size_t kFrameHeaderSize = 8 + 1 + 4;
+
+void putLe(unsigned char* out, std::uint64_t value, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+std::uint64_t getLe(const unsigned char* in, int bytes)
+{
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= std::uint64_t(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+CaptureWriter::~CaptureWriter()
+{
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path, std::string& error)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) std::fclose(file_);
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    // Frames are small; a large stdio buffer keeps the proxy thread off the disk
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    unsigned char header[kHeaderSize];
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    const auto wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch()).count();
+    putLe(header + sizeof(kMagic), static_cast<std::uint64_t>(wallNs), 8);
+    std::fwrite(header, 1, sizeof(header), file_);
+
+    originNs_ = monotonicNs();
+    frames_ = 0;
+    return true;
+}
+
+void CaptureWriter::close()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool CaptureWriter::isOpen() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return file_ != nullptr;
+}
+
+void CaptureWriter::write(CaptureFrame::Direction direction, const char* data, std::size_t length)
+{
+    const std::int64_t now = monotonicNs();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+
+    unsigned char header[kFrameHeaderSize];
+    putLe(header, static_cast<std::uint64_t>(now - originNs_), 8);
+    header[8] = direction;
+    putLe(header + 9, static_cast<std::uint64_t>(length), 4);
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fwrite(data, 1, length, file_);
+    ++frames_;
+}
+
+std::uint64_t CaptureWriter::framesWritten() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return frames_;
+}
+
+bool loadCapture(const std::string& path, std::vector<CaptureFrame>& frames, std::string& error)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    unsigned char header[kHeaderSize];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header)
+        || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        std::fclose(file);
+        error = path + ": not a capture file";
+        return false;
+    }
+
+    // Lengths are checked before anything is allocated, so a corrupt header
+    // cannot ask for gigabytes
+    std::fseek(file, 0, SEEK_END);
+    const long fileSize = std::ftell(file);
+    std::fseek(file, static_cast<long>(kHeaderSize), SEEK_SET);
+    std::uint64_t remaining = fileSize > long(kHeaderSize) ? std::uint64_t(fileSize) - kHeaderSize : 0;
+
+    frames.clear();
+    unsigned char frameHeader[kFrameHeaderSize];
+    while (std::fread(frameHeader, 1, sizeof(frameHeader), file) == sizeof(frameHeader)) {
+        remaining = remaining > kFrameHeaderSize ? remaining - kFrameHeaderSize : 0;
+        const std::uint64_t length = getLe(frameHeader + 9, 4);
+        if (length > CaptureFrame::kMaxBytes) {
+            std::fclose(file);
+            error = path + ": frame " + std::to_string(frames.size()) + " claims " + std::to_string(length)
+                    + " bytes; the capture is corrupt";
+            return false;
+        }
+        if (length > remaining) {
+            break;
+        }
+
+        CaptureFrame frame;
+        frame.offsetNs = static_cast<std::int64_t>(getLe(frameHeader, 8));
+        frame.direction = frameHeader[8] == CaptureFrame::ControllerToHost ? CaptureFrame::ControllerToHost
+                                                                            : CaptureFrame::HostToController;
+        frame.bytes.resize(static_cast<std::size_t>(length));
+        if (std::fread(&frame.bytes[0], 1, frame.bytes.size(), file) != frame.bytes.size()) {
+            break;
+        }
+        remaining -= length;
+        frames.push_back(std::move(frame));
+    }
+    std::fclose(file);
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef WIRECAPTURE_H
+#define WIRECAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 캡처 파일의 한 프레임 (소켓에서 한 번 읽은 바이트)
+struct CaptureFrame {
+    enum Direction : std::uint8_t { HostToController = 0, ControllerToHost = 1 };
+    // 한 번의 소켓 읽기보다 넉넉히 큼; 이보다 긴 프레임은 손상된 파일로 본다
+    static constexpr std::size_t kMaxBytes = 64 * 1024;
+
+    std::int64_t offsetNs = 0;      // 캡처 시작 이후 steady_clock 경과 시간
+    Direction direction = HostToController;
+    std::string bytes;
+};
+
+// Compact binary capture of controller traffic.
+//
+// File layout, all integers little-endian:
+//   header  "KZWIRE01" (8 bytes), u64 wall-clock start (ns since the Unix epoch)
+//   frame   u64 offsetNs, u8 direction, u32 length, `length` bytes
+// One frame is one socket read, so the original TCP segmentation and timing
+// are kept. Frames are appended in arrival order.
+class CaptureWriter
+{
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    void close();
+    bool isOpen() const;
+
+    // Thread-safe; offsets are taken from one steady_clock origin across all connections
+    void write(CaptureFrame::Direction direction, const char* data, std::size_t length);
+
+    std::uint64_t framesWritten() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::FILE* file_ = nullptr;
+    std::int64_t originNs_ = 0;
+    std::uint64_t frames_ = 0;
+};
+
+// Reads a whole capture file; returns false with a message on a bad header or
+// a frame longer than CaptureFrame::kMaxBytes. A truncated last frame (capture
+// cut off by a crash) is dropped silently.
+bool loadCapture(const std::string& path, std::vector<CaptureFrame>& frames, std::string& error);
+
+#endif // WIRECAPTURE_H
@@ -0,0 +1,179 @@
+// CommandPipeline against the local simulator: how queued Coalesce moves are
+// merged or superseded, which queued commands an owner's cancel drops, and a
+// full in-flight window sharing the link with monitoring reads. Every
+// coalescing case first sends a slow Keep move so the commands after it stay
+// queued behind the axis until it completes.
+
+#include "MonitoringScheduler.h"
+#include "TestUtil.h"
+
+#include <QtTest>
+#include <algorithm>
+#include <set>
+
+namespace {
+
+constexpr int kSlowTable = 0;    // 100 pps: the 30 pulse hold move takes ~300 ms
+constexpr int kFastTable = 9;
+constexpr int kHoldPulses = 30;
+
+} // namespace
+
+class CommandPipelineTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void mergesQueuedRelativeMoves();
+    void absoluteMoveSupersedesQueuedMove();
+    void keepMovesAreNotCoalesced();
+    void cancelsOnlyTheOwnersQueuedCommands();
+    void monitoringReadsShareTheLink();
+};
+
+void CommandPipelineTest::mergesQueuedRelativeMoves()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    ResultLog log;
+
+    QVERIFY(pipeline->submit(1, CommandKind::MoveRelative, kHoldPulses, kSlowTable, 0, 0, log.recorder("hold")));
+    QVERIFY(pipeline->submit(1, CommandKind::MoveRelative, 100, kFastTable, 0, 0, log.recorder("first"),
+                             QueuePolicy::Coalesce));
+    QVERIFY(pipeline->submit(1, CommandKind::MoveRelative, 50, kFastTable, 0, 0, log.recorder("second"),
+                             QueuePolicy::Coalesce));
+    QVERIFY(log.waitFor(3));
+
+    QCOMPARE(log["hold"].status, 'C');
+    // One command ran; both callers hear about it, only the newest unflagged
+    QCOMPARE(log["first"].status, 'C');
+    QVERIFY(log["first"].merged);
+    QCOMPARE(log["second"].status, 'C');
+    QVERIFY(!log["second"].merged);
+    QCOMPARE(log["first"].sentNs, log["second"].sentNs);
+    QCOMPARE(link.simulator.position(1), kHoldPulses + 150);
+    QCOMPARE(pipeline->pendingCount(), 0);
+}
+
+void CommandPipelineTest::absoluteMoveSupersedesQueuedMove()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    ResultLog log;
+
+    QVERIFY(pipeline->submit(2, CommandKind::MoveRelative, kHoldPulses, kSlowTable, 0, 0, log.recorder("hold")));
+    QVERIFY(pipeline->submit(2, CommandKind::MoveRelative, 100, kFastTable, 0, 0, log.recorder("relative"),
+                             QueuePolicy::Coalesce));
+    QVERIFY(pipeline->submit(2, CommandKind::MoveAbsolute, 500, kFastTable, 0, 0, log.recorder("absolute"),
+                             QueuePolicy::Coalesce));
+    QVERIFY(log.waitFor(3));
+
+    QVERIFY(log["relative"].superseded);
+    QCOMPARE(log["relative"].sentNs, std::int64_t(0));
+    QCOMPARE(log["absolute"].status, 'C');
+    QVERIFY(!log["absolute"].superseded);
+    QCOMPARE(link.simulator.position(2), 500);
+    QCOMPARE(pipeline->pendingCountForAxis(2), 0);
+}
+
+void CommandPipelineTest::keepMovesAreNotCoalesced()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    ResultLog log;
+
+    QVERIFY(pipeline->submit(3, CommandKind::MoveRelative, kHoldPulses, kSlowTable, 0, 0, log.recorder("hold")));
+    QVERIFY(pipeline->submit(3, CommandKind::MoveRelative, 100, kFastTable, 0, 0, log.recorder("kept")));
+    // A Coalesce move may only absorb a queued Coalesce move
+    QVERIFY(pipeline->submit(3, CommandKind::MoveAbsolute, 40, kFastTable, 0, 0, log.recorder("absolute"),
+                             QueuePolicy::Coalesce));
+    QVERIFY(log.waitFor(3));
+
+    QCOMPARE(log["kept"].status, 'C');
+    QVERIFY(!log["kept"].superseded);
+    QVERIFY(!log["kept"].merged);
+    QVERIFY(log["kept"].sentNs < log["absolute"].sentNs);
+    QCOMPARE(link.simulator.position(3), 40);
+}
+
+void CommandPipelineTest::cancelsOnlyTheOwnersQueuedCommands()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    ResultLog log;
+    const int ownerA = 0;
+    const int ownerB = 0;
+
+    QVERIFY(pipeline->submit(4, CommandKind::MoveRelative, kHoldPulses, kSlowTable, 0, 0, log.recorder("hold"),
+                             QueuePolicy::Keep, &ownerA));
+    QVERIFY(pipeline->submit(4, CommandKind::MoveRelative, 10, kFastTable, 0, 0, log.recorder("a1"),
+                             QueuePolicy::Keep, &ownerA));
+    QVERIFY(pipeline->submit(4, CommandKind::MoveRelative, 20, kFastTable, 0, 0, log.recorder("b"),
+                             QueuePolicy::Keep, &ownerB));
+    QVERIFY(pipeline->submit(4, CommandKind::MoveRelative, 40, kFastTable, 0, 0, log.recorder("a2"),
+                             QueuePolicy::Keep, &ownerA));
+    QVERIFY(pipeline->submit(5, CommandKind::MoveRelative, 10, kFastTable, 0, 0, log.recorder("otherAxis"),
+                             QueuePolicy::Keep, &ownerA));
+    pipeline->cancelQueuedForAxis(4, &ownerA);
+    QVERIFY(log.waitFor(5));
+
+    // The in-flight move is not touched, nor are other owners or other axes
+    QCOMPARE(log["hold"].status, 'C');
+    QCOMPARE(QString::fromStdString(log["a1"].fullResponse), QString("cancelled"));
+    QCOMPARE(log["a1"].sentNs, std::int64_t(0));
+    QCOMPARE(QString::fromStdString(log["a2"].fullResponse), QString("cancelled"));
+    QCOMPARE(log["b"].status, 'C');
+    QCOMPARE(log["otherAxis"].status, 'C');
+    QCOMPARE(link.simulator.position(4), kHoldPulses + 20);
+    QCOMPARE(pipeline->pendingCount(), 0);
+}
+
+void CommandPipelineTest::monitoringReadsShareTheLink()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    MonitoringConfig config;
+    config.maxQueriesPerTick = 8;
+    auto scheduler = std::make_shared<MonitoringScheduler>(link.ioContext, link.controller,
+                                                           std::make_shared<AxisSnapshotBuffer>(), config);
+
+    // RDP/STR polls go out from the controller's own monitor loop, next to
+    // whatever the pipeline has in flight
+    std::promise<void> monitoring;
+    boost::asio::post(link.ioContext, [&link, &config, &monitoring]() {
+        link.controller->startMonitoring({}, static_cast<int>(config.tick.count()));
+        monitoring.set_value();
+    });
+    monitoring.get_future().wait();
+    std::set<int> axes;
+    for (int axisNo = 1; axisNo <= 8; ++axisNo) axes.insert(axisNo);
+    scheduler->setAxes(axes);
+    scheduler->start();
+
+    // 2000 pulses at 10000 pps: every axis is moving for ~200 ms with the window full
+    ResultLog log;
+    for (int axisNo : axes) {
+        scheduler->notifyCommandIssued(axisNo);
+        QVERIFY(pipeline->submit(axisNo, CommandKind::MoveAbsolute, 2000 + axisNo, 5, 0, 0,
+                                 log.recorder(std::to_string(axisNo))));
+    }
+    QVERIFY(log.waitFor(axes.size()));
+
+    // Each move reply reached its own callback, and each poll reply its own axis
+    for (int axisNo : axes) {
+        const CommandResult result = log[std::to_string(axisNo)];
+        QCOMPARE(result.status, 'C');
+        QVERIFY(!result.timedOut);
+        QCOMPARE(link.simulator.position(axisNo), 2000 + axisNo);
+    }
+    QVERIFY(link.simulator.stats().commandsReceived > 2 * axes.size());
+    QTRY_VERIFY_WITH_TIMEOUT(std::all_of(axes.begin(), axes.end(), [&link](int axisNo) {
+        return link.axisState->getPosition(axisNo) == 2000 + axisNo;
+    }), 2000);
+    QCOMPARE(link.simulator.stats().errorsSent, std::uint64_t(0));
+
+    scheduler->stop();
+}
+
+QTEST_GUILESS_MAIN(CommandPipelineTest)
+#include "CommandPipelineTest.moc"
@@ -0,0 +1,185 @@
+// HomingPlanner: plan validation (limits, missing prerequisites, cycles),
+// the dependency file format, and dependency ordering of a run against the
+// local simulator.
+
+#include "HomingPlanner.h"
+#include "MonitoringScheduler.h"
+#include "TestUtil.h"
+
+#include <QtTest>
+
+namespace {
+
+HomingAxis axis(int axisNo, std::vector<int> after = {})
+{
+    HomingAxis homing;
+    homing.axisNo = axisNo;
+    homing.after = std::move(after);
+    return homing;
+}
+
+} // namespace
+
+class HomingPlannerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void acceptsDependencyGraphs();
+    void rejectsInvalidPlans_data();
+    void rejectsInvalidPlans();
+    void namesTheAxesOnACycle();
+    void parsesDependencies();
+    void rejectsInvalidDependencies_data();
+    void rejectsInvalidDependencies();
+    void homesInDependencyOrder();
+};
+
+void HomingPlannerTest::acceptsDependencyGraphs()
+{
+    std::string error;
+    // Z (3) first, then X/Y; a repeated prerequisite counts once
+    HomingPlan stack{{axis(1, {3}), axis(2, {3, 3}), axis(3)}};
+    QVERIFY2(HomingPlanner::validate(stack, error), error.c_str());
+
+    // Diamond: 4 waits for 2 and 3, which both wait for 1
+    HomingPlan diamond{{axis(4, {2, 3}), axis(2, {1}), axis(3, {1}), axis(1)}};
+    QVERIFY2(HomingPlanner::validate(diamond, error), error.c_str());
+}
+
+void HomingPlannerTest::rejectsInvalidPlans_data()
+{
+    QTest::addColumn<int>("axisNo");
+    QTest::addColumn<int>("speed");
+    QTest::addColumn<int>("secondAxis");
+    QTest::addColumn<int>("prerequisite");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("axis 0") << 0 << 9 << 2 << 0 << "invalid axis number";
+    QTest::newRow("axis past last") << AxisStateSnapshot::kMaxAxes + 1 << 9 << 2 << 0 << "invalid axis number";
+    QTest::newRow("speed") << 1 << CommandPipeline::kSpeedTables << 2 << 0 << "speed must be";
+    QTest::newRow("listed twice") << 1 << 9 << 1 << 0 << "listed twice";
+    QTest::newRow("missing prerequisite") << 1 << 9 << 2 << 5 << "not being homed";
+    QTest::newRow("waits for itself") << 1 << 9 << 2 << 1 << "dependency cycle";
+}
+
+void HomingPlannerTest::rejectsInvalidPlans()
+{
+    QFETCH(int, axisNo);
+    QFETCH(int, speed);
+    QFETCH(int, secondAxis);
+    QFETCH(int, prerequisite);
+    QFETCH(QString, expected);
+
+    HomingPlan plan{{axis(axisNo), axis(secondAxis)}};
+    plan.axes[0].speed = speed;
+    if (prerequisite != 0) plan.axes[0].after.push_back(prerequisite);
+
+    std::string error;
+    QVERIFY(!HomingPlanner::validate(plan, error));
+    QVERIFY2(QString::fromStdString(error).contains(expected), error.c_str());
+
+    QVERIFY(!HomingPlanner::validate(HomingPlan{}, error));
+}
+
+void HomingPlannerTest::namesTheAxesOnACycle()
+{
+    // 1 -> 2 -> 3 -> 1, with 4 free and 5 stuck behind the cycle
+    HomingPlan plan{{axis(1, {3}), axis(2, {1}), axis(3, {2}), axis(4), axis(5, {2})}};
+    std::string error;
+    QVERIFY(!HomingPlanner::validate(plan, error));
+    QCOMPARE(QString::fromStdString(error), QString("dependency cycle among axes 1, 2, 3, 5"));
+}
+
+void HomingPlannerTest::parsesDependencies()
+{
+    std::map<int, std::vector<int>> after;
+    QString error;
+    QVERIFY2(HomingPlanner::parseDependencies(R"({ "after": { "1": [3], "2": [3, 4], "4": [] } })", after, error),
+             qPrintable(error));
+    QCOMPARE(int(after.size()), 3);
+    QVERIFY(after[1] == std::vector<int>{3});
+    QVERIFY(after[2] == (std::vector<int>{3, 4}));
+    QVERIFY(after[4].empty());
+
+    // No "after" at all: every axis is independent
+    QVERIFY(HomingPlanner::parseDependencies("{}", after, error));
+    QVERIFY(after.empty());
+}
+
+void HomingPlannerTest::rejectsInvalidDependencies_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("syntax") << QByteArray(R"({ "after": )") << "offset";
+    QTest::newRow("key") << QByteArray(R"({ "after": { "x": [1] } })") << "invalid axis number \"x\"";
+    QTest::newRow("key range") << QByteArray(R"({ "after": { "33": [1] } })") << "invalid axis number";
+    QTest::newRow("not a list") << QByteArray(R"({ "after": { "1": 3 } })") << "expected a list";
+    QTest::newRow("entry") << QByteArray(R"({ "after": { "1": [0] } })") << "after.1: invalid axis number";
+}
+
+void HomingPlannerTest::rejectsInvalidDependencies()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QString, expected);
+
+    std::map<int, std::vector<int>> after;
+    QString error;
+    QVERIFY(!HomingPlanner::parseDependencies(json, after, error));
+    QVERIFY2(error.contains(expected), qPrintable(error));
+}
+
+void HomingPlannerTest::homesInDependencyOrder()
+{
+    SimulatedLink link;
+    auto pipeline = std::make_shared<CommandPipeline>(link.ioContext, link.controller);
+    auto scheduler = std::make_shared<MonitoringScheduler>(link.ioContext, link.controller,
+                                                           std::make_shared<AxisSnapshotBuffer>());
+    auto planner = std::make_shared<HomingPlanner>(link.ioContext, pipeline, scheduler);
+
+    // Start away from home so every origin return takes a while
+    ResultLog moves;
+    for (int axisNo = 1; axisNo <= 4; ++axisNo) {
+        QVERIFY(pipeline->submit(axisNo, CommandKind::MoveAbsolute, 2000, 8, 0, 0,
+                                 moves.recorder(std::to_string(axisNo))));
+    }
+    QVERIFY(moves.waitFor(4));
+
+    std::mutex mutex;
+    std::map<int, HomingAxisResult> results;
+    std::vector<int> finishOrder;
+    std::promise<bool> finished;
+    HomingPlan plan{{axis(1, {3}), axis(2, {3}), axis(3), axis(4, {1, 2})}};
+    for (HomingAxis& homing : plan.axes) homing.speed = 8;
+    planner->start(plan,
+        [&](const HomingAxisResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            results[result.axisNo] = result;
+            finishOrder.push_back(result.axisNo);
+        },
+        [&](bool completed, const std::string&, std::int64_t) { finished.set_value(completed); });
+
+    auto done = finished.get_future();
+    QVERIFY(done.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+    QVERIFY(done.get());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    QCOMPARE(int(results.size()), 4);
+    for (const auto& [axisNo, result] : results) {
+        QVERIFY(result.success);
+        QCOMPARE(link.simulator.position(axisNo), 0);
+    }
+    // An axis is sent its origin command only after its prerequisites are home
+    QVERIFY(results[1].startedNs >= results[3].finishedNs);
+    QVERIFY(results[2].startedNs >= results[3].finishedNs);
+    QVERIFY(results[4].startedNs >= results[1].finishedNs);
+    QVERIFY(results[4].startedNs >= results[2].finishedNs);
+    // 1 and 2 share a prerequisite and run side by side
+    QVERIFY(results[2].startedNs < results[1].finishedNs);
+    QCOMPARE(finishOrder.front(), 3);
+    QCOMPARE(finishOrder.back(), 4);
+}
+
+QTEST_GUILESS_MAIN(HomingPlannerTest)
+#include "HomingPlannerTest.moc"
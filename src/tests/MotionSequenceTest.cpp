@@ -0,0 +1,151 @@
+// MotionSequence: JSON parsing into pulse steps, and the dry-run range check
+// that walks loops from the start positions.
+
+#include "MotionSequence.h"
+
+#include <QtTest>
+
+namespace {
+
+// XA05A-R201: 0.0005 mm/pulse, 0 ~ 15 mm
+const QByteArray kCatalog = R"({ "motors": [
+    { "name": "XA05A-R201", "unit": "linear",  "symbol": "mm", "value_per_pulse": 0.0005, "travel_range": 7.5,   "precision": 4 },
+    { "name": "RA04A-W",    "unit": "angular", "symbol": "°",  "value_per_pulse": 0.002,  "travel_range": 177.0, "precision": 3 }
+] })";
+
+std::shared_ptr<const MotorCatalog> testCatalog()
+{
+    QString error;
+    auto catalog = MotorCatalog::fromJson(kCatalog, error);
+    if (!catalog) qFatal("test catalog: %s", qPrintable(error));
+    return catalog;
+}
+
+QByteArray withSteps(const QByteArray& steps)
+{
+    return R"({ "axes": { "1": "XA05A-R201", "2": "RA04A-W" }, "steps": )" + steps + "}";
+}
+
+} // namespace
+
+class MotionSequenceTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parsesMovesIntoPulses();
+    void pairsLoopMarkers();
+    void rejectsInvalidSteps_data();
+    void rejectsInvalidSteps();
+    void validateWalksLoopsFromStart();
+    void startDependentAxes();
+};
+
+void MotionSequenceTest::parsesMovesIntoPulses()
+{
+    MotionSequence sequence;
+    QString error;
+    QVERIFY2(MotionSequence::parse(withSteps(R"([
+        { "move": 1, "to": 2.5 },
+        { "move": 1, "by": -0.1, "speed": 4 },
+        { "origin": 2, "speed": 5 },
+        { "system": 2, "no": 2, "value": 8 },
+        { "wait": [1, 2] },
+        { "delay": 250 }
+    ])"), testCatalog(), sequence, error), qPrintable(error));
+
+    QCOMPARE(int(sequence.steps.size()), 6);
+    const SequenceStep& absolute = sequence.steps[0];
+    QVERIFY(absolute.type == SequenceStep::Type::Move);
+    QVERIFY(absolute.isAbsolute);
+    QCOMPARE(absolute.pulse, 5000);
+    QCOMPARE(absolute.speed, 9);
+    const SequenceStep& relative = sequence.steps[1];
+    QVERIFY(!relative.isAbsolute);
+    QCOMPARE(relative.pulse, -200);
+    QCOMPARE(relative.speed, 4);
+    QVERIFY(sequence.steps[2].type == SequenceStep::Type::Origin);
+    QCOMPARE(sequence.steps[3].systemNo, 2);
+    QCOMPARE(sequence.steps[3].value, 8);
+    QVERIFY(sequence.steps[4].axes == (std::vector<int>{1, 2}));
+    QCOMPARE(int(sequence.steps[5].delay.count()), 250);
+    QVERIFY(sequence.axisNumbers() == (std::vector<int>{1, 2}));
+}
+
+void MotionSequenceTest::pairsLoopMarkers()
+{
+    MotionSequence sequence;
+    QString error;
+    QVERIFY2(MotionSequence::parse(withSteps(R"([
+        { "loop": 3, "steps": [ { "move": 1, "by": 0.5 }, { "loop": 2, "steps": [ { "delay": 1 } ] } ] }
+    ])"), testCatalog(), sequence, error), qPrintable(error));
+
+    // LoopBegin(0) move(1) LoopBegin(2) delay(3) LoopEnd(4) LoopEnd(5)
+    QCOMPARE(int(sequence.steps.size()), 6);
+    QVERIFY(sequence.steps[0].type == SequenceStep::Type::LoopBegin);
+    QCOMPARE(sequence.steps[0].count, 3);
+    QCOMPARE(sequence.steps[0].match, 5);
+    QCOMPARE(sequence.steps[5].match, 0);
+    QCOMPARE(sequence.steps[2].match, 4);
+    QVERIFY(sequence.steps[4].type == SequenceStep::Type::LoopEnd);
+}
+
+void MotionSequenceTest::rejectsInvalidSteps_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("undeclared axis") << withSteps(R"([ { "move": 3, "to": 1.0 } ])") << "not declared";
+    QTest::newRow("to and by") << withSteps(R"([ { "move": 1, "to": 1.0, "by": 1.0 } ])") << "exactly one";
+    QTest::newRow("absolute out of range") << withSteps(R"([ { "move": 1, "to": 15.5 } ])") << "out of range";
+    QTest::newRow("negative target") << withSteps(R"([ { "move": 1, "to": -0.5 } ])") << "out of range";
+    QTest::newRow("speed") << withSteps(R"([ { "move": 1, "to": 1.0, "speed": 10 } ])") << "speed must be";
+    QTest::newRow("loop count") << withSteps(R"([ { "loop": 0, "steps": [] } ])") << "loop count";
+    QTest::newRow("unknown step") << withSteps(R"([ { "jump": 1 } ])") << "unknown step";
+    QTest::newRow("unknown motor") << QByteArray(R"({ "axes": { "1": "NOPE" }, "steps": [] })") << "unknown motor";
+    QTest::newRow("axis number") << QByteArray(R"({ "axes": { "33": "RA04A-W" }, "steps": [] })") << "invalid axis number";
+}
+
+void MotionSequenceTest::rejectsInvalidSteps()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QString, expected);
+
+    MotionSequence sequence;
+    QString error;
+    QVERIFY(!MotionSequence::parse(json, testCatalog(), sequence, error));
+    QVERIFY2(error.contains(expected), qPrintable(error));
+}
+
+void MotionSequenceTest::validateWalksLoopsFromStart()
+{
+    MotionSequence sequence;
+    QString parseError;
+    // Ten steps of +1 mm
+    QVERIFY(MotionSequence::parse(withSteps(R"([ { "loop": 10, "steps": [ { "move": 1, "by": 1.0 } ] } ])"),
+                                  testCatalog(), sequence, parseError));
+
+    std::string error;
+    QVERIFY2(sequence.validate({{1, 0}}, error), error.c_str());
+    QVERIFY2(sequence.validate({{1, 10000}}, error), error.c_str());    // 5 mm -> 15 mm, the upper end
+    QVERIFY(!sequence.validate({{1, 12000}}, error));                   // 6 mm -> 16 mm
+    QVERIFY(error.find("steps[0].steps[0]") != std::string::npos);
+}
+
+void MotionSequenceTest::startDependentAxes()
+{
+    MotionSequence sequence;
+    QString error;
+    QVERIFY(MotionSequence::parse(withSteps(R"([
+        { "move": 1, "to": 1.0 },
+        { "move": 1, "by": 0.5 },
+        { "move": 2, "by": 1.0 },
+        { "origin": 2 }
+    ])"), testCatalog(), sequence, error));
+
+    // Axis 1 starts absolute, so only axis 2 needs a known start position
+    QVERIFY(sequence.startDependentAxes() == std::vector<int>{2});
+}
+
+QTEST_GUILESS_MAIN(MotionSequenceTest)
+#include "MotionSequenceTest.moc"
@@ -0,0 +1,152 @@
+// MotorCatalog: loading, and the fixed-point nano-unit conversions that
+// MainWindow, MotionSequence and ScanEngine rely on to be exact.
+
+#include "MotorCatalog.h"
+
+#include <QtTest>
+#include <climits>
+
+namespace {
+
+const QByteArray kCatalog = R"({ "motors": [
+    { "name": "ZA05A-W1",  "unit": "linear",  "symbol": "mm", "value_per_pulse": 0.00025,  "travel_range": 3.3, "precision": 5 },
+    { "name": "SA05A-R2B", "unit": "angular", "symbol": "°",  "value_per_pulse": 0.000637, "travel_range": 3.5, "precision": 6 }
+] })";
+
+} // namespace
+
+class MotorCatalogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void loadsWithDefaultFirst();
+    void rejectsInvalidCatalogs_data();
+    void rejectsInvalidCatalogs();
+    void convertsExactly();
+    void roundsHalfAwayFromZero();
+    void saturatesAtIntRange();
+    void checksTravelWindow();
+    void formatsNano();
+    void batchedKernelsMatchScalar();
+
+private:
+    std::shared_ptr<const MotorCatalog> catalog_;
+    int za_ = -1;
+    int sa_ = -1;
+};
+
+void MotorCatalogTest::initTestCase()
+{
+    QString error;
+    catalog_ = MotorCatalog::fromJson(kCatalog, error);
+    QVERIFY2(catalog_, qPrintable(error));
+    za_ = catalog_->indexOf("ZA05A-W1");
+    sa_ = catalog_->indexOf("SA05A-R2B");
+}
+
+void MotorCatalogTest::loadsWithDefaultFirst()
+{
+    QCOMPARE(catalog_->size(), 3);
+    QCOMPARE(catalog_->at(MotorCatalog::kDefaultIndex).name, QString("Default"));
+    QCOMPARE(za_, 1);
+    QCOMPARE(sa_, 2);
+    QCOMPARE(catalog_->indexOf("missing"), -1);
+    QCOMPARE(catalog_->nanoPerPulse(MotorCatalog::kDefaultIndex), MotorCatalog::kNanoPerUnit);
+}
+
+void MotorCatalogTest::rejectsInvalidCatalogs_data()
+{
+    QTest::addColumn<QByteArray>("json");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("no motors") << QByteArray(R"({ })") << "missing \"motors\"";
+    QTest::newRow("ten decimals") << QByteArray(R"({ "motors": [ { "name": "A", "unit": "linear",
+        "value_per_pulse": 0.0000000001, "travel_range": 1.0 } ] })") << "at most 9 decimals";
+    QTest::newRow("unit") << QByteArray(R"({ "motors": [ { "name": "A", "unit": "metric",
+        "value_per_pulse": 0.001, "travel_range": 1.0 } ] })") << "unit must be";
+    QTest::newRow("duplicate") << QByteArray(R"({ "motors": [
+        { "name": "A", "unit": "linear", "value_per_pulse": 0.001, "travel_range": 1.0 },
+        { "name": "A", "unit": "linear", "value_per_pulse": 0.001, "travel_range": 1.0 } ] })") << "duplicate";
+}
+
+void MotorCatalogTest::rejectsInvalidCatalogs()
+{
+    QFETCH(QByteArray, json);
+    QFETCH(QString, expected);
+
+    QString error;
+    QVERIFY(!MotorCatalog::fromJson(json, error));
+    QVERIFY2(error.contains(expected), qPrintable(error));
+}
+
+void MotorCatalogTest::convertsExactly()
+{
+    QCOMPARE(catalog_->nanoPerPulse(za_), qint64(250000));
+    QCOMPARE(catalog_->nanoPerPulse(sa_), qint64(637000));
+    QCOMPARE(MotorCatalog::toNano(2.5), qint64(2500000000));
+    QCOMPARE(MotorCatalog::toNano(-0.1), qint64(-100000000));
+
+    // 0.000637 does not divide evenly in binary; in nano-units every pulse count is exact
+    for (int pulse : {1, 3, 7, 1000, 10989, -42}) {
+        const qint64 nano = catalog_->pulseToNano(sa_, pulse);
+        QCOMPARE(nano, qint64(pulse) * 637000);
+        QCOMPARE(catalog_->nanoToPulse(sa_, nano), pulse);
+    }
+    QCOMPARE(catalog_->nanoToPulse(za_, MotorCatalog::toNano(1.2345)), 4938);   // 4938.0
+}
+
+void MotorCatalogTest::roundsHalfAwayFromZero()
+{
+    QCOMPARE(catalog_->nanoToPulse(za_, 124999), 0);
+    QCOMPARE(catalog_->nanoToPulse(za_, 125000), 1);
+    QCOMPARE(catalog_->nanoToPulse(za_, -124999), 0);
+    QCOMPARE(catalog_->nanoToPulse(za_, -125000), -1);
+    QCOMPARE(catalog_->nanoToPulse(za_, 375000), 2);
+}
+
+void MotorCatalogTest::saturatesAtIntRange()
+{
+    const qint64 huge = qint64(INT_MAX) * 2 * MotorCatalog::kNanoPerUnit;
+    QCOMPARE(catalog_->nanoToPulse(MotorCatalog::kDefaultIndex, huge), INT_MAX);
+    QCOMPARE(catalog_->nanoToPulse(MotorCatalog::kDefaultIndex, -huge), INT_MIN);
+}
+
+void MotorCatalogTest::checksTravelWindow()
+{
+    // 0 ~ 2 * travel_range
+    QCOMPARE(catalog_->rangeNano(za_), qint64(6600000000));
+    QVERIFY(catalog_->inRange(za_, 0));
+    QVERIFY(catalog_->inRange(za_, 6600000000));
+    QVERIFY(!catalog_->inRange(za_, 6600000001));
+    QVERIFY(!catalog_->inRange(za_, -1));
+    QVERIFY(catalog_->inRange(za_, catalog_->pulseToNano(za_, 26400)));
+    QVERIFY(!catalog_->inRange(za_, catalog_->pulseToNano(za_, 26401)));
+}
+
+void MotorCatalogTest::formatsNano()
+{
+    QCOMPARE(MotorCatalog::formatNano(1234567890, 3), QString("1.235"));
+    QCOMPARE(MotorCatalog::formatNano(-1234567890, 3), QString("-1.235"));
+    QCOMPARE(MotorCatalog::formatNano(500000000, 0), QString("1"));
+    QCOMPARE(MotorCatalog::formatNano(637000, 6), QString("0.000637"));
+    QCOMPARE(MotorCatalog::formatNano(42, 9), QString("0.000000042"));
+}
+
+void MotorCatalogTest::batchedKernelsMatchScalar()
+{
+    const int motors[] = {za_, sa_, MotorCatalog::kDefaultIndex, sa_};
+    const int pulses[] = {26400, -3, 17, 10989};
+    qint64 nano[4];
+    int back[4];
+    catalog_->toPhysicalNano(motors, pulses, nano, 4);
+    catalog_->toPulses(motors, nano, back, 4);
+    for (int i = 0; i < 4; ++i) {
+        QCOMPARE(nano[i], catalog_->pulseToNano(motors[i], pulses[i]));
+        QCOMPARE(back[i], pulses[i]);
+    }
+}
+
+QTEST_GUILESS_MAIN(MotorCatalogTest)
+#include "MotorCatalogTest.moc"
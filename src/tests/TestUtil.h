@@ -0,0 +1,116 @@
+#ifndef TESTUTIL_H
+#define TESTUTIL_H
+
+#include "CommandPipeline.h"
+#include "KohzuSimulator.h"
+#include "controller/AxisState.h"
+#include "controller/KohzuController.h"
+#include "core/TcpClient.h"
+#include "protocol/ProtocolHandler.h"
+
+#include <boost/asio.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Small helpers shared by the test executables.
+
+// A KohzuController wired to a local simulator the way QtKohzuManager wires
+// it to a real one: TcpClient -> ProtocolHandler -> KohzuController, all on
+// one io thread owned by the link.
+class SimulatedLink
+{
+public:
+    explicit SimulatedLink(SimulatorConfig config = {})
+        : simulator(config), work_(ioContext.get_executor())
+    {
+        simulator.start();
+        ioThread_ = std::thread([this]() { ioContext.run(); });
+
+        const std::string host = "127.0.0.1";
+        const std::string port = std::to_string(simulator.port());
+        client = std::make_shared<TcpClient>(ioContext, host, port);
+        client->connect(host, port);
+
+        std::promise<void> started;
+        boost::asio::post(ioContext, [this, &started]() {
+            protocolHandler = std::make_shared<ProtocolHandler>(client);
+            axisState = std::make_shared<AxisState>();
+            controller = std::make_shared<KohzuController>(protocolHandler, axisState);
+            controller->start();
+            started.set_value();
+        });
+        started.get_future().wait();
+    }
+
+    ~SimulatedLink()
+    {
+        work_.reset();
+        ioContext.stop();
+        ioThread_.join();
+        controller.reset();
+        protocolHandler.reset();
+        client.reset();
+        simulator.stop();
+    }
+
+    SimulatedLink(const SimulatedLink&) = delete;
+    SimulatedLink& operator=(const SimulatedLink&) = delete;
+
+    KohzuSimulator simulator;
+    boost::asio::io_context ioContext;
+    std::shared_ptr<TcpClient> client;
+    std::shared_ptr<ProtocolHandler> protocolHandler;
+    std::shared_ptr<AxisState> axisState;
+    std::shared_ptr<KohzuController> controller;
+
+private:
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_;
+    std::thread ioThread_;
+};
+
+// Collects pipeline results by name from the io thread.
+class ResultLog
+{
+public:
+    CommandPipeline::Callback recorder(const std::string& name)
+    {
+        return [this, name](const CommandResult& result) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_[name] = result;
+            changed_.notify_all();
+        };
+    }
+
+    // Blocks until `count` results have arrived; false on timeout
+    bool waitFor(std::size_t count, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return changed_.wait_for(lock, timeout, [this, count]() { return results_.size() >= count; });
+    }
+
+    CommandResult operator[](const std::string& name) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = results_.find(name);
+        return it != results_.end() ? it->second : CommandResult{};
+    }
+
+    bool has(const std::string& name) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_.count(name) != 0;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<std::string, CommandResult> results_;
+};
+
+#endif // TESTUTIL_H